@@ -1,11 +1,204 @@
 
 #include "bind_mapping.h"
 
+#ifdef ENHANCED_PARAMETER_MAPPING
+#include <cctype>
+#endif
+
 namespace rj
 {
     namespace db
     {
 #ifdef ENHANCED_PARAMETER_MAPPING
+        namespace helper
+        {
+            bool is_identifier(char c)
+            {
+                return isalnum(static_cast<unsigned char>(c)) || c == '_';
+            }
+
+            size_t skip_quoted(const std::string &sql, size_t pos, bool backslashEscapes)
+            {
+                char quote = sql[pos];
+
+                for (size_t i = pos + 1; i < sql.length(); i++) {
+                    if (backslashEscapes && sql[i] == '\\') {
+                        i++;
+                        continue;
+                    }
+
+                    if (sql[i] != quote) {
+                        continue;
+                    }
+
+                    // a doubled quote is an escaped quote
+                    if (i + 1 < sql.length() && sql[i + 1] == quote) {
+                        i++;
+                        continue;
+                    }
+
+                    return i;
+                }
+
+                return sql.length();
+            }
+
+            std::vector<sql_parameter> find_parameters(const std::string &sql, bool backslashEscapes)
+            {
+                std::vector<sql_parameter> params;
+
+                size_t len = sql.length();
+
+                // the first ? or $n parameter found, as the two can not be numbered together
+                char indexed = 0;
+
+                for (size_t i = 0; i < len; i++) {
+                    char c = sql[i];
+                    char next = i + 1 < len ? sql[i + 1] : 0;
+
+                    switch (c) {
+                        case '\'':
+                            // a postgres E'' string always has backslash escapes
+                            if (i > 0 && (sql[i - 1] == 'E' || sql[i - 1] == 'e') && (i == 1 || !is_identifier(sql[i - 2]))) {
+                                i = skip_quoted(sql, i, true);
+                                break;
+                            }
+                            i = skip_quoted(sql, i, backslashEscapes);
+                            break;
+                        case '"':
+                            i = skip_quoted(sql, i, backslashEscapes);
+                            break;
+                        case '`':
+                            i = skip_quoted(sql, i, false);
+                            break;
+                        case '-':
+                            // line comment
+                            if (next == '-') {
+                                i = sql.find('\n', i);
+                                if (i == std::string::npos) {
+                                    i = len;
+                                }
+                            }
+                            break;
+                        case '/':
+                            // block comment
+                            if (next == '*') {
+                                i = sql.find("*/", i + 2);
+                                i = i == std::string::npos ? len : i + 1;
+                            }
+                            break;
+                        case '?':
+                            if (indexed == '$') {
+                                throw binding_error("? and $n parameters can not be mixed");
+                            }
+                            indexed = c;
+                            params.push_back({i, 1, c, 0});
+                            break;
+                        case '$': {
+                            // part of an identifier
+                            if (i > 0 && is_identifier(sql[i - 1])) {
+                                break;
+                            }
+
+                            size_t end = i + 1;
+
+                            if (isdigit(static_cast<unsigned char>(next))) {
+                                size_t number = 0;
+
+                                for (; end < len && isdigit(static_cast<unsigned char>(sql[end])); end++) {
+                                    number = number * 10 + (sql[end] - '0');
+                                }
+
+                                if (indexed == '?') {
+                                    throw binding_error("? and $n parameters can not be mixed");
+                                }
+                                indexed = c;
+                                params.push_back({i, end - i, c, number});
+                                i = end - 1;
+                                break;
+                            }
+
+                            // a dollar quoted string, $$ or $tag$
+                            while (end < len && is_identifier(sql[end])) {
+                                end++;
+                            }
+
+                            if (end < len && sql[end] == '$') {
+                                auto tag = sql.substr(i, end - i + 1);
+
+                                end = sql.find(tag, end + 1);
+
+                                i = end == std::string::npos ? len : end + tag.length() - 1;
+                            }
+                            break;
+                        }
+                        case ':':
+                            // a cast
+                            if (next == ':') {
+                                i++;
+                                break;
+                            }
+                        // fall through to a named parameter
+                        case '@': {
+                            // a mysql system variable
+                            if (c == '@' && next == '@') {
+                                for (i += 2; i < len && is_identifier(sql[i]); i++)
+                                    ;
+                                i--;
+                                break;
+                            }
+
+                            if (!isalpha(static_cast<unsigned char>(next)) && next != '_') {
+                                break;
+                            }
+
+                            size_t end = i + 1;
+
+                            while (end < len && is_identifier(sql[end])) {
+                                end++;
+                            }
+
+                            params.push_back({i, end - i, c, 0});
+                            i = end - 1;
+                            break;
+                        }
+                    }
+                }
+
+                return params;
+            }
+        }
+
+        const size_t rewritten_sql_cache::DEFAULT_CAPACITY;
+
+        rewritten_sql_cache::rewritten_sql_cache(size_t capacity) : capacity_(capacity)
+        {
+        }
+
+        std::shared_ptr<const rewritten_sql> rewritten_sql_cache::get(const std::string &sql)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto it = values_.find(sql);
+
+            if (it == values_.end()) {
+                return nullptr;
+            }
+
+            return it->second;
+        }
+
+        void rewritten_sql_cache::put(const std::string &sql, const std::shared_ptr<const rewritten_sql> &value)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // generated sql can be unbounded, so start over rather than grow forever
+            if (values_.size() >= capacity_) {
+                values_.clear();
+            }
+
+            values_[sql] = value;
+        }
 
         bind_mapping::bind_mapping()
         {
@@ -79,16 +272,20 @@ namespace rj
         {
             mappings_.clear();
 
-            auto match_begin = std::sregex_iterator(sql.begin(), sql.end(), named_regex);
-            auto match_end = std::sregex_iterator();
-
-            for (auto match = match_begin; match != match_end; ++match) {
-                add_named_param(match->str(), ++max_index);
+            for (auto &param : helper::find_parameters(sql)) {
+                if (param.type == '@' || param.type == ':') {
+                    add_named_param(sql.substr(param.offset, param.length), ++max_index);
+                }
             }
 
             return sql;
         }
 
+        void bind_mapping::prepare(const rewritten_sql &value)
+        {
+            mappings_ = value.named;
+        }
+
         bool bind_mapping::is_named() const
         {
             return mappings_.size() > 0;
@@ -3,7 +3,10 @@
 
 #include "bindable.h"
 
-#ifndef ENHANCED_PARAMETER_MAPPING
+#ifdef ENHANCED_PARAMETER_MAPPING
+#include <memory>
+#include <mutex>
+#else
 #include "exception.h"
 #endif
 
@@ -12,6 +15,78 @@ namespace rj
     namespace db
     {
 #ifdef ENHANCED_PARAMETER_MAPPING
+        namespace helper
+        {
+            /*!
+             * a parameter found in a sql string
+             */
+            struct sql_parameter {
+                /*! the offset of the parameter in the sql */
+                size_t offset;
+                /*! the length of the parameter in the sql */
+                size_t length;
+                /*! the first character of the parameter, one of '?', '$', '@' or ':' */
+                char type;
+                /*! the number of a $n parameter */
+                size_t number;
+            };
+
+            /*!
+             * finds the parameters in a sql string in a single pass, skipping quotes, comments and casts
+             * a postgres E'' string is always read with backslash escapes
+             * @param sql the sql string
+             * @param backslashEscapes true if a backslash escapes the next character in a quoted string
+             * @return the parameters in order
+             * @throws binding_error if ? and $n parameters are mixed, as their numbers would be ambiguous
+             */
+            std::vector<sql_parameter> find_parameters(const std::string &sql, bool backslashEscapes = false);
+        }
+
+        /*!
+         * a sql string with its parameters rewritten for a database, and where to bind them
+         */
+        struct rewritten_sql {
+            /*! the sql with the parameters the database understands */
+            std::string sql;
+            /*! the binding indexes for each named parameter */
+            std::unordered_map<std::string, std::set<size_t>> named;
+            /*! the positions in the sql for each binding index, if they differ */
+            std::unordered_map<size_t, std::set<size_t>> positions;
+        };
+
+        /*!
+         * a thread safe cache of rewritten sql, so each distinct sql string is only parsed once
+         */
+        class rewritten_sql_cache
+        {
+           public:
+            /*! the number of sql strings kept before the cache is emptied */
+            constexpr static const size_t DEFAULT_CAPACITY = 512;
+
+           private:
+            std::unordered_map<std::string, std::shared_ptr<const rewritten_sql>> values_;
+            size_t capacity_;
+            std::mutex mutex_;
+
+           public:
+            /*!
+             * @param capacity the number of sql strings to keep
+             */
+            rewritten_sql_cache(size_t capacity = DEFAULT_CAPACITY);
+
+            /*!
+             * @param sql the original sql
+             * @return the rewritten sql, or nullptr if not cached
+             */
+            std::shared_ptr<const rewritten_sql> get(const std::string &sql);
+
+            /*!
+             * @param sql the original sql
+             * @param value the rewritten sql
+             */
+            void put(const std::string &sql, const std::shared_ptr<const rewritten_sql> &value);
+        };
+
         /*!
          * a binding that supports mapping named parameters to indexed parameters
          */
@@ -37,6 +112,12 @@ namespace rj
              */
             std::string prepare(const std::string &sql, size_t max_index);
 
+            /*!
+             * uses the named parameters of rewritten sql
+             * @param value the rewritten sql
+             */
+            void prepare(const rewritten_sql &value);
+
             bind_mapping &bind(const std::string &name, const sql_value &value);
 
             bool is_named() const;
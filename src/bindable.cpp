@@ -7,13 +7,6 @@ namespace rj
 {
     namespace db
     {
-#ifdef ENHANCED_PARAMETER_MAPPING
-        // these ugly beasts will find parameters not in quotes
-        std::regex bindable::param_regex("([@:]\\w+|\\$([0-9]+)|\\?)(?=(?:[^\"']|[\"'][^\"']*[\"'])*$)");
-        std::regex bindable::index_regex("(\\$([0-9]+)|\\?)(?=(?:[^\"']|[\"'][^\"']*[\"'])*$)");
-        std::regex bindable::named_regex("([@:]\\w+)(?=(?:[^\"']|[\"'][^\"']*[\"'])*$)");
-#endif
-
         bindable &bindable::bind_value(size_t index, const sql_value &value)
         {
             switch (value.type()) {
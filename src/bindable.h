@@ -5,10 +5,6 @@
 #ifndef RJ_DB_BINDABLE_H
 #define RJ_DB_BINDABLE_H
 
-#ifdef ENHANCED_PARAMETER_MAPPING
-#include <regex>
-#endif
-
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -54,11 +50,6 @@ namespace rj
             }
 
            public:
-#ifdef ENHANCED_PARAMETER_MAPPING
-            static std::regex param_regex;
-            static std::regex index_regex;
-            static std::regex named_regex;
-#endif
             template <typename T, typename... List>
             bindable &bind_all(const T &value, const List &... argv)
             {
@@ -0,0 +1,123 @@
+#include "blob_stream.h"
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "exception.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        constexpr const size_t blob_reader::DEFAULT_CHUNK_SIZE;
+        constexpr const size_t blob_writer::DEFAULT_CHUNK_SIZE;
+
+        blob_reader::blob_reader() : position_(0)
+        {
+        }
+
+        blob_reader::~blob_reader()
+        {
+        }
+
+        size_t blob_reader::position() const
+        {
+            return position_;
+        }
+
+        void blob_reader::seek(size_t offset)
+        {
+            if (offset > size()) {
+                throw database_exception("blob offset is past the end");
+            }
+
+            position_ = offset;
+        }
+
+        size_t blob_reader::read(void *buffer, size_t length)
+        {
+            size_t total = size();
+
+            if (buffer == nullptr || position_ >= total) {
+                return 0;
+            }
+
+            length = std::min(length, total - position_);
+
+            if (length == 0) {
+                return 0;
+            }
+
+            read_at(buffer, length, position_);
+
+            position_ += length;
+
+            return length;
+        }
+
+        size_t blob_reader::read(std::ostream &out, size_t chunkSize)
+        {
+            vector<char> buffer(std::max<size_t>(1, chunkSize));
+
+            size_t total = 0, count = 0;
+
+            while ((count = read(buffer.data(), buffer.size())) > 0) {
+                if (!out.write(buffer.data(), count)) {
+                    throw database_exception("unable to write blob to stream");
+                }
+                total += count;
+            }
+
+            return total;
+        }
+
+        blob_writer::blob_writer() : position_(0)
+        {
+        }
+
+        blob_writer::~blob_writer()
+        {
+        }
+
+        size_t blob_writer::position() const
+        {
+            return position_;
+        }
+
+        void blob_writer::write(const void *buffer, size_t length)
+        {
+            if (buffer == nullptr || length == 0) {
+                return;
+            }
+
+            write_next(buffer, length);
+
+            position_ += length;
+        }
+
+        size_t blob_writer::write(std::istream &in, size_t chunkSize)
+        {
+            vector<char> buffer(std::max<size_t>(1, chunkSize));
+
+            size_t total = 0;
+
+            while (in) {
+                in.read(buffer.data(), buffer.size());
+
+                auto count = static_cast<size_t>(in.gcount());
+
+                if (count == 0) {
+                    break;
+                }
+
+                write(buffer.data(), count);
+
+                total += count;
+            }
+
+            return total;
+        }
+    }
+}
@@ -0,0 +1,141 @@
+/*!
+ * @file blob_stream.h
+ * reads and writes large column values in pieces
+ */
+#ifndef RJ_DB_BLOB_STREAM_H
+#define RJ_DB_BLOB_STREAM_H
+
+#include <iosfwd>
+#include <string>
+
+namespace rj
+{
+    namespace db
+    {
+        /*!
+         * reads a blob column of one row in chunks, so the value is never held in memory all at once
+         * open one with session::open_blob_reader
+         */
+        class blob_reader
+        {
+           protected:
+            size_t position_;
+
+            /*!
+             * reads part of the blob
+             * @param buffer the buffer to read into
+             * @param length the number of bytes to read, never past the end of the blob
+             * @param offset the offset in the blob to read from
+             */
+            virtual void read_at(void *buffer, size_t length, size_t offset) = 0;
+
+           public:
+            /*! the default number of bytes copied at a time to and from streams */
+            constexpr static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+            blob_reader();
+
+            /* non-copyable boilerplate */
+            blob_reader(const blob_reader &other) = delete;
+            blob_reader(blob_reader &&other) = delete;
+            blob_reader &operator=(const blob_reader &other) = delete;
+            blob_reader &operator=(blob_reader &&other) = delete;
+            virtual ~blob_reader();
+
+            /*!
+             * @return the size of the blob in bytes
+             */
+            virtual size_t size() const = 0;
+
+            /*!
+             * @return the offset the next read starts at
+             */
+            size_t position() const;
+
+            /*!
+             * moves the offset the next read starts at
+             * @param offset the offset in bytes
+             * @throws database_exception if the offset is past the end of the blob
+             */
+            void seek(size_t offset);
+
+            /*!
+             * reads the next part of the blob
+             * @param buffer the buffer to read into
+             * @param length the size of the buffer
+             * @return the number of bytes read, zero at the end of the blob
+             * @throws database_exception if the read failed
+             */
+            size_t read(void *buffer, size_t length);
+
+            /*!
+             * copies the rest of the blob to a stream
+             * @param out the stream to write to
+             * @param chunkSize the number of bytes to read at a time
+             * @return the number of bytes copied
+             * @throws database_exception if a read failed
+             */
+            size_t read(std::ostream &out, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+        };
+
+        /*!
+         * replaces a blob column of one row by writing it in chunks
+         * open one with session::open_blob_writer, and close it to finish the value
+         */
+        class blob_writer
+        {
+           protected:
+            size_t position_;
+
+            /*!
+             * writes the next part of the blob
+             * @param buffer the bytes to write
+             * @param length the number of bytes
+             */
+            virtual void write_next(const void *buffer, size_t length) = 0;
+
+           public:
+            /*! the default number of bytes copied at a time to and from streams */
+            constexpr static const size_t DEFAULT_CHUNK_SIZE = blob_reader::DEFAULT_CHUNK_SIZE;
+
+            blob_writer();
+
+            /* non-copyable boilerplate */
+            blob_writer(const blob_writer &other) = delete;
+            blob_writer(blob_writer &&other) = delete;
+            blob_writer &operator=(const blob_writer &other) = delete;
+            blob_writer &operator=(blob_writer &&other) = delete;
+            virtual ~blob_writer();
+
+            /*!
+             * @return the number of bytes written
+             */
+            size_t position() const;
+
+            /*!
+             * appends to the blob
+             * @param buffer the bytes to write
+             * @param length the number of bytes
+             * @throws database_exception if the write failed
+             */
+            void write(const void *buffer, size_t length);
+
+            /*!
+             * appends the rest of a stream to the blob
+             * @param in the stream to read from
+             * @param chunkSize the number of bytes to write at a time
+             * @return the number of bytes copied
+             * @throws database_exception if a write failed
+             */
+            size_t write(std::istream &in, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+            /*!
+             * finishes the blob, no more can be written
+             * @throws database_exception if the blob could not be saved
+             */
+            virtual void close() = 0;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,43 @@
+#include "column_names.h"
+
+namespace rj
+{
+    namespace db
+    {
+        void column_names::add(const std::string &name, size_t position)
+        {
+            // the first column wins, as with a scan of the names
+            indexes_.emplace(name, position);
+        }
+
+        int column_names::index_of(const std::string &name) const
+        {
+            auto it = indexes_.find(name);
+
+            if (it == indexes_.end()) {
+                return -1;
+            }
+
+            return it->second;
+        }
+
+        size_t column_names::size() const
+        {
+            return indexes_.size();
+        }
+
+        column_handle::column_handle(const std::string &name, size_t position) : name_(name), position_(position)
+        {
+        }
+
+        std::string column_handle::name() const
+        {
+            return name_;
+        }
+
+        size_t column_handle::position() const
+        {
+            return position_;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/*!
+ * @file column_names.h
+ * name to index lookups for the columns of a result set
+ */
+#ifndef RJ_DB_COLUMN_NAMES_H
+#define RJ_DB_COLUMN_NAMES_H
+
+#include <string>
+#include <unordered_map>
+
+namespace rj
+{
+    namespace db
+    {
+        /*!
+         * a hashed lookup of column names to their index, built once per result set and shared by its rows
+         */
+        class column_names
+        {
+           private:
+            std::unordered_map<std::string, size_t> indexes_;
+
+           public:
+            /*!
+             * adds a column, keeping the first index when a name is repeated
+             * @param name the name of the column
+             * @param position the index of the column
+             */
+            void add(const std::string &name, size_t position);
+
+            /*!
+             * finds the index of a column
+             * @param name the name of the column
+             * @return the index of the column, or -1 if not found
+             */
+            int index_of(const std::string &name) const;
+
+            /*!
+             * @return the number of named columns
+             */
+            size_t size() const;
+        };
+
+        /*!
+         * a column name resolved to its index, for reading the same column from many rows
+         */
+        class column_handle
+        {
+           private:
+            std::string name_;
+            size_t position_;
+
+           public:
+            /*!
+             * @param name the name of the column
+             * @param position the index of the column
+             */
+            column_handle(const std::string &name, size_t position);
+
+            /*!
+             * @return the name of the column
+             */
+            std::string name() const;
+
+            /*!
+             * @return the index of the column
+             */
+            size_t position() const;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,116 @@
+#include "identity_map.h"
+#include "exception.h"
+#include "session.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        identity_map::identity_map()
+        {
+        }
+
+        identity_map::identity_map(const identity_map &other) : records_(other.records_)
+        {
+        }
+
+        identity_map::identity_map(identity_map &&other) : records_(std::move(other.records_))
+        {
+        }
+
+        identity_map &identity_map::operator=(const identity_map &other)
+        {
+            records_ = other.records_;
+            return *this;
+        }
+
+        identity_map &identity_map::operator=(identity_map &&other)
+        {
+            records_ = std::move(other.records_);
+            return *this;
+        }
+
+        identity_map::~identity_map()
+        {
+        }
+
+        string identity_map::key(const string &tableName, const sql_value &id)
+        {
+            return tableName + '\n' + id.to_string();
+        }
+
+        shared_ptr<void> identity_map::find(const string &tableName, const sql_value &id, const type_index &type) const
+        {
+            if (id.is_null()) {
+                return nullptr;
+            }
+
+            auto i = records_.find(key(tableName, id));
+
+            // a table mapped to another record type is a miss
+            if (i == records_.end() || i->second.first != type) {
+                return nullptr;
+            }
+
+            return i->second.second;
+        }
+
+        void identity_map::insert(const string &tableName, const sql_value &id, const type_index &type, const shared_ptr<void> &record)
+        {
+            if (id.is_null() || record == nullptr) {
+                return;
+            }
+
+            auto k = key(tableName, id);
+
+            records_.erase(k);
+
+            records_.emplace(k, make_pair(type, record));
+        }
+
+        void identity_map::erase(const string &tableName, const sql_value &id)
+        {
+            if (id.is_null()) {
+                return;
+            }
+
+            records_.erase(key(tableName, id));
+        }
+
+        void identity_map::clear()
+        {
+            records_.clear();
+        }
+
+        size_t identity_map::size() const
+        {
+            return records_.size();
+        }
+
+        identity_scope::identity_scope(const shared_ptr<session> &session) : session_(session)
+        {
+            if (session_ == nullptr) {
+                throw database_exception("no session for identity scope");
+            }
+
+            previous_ = session_->get_identity_map();
+
+            session_->set_identity_map(make_shared<identity_map>());
+        }
+
+        identity_scope::identity_scope(identity_scope &&other) : session_(std::move(other.session_)), previous_(std::move(other.previous_))
+        {
+            other.session_ = nullptr;
+            other.previous_ = nullptr;
+        }
+
+        identity_scope::~identity_scope()
+        {
+            if (session_ != nullptr) {
+                session_->set_identity_map(previous_);
+            }
+        }
+    }
+}
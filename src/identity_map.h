@@ -0,0 +1,114 @@
+/*!
+ * @file identity_map.h
+ * a cache of the records loaded in a unit of work
+ */
+#ifndef RJ_DB_IDENTITY_MAP_H
+#define RJ_DB_IDENTITY_MAP_H
+
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include "sql_value.h"
+
+namespace rj
+{
+    namespace db
+    {
+        class session;
+
+        /*!
+         * keeps one instance of each record loaded by primary key, so repeated lookups skip the database
+         * set one on a session to enable it, or use an identity_scope to limit it to a unit of work
+         */
+        class identity_map
+        {
+           private:
+            std::unordered_map<std::string, std::pair<std::type_index, std::shared_ptr<void>>> records_;
+
+            static std::string key(const std::string &tableName, const sql_value &id);
+
+            std::shared_ptr<void> find(const std::string &tableName, const sql_value &id, const std::type_index &type) const;
+
+            void insert(const std::string &tableName, const sql_value &id, const std::type_index &type, const std::shared_ptr<void> &record);
+
+           public:
+            identity_map();
+
+            /* boilerplate */
+            identity_map(const identity_map &other);
+            identity_map(identity_map &&other);
+            identity_map &operator=(const identity_map &other);
+            identity_map &operator=(identity_map &&other);
+            virtual ~identity_map();
+
+            /*!
+             * gets a loaded record
+             * @param tableName the table of the record
+             * @param id the primary key value
+             * @return the record or nullptr if it was not loaded as the type
+             */
+            template <typename T>
+            std::shared_ptr<T> get(const std::string &tableName, const sql_value &id) const
+            {
+                return std::static_pointer_cast<T>(find(tableName, id, typeid(T)));
+            }
+
+            /*!
+             * remembers a loaded record
+             * @param tableName the table of the record
+             * @param id the primary key value
+             * @param record the record
+             */
+            template <typename T>
+            void put(const std::string &tableName, const sql_value &id, const std::shared_ptr<T> &record)
+            {
+                insert(tableName, id, typeid(T), record);
+            }
+
+            /*!
+             * forgets a loaded record
+             * @param tableName the table of the record
+             * @param id the primary key value
+             */
+            void erase(const std::string &tableName, const sql_value &id);
+
+            /*!
+             * forgets all loaded records
+             */
+            void clear();
+
+            /*!
+             * @return the number of loaded records
+             */
+            size_t size() const;
+        };
+
+        /*!
+         * gives a session a new identity map for the lifetime of the scope, such as a transaction
+         * the previous map of the session is restored when the scope ends
+         */
+        class identity_scope
+        {
+           private:
+            std::shared_ptr<session> session_;
+            std::shared_ptr<identity_map> previous_;
+
+           public:
+            /*!
+             * @param session the session to scope
+             */
+            identity_scope(const std::shared_ptr<session> &session);
+
+            /* non-copyable boilerplate */
+            identity_scope(const identity_scope &other) = delete;
+            identity_scope(identity_scope &&other);
+            identity_scope &operator=(const identity_scope &other) = delete;
+            identity_scope &operator=(identity_scope &&other) = delete;
+            virtual ~identity_scope();
+        };
+    }
+}
+
+#endif
@@ -1,4 +1,6 @@
 #include "insert_query.h"
+#include <algorithm>
+#include "exception.h"
 #include "log.h"
 #include "schema.h"
 #include "session.h"
@@ -15,7 +17,8 @@ namespace rj
          * @param tableName the table to modify
          * @param columns the columns to modify
          */
-        insert_query::insert_query(const std::shared_ptr<rj::db::session> &session, const std::string &tableName) : modify_query(session)
+        insert_query::insert_query(const std::shared_ptr<rj::db::session> &session, const std::string &tableName)
+            : modify_query(session), lastId_(0)
         {
             tableName_ = tableName;
         }
@@ -26,7 +29,7 @@ namespace rj
          */
         insert_query::insert_query(const std::shared_ptr<rj::db::session> &session, const std::string &tableName,
                                    const std::vector<std::string> &columns)
-            : modify_query(session)
+            : modify_query(session), lastId_(0)
         {
             tableName_ = tableName;
             columns_ = columns;
@@ -37,29 +40,52 @@ namespace rj
          * @param column the specific columns to modify in the schema
          */
         insert_query::insert_query(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns)
-            : modify_query(schema->get_session())
+            : modify_query(schema->get_session()), lastId_(0)
         {
             tableName_ = schema->table_name();
             columns_ = columns;
         }
 
 
+        // buffered values are not copied, so they are only inserted once
         insert_query::insert_query(const insert_query &other)
-            : modify_query(other), lastId_(other.lastId_), columns_(other.columns_), tableName_(other.tableName_)
+            : modify_query(other), lastId_(other.lastId_), lastIds_(other.lastIds_), columns_(other.columns_), tableName_(other.tableName_)
         {
         }
         insert_query::insert_query(insert_query &&other)
-            : modify_query(std::move(other)), lastId_(other.lastId_), columns_(std::move(other.columns_)), tableName_(std::move(other.tableName_))
+            : modify_query(std::move(other)),
+              lastId_(other.lastId_),
+              lastIds_(std::move(other.lastIds_)),
+              columns_(std::move(other.columns_)),
+              tableName_(std::move(other.tableName_)),
+              batch_(std::move(other.batch_))
         {
+            other.batch_.clear();
         }
 
         insert_query::~insert_query()
         {
+            discard_batch();
         }
+
+        void insert_query::discard_batch()
+        {
+            if (batch_.empty()) {
+                return;
+            }
+
+            // inserting here could only fail silently, so a missing flush is reported instead
+            log::error("buffered insert into %s discarded %zu unflushed values, flush() was not called", tableName_.c_str(), batch_.size());
+
+            batch_.clear();
+        }
+
         insert_query &insert_query::operator=(const insert_query &other)
         {
+            discard_batch();
             modify_query::operator=(other);
             lastId_ = other.lastId_;
+            lastIds_ = other.lastIds_;
             columns_ = other.columns_;
             tableName_ = other.tableName_;
             return *this;
@@ -67,10 +93,14 @@ namespace rj
 
         insert_query &insert_query::operator=(insert_query &&other)
         {
+            discard_batch();
             modify_query::operator=(std::move(other));
             lastId_ = other.lastId_;
+            lastIds_ = std::move(other.lastIds_);
             columns_ = std::move(other.columns_);
             tableName_ = std::move(other.tableName_);
+            batch_ = std::move(other.batch_);
+            other.batch_.clear();
             return *this;
         }
 
@@ -84,7 +114,17 @@ namespace rj
             return lastId_;
         }
 
+        vector<long long> insert_query::last_insert_ids() const
+        {
+            return lastIds_;
+        }
+
         string insert_query::to_string() const
+        {
+            return to_string(1);
+        }
+
+        string insert_query::to_string(size_t rows) const
         {
             if (session_ == nullptr) {
                 throw database_exception("invalid query, no database");
@@ -95,7 +135,20 @@ namespace rj
                 throw database_exception("invalid query, schema not found or initialized yet");
             }
 
-            return session_->insert_sql(session_->get_schema(tableName_), columns_);
+            if (flags_ & Upsert) {
+                return session_->upsert_sql(schema, columns_, rows);
+            }
+
+            return session_->insert_sql(schema, columns_, rows);
+        }
+
+        size_t insert_query::batch_rows() const
+        {
+            if (columns_.empty()) {
+                return 1;
+            }
+
+            return std::max<size_t>(1, session_->max_parameters() / columns_.size());
         }
 
         insert_query &insert_query::columns(const vector<string> &columns)
@@ -115,6 +168,24 @@ namespace rj
                 throw database_exception("invalid insert query");
             }
 
+            if (flags_ & Buffered) {
+                if (!named_params_.empty()) {
+                    throw binding_error("buffered inserts only support positional values");
+                }
+
+                if (params_.size() != columns_.size()) {
+                    throw binding_error("buffered insert values do not match the columns");
+                }
+
+                batch_.insert(batch_.end(), params_.begin(), params_.end());
+
+                if (batch_.size() >= batch_rows() * columns_.size()) {
+                    flush();
+                }
+
+                return 1;
+            }
+
             prepare(to_string());
 
             bool success = stmt_->result();
@@ -122,17 +193,71 @@ namespace rj
             if (success) {
                 numChanges_ = stmt_->last_number_of_changes();
                 lastId_ = stmt_->last_insert_id();
+                lastIds_ = stmt_->last_insert_ids();
             } else {
                 lastId_ = 0;
+                lastIds_.clear();
                 numChanges_ = 0;
             }
 
-            // if (flags_ & Batch) {
             stmt_->reset();
-            //} else {
-            //    stmt_->finish();
-            //    stmt_ = nullptr;
-            //}
+
+            return numChanges_;
+        }
+
+        int insert_query::flush()
+        {
+            if (batch_.empty()) {
+                return 0;
+            }
+
+            if (!is_valid()) {
+                throw database_exception("invalid insert query");
+            }
+
+            vector<sql_value> values;
+
+            values.swap(batch_);
+
+            // the current values are restored once the batch is sent
+            auto current = std::move(params_);
+
+            size_t width = std::max<size_t>(1, columns_.size());
+            size_t limit = batch_rows() * width;
+
+            numChanges_ = 0;
+            lastIds_.clear();
+
+            for (size_t offset = 0; offset < values.size(); offset += limit) {
+                size_t count = std::min(limit, values.size() - offset);
+
+                params_.assign(values.begin() + offset, values.begin() + offset + count);
+
+                // full batches share the same sql, so the session can reuse the statement
+                stmt_ = nullptr;
+
+                prepare(to_string(count / width));
+
+                if (!stmt_->result()) {
+                    auto error = stmt_->last_error();
+                    stmt_ = nullptr;
+                    params_ = std::move(current);
+                    throw database_exception(error);
+                }
+
+                numChanges_ += stmt_->last_number_of_changes();
+
+                auto ids = stmt_->last_insert_ids();
+
+                lastId_ = ids.empty() ? stmt_->last_insert_id() : ids.back();
+
+                lastIds_.insert(lastIds_.end(), ids.begin(), ids.end());
+            }
+
+            // the statement inserts many rows, so the next execute prepares its own
+            stmt_ = nullptr;
+
+            params_ = std::move(current);
 
             return numChanges_;
         }
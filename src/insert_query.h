@@ -46,6 +46,12 @@ namespace rj
              */
             long long last_insert_id() const;
 
+            /*!
+             * gets the ids generated by the last execute or flush, for backends that report them
+             * @return the list of ids
+             */
+            std::vector<long long> last_insert_ids() const;
+
             /*!
              * @return the sql/string representation of this query
              */
@@ -106,10 +112,19 @@ namespace rj
 
             /*!
              * executes the insert query
-             * @return the number of records inserted
+             * with the Buffered flag the values are kept until enough exist for a statement or flush is called
+             * @return the number of records inserted, or buffered
              */
             int execute();
 
+            /*!
+             * inserts any values kept by the Buffered flag
+             * it must be called before the query is destroyed or assigned, which discard buffered values as an error
+             * @return the number of records inserted
+             * @throws database_exception if the insert failed
+             */
+            int flush();
+
             /*!
              * tests if this query is valid
              * @return true if valid
@@ -123,9 +138,15 @@ namespace rj
                 return *this;
             }
 
+            std::string to_string(size_t rows) const;
+            size_t batch_rows() const;
+            void discard_batch();
+
             long long lastId_;
+            std::vector<long long> lastIds_;
             std::vector<std::string> columns_;
             std::string tableName_;
+            std::vector<sql_value> batch_;
         };
     }
 }
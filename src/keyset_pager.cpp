@@ -0,0 +1,234 @@
+#include "keyset_pager.h"
+#include "bind_mapping.h"
+#include "exception.h"
+#include "resultset.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        namespace helper
+        {
+            /*!
+             * gets the name of a key column in the results, without any table qualifier
+             */
+            static string result_column_name(const string &key)
+            {
+                auto pos = key.rfind('.');
+
+                if (pos == string::npos) {
+                    return key;
+                }
+
+                return key.substr(pos + 1);
+            }
+        }
+
+        keyset_pager::keyset_pager(const select_query &query, const vector<string> &keys, size_t pageSize, bool descending)
+            : query_(query), keys_(keys), pageSize_(pageSize), descending_(descending), done_(false)
+        {
+            if (keys_.empty()) {
+                throw database_exception("keyset pagination requires key columns");
+            }
+
+            if (pageSize_ == 0) {
+                throw database_exception("keyset pagination requires a page size");
+            }
+        }
+
+        keyset_pager::keyset_pager(const keyset_pager &other)
+            : query_(other.query_),
+              keys_(other.keys_),
+              pageSize_(other.pageSize_),
+              descending_(other.descending_),
+              last_(other.last_),
+              done_(other.done_)
+        {
+        }
+
+        keyset_pager::keyset_pager(keyset_pager &&other)
+            : query_(std::move(other.query_)),
+              keys_(std::move(other.keys_)),
+              pageSize_(other.pageSize_),
+              descending_(other.descending_),
+              last_(std::move(other.last_)),
+              done_(other.done_)
+        {
+        }
+
+        keyset_pager &keyset_pager::operator=(const keyset_pager &other)
+        {
+            query_ = other.query_;
+            keys_ = other.keys_;
+            pageSize_ = other.pageSize_;
+            descending_ = other.descending_;
+            last_ = other.last_;
+            done_ = other.done_;
+            return *this;
+        }
+
+        keyset_pager &keyset_pager::operator=(keyset_pager &&other)
+        {
+            query_ = std::move(other.query_);
+            keys_ = std::move(other.keys_);
+            pageSize_ = other.pageSize_;
+            descending_ = other.descending_;
+            last_ = std::move(other.last_);
+            done_ = other.done_;
+            return *this;
+        }
+
+        keyset_pager::~keyset_pager()
+        {
+        }
+
+        select_query keyset_pager::page_query() const
+        {
+            select_query page(query_);
+
+            string order = helper::join_csv(keys_);
+
+            if (descending_) {
+                order.clear();
+
+                for (size_t i = 0; i < keys_.size(); i++) {
+                    if (i > 0) {
+                        order += ",";
+                    }
+                    order += keys_[i] + " DESC";
+                }
+            }
+
+            page.order_by(order);
+
+            page.limit(std::to_string(pageSize_));
+
+            if (last_.empty()) {
+                return page;
+            }
+
+            // the key values are bound after the parameters of the query
+            size_t index = query_.bound_params() + 1;
+
+            where_clause base = query_.where();
+
+            // ? parameters can not be mixed with numbered ones, and come last in the sql so they number the same
+            bool positional = false;
+
+#ifdef ENHANCED_PARAMETER_MAPPING
+            for (auto &param : helper::find_parameters(base.to_string())) {
+                positional = positional || param.type == '?';
+            }
+#endif
+
+            ostringstream seek;
+
+            seek << "(" << helper::join_csv(keys_) << ") " << (descending_ ? "<" : ">") << " (";
+
+            for (size_t i = 0; i < last_.size(); i++) {
+                if (i > 0) {
+                    seek << ",";
+                }
+                if (positional) {
+                    seek << "?";
+                } else {
+                    seek << "$" << (index + i);
+                }
+            }
+
+            seek << ")";
+
+            if (base.empty()) {
+                page.where(where_clause(seek.str()));
+            } else {
+                // keep any OR in the original clause from escaping the seek
+                where_clause combined("(" + base.to_string() + ")");
+
+                combined && seek.str();
+
+                page.where(combined);
+            }
+
+            for (size_t i = 0; i < last_.size(); i++) {
+                page.bind_value(index + i, last_[i]);
+            }
+
+            return page;
+        }
+
+        size_t keyset_pager::next(const std::function<void(const row &)> &funk)
+        {
+            if (done_) {
+                return 0;
+            }
+
+            auto page = page_query();
+
+            auto rs = page.execute();
+
+            size_t count = 0;
+
+            for (auto row : rs) {
+                if (funk) {
+                    funk(row);
+                }
+
+                last_.clear();
+
+                for (auto &key : keys_) {
+                    last_.push_back(row.column(helper::result_column_name(key)).to_value());
+                }
+
+                count++;
+            }
+
+            // a short page is the last one
+            if (count < pageSize_) {
+                done_ = true;
+            }
+
+            return count;
+        }
+
+        size_t keyset_pager::for_each(const std::function<void(const row &)> &funk)
+        {
+            size_t total = 0, count = 0;
+
+            while ((count = next(funk)) > 0) {
+                total += count;
+            }
+
+            return total;
+        }
+
+        bool keyset_pager::is_done() const
+        {
+            return done_;
+        }
+
+        vector<sql_value> keyset_pager::last_key() const
+        {
+            return last_;
+        }
+
+        keyset_pager &keyset_pager::seek(const vector<sql_value> &key)
+        {
+            if (!key.empty() && key.size() != keys_.size()) {
+                throw binding_error("keyset values do not match the key columns");
+            }
+
+            last_ = key;
+            done_ = false;
+
+            return *this;
+        }
+
+        void keyset_pager::reset()
+        {
+            last_.clear();
+            done_ = false;
+        }
+    }
+}
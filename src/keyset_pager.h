@@ -0,0 +1,91 @@
+/*!
+ * @file keyset_pager.h
+ * pages through a select query by the values of its ordered columns
+ */
+#ifndef RJ_DB_KEYSET_PAGER_H
+#define RJ_DB_KEYSET_PAGER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "select_query.h"
+
+namespace rj
+{
+    namespace db
+    {
+        /*!
+         * pages through the results of a select query using the last key of each page
+         * ex. WHERE (a, b) > ($1, $2) ORDER BY a, b LIMIT n
+         * unlike an offset, each page seeks directly to its first row instead of rescanning the earlier ones
+         * the keys must uniquely order the rows, for example by ending with the primary key
+         */
+        class keyset_pager
+        {
+           private:
+            select_query query_;
+            std::vector<std::string> keys_;
+            size_t pageSize_;
+            bool descending_;
+            std::vector<sql_value> last_;
+            bool done_;
+
+            select_query page_query() const;
+
+           public:
+            /*!
+             * @param query the query to page, its order by and limit are replaced
+             * @param keys the columns to order and seek by
+             * @param pageSize the maximum number of rows in a page
+             * @param descending true to page from the largest keys to the smallest
+             */
+            keyset_pager(const select_query &query, const std::vector<std::string> &keys, size_t pageSize, bool descending = false);
+
+            /* boilerplate */
+            keyset_pager(const keyset_pager &other);
+            keyset_pager(keyset_pager &&other);
+            keyset_pager &operator=(const keyset_pager &other);
+            keyset_pager &operator=(keyset_pager &&other);
+            virtual ~keyset_pager();
+
+            /*!
+             * reads the next page, remembering its last key
+             * @param funk a callback for each row in the page
+             * @return the number of rows in the page, zero when there are no more
+             */
+            size_t next(const std::function<void(const row &)> &funk);
+
+            /*!
+             * reads every remaining page
+             * @param funk a callback for each row
+             * @return the number of rows read
+             */
+            size_t for_each(const std::function<void(const row &)> &funk);
+
+            /*!
+             * @return true when the last page has been read
+             */
+            bool is_done() const;
+
+            /*!
+             * @return the key values of the last row read, empty before the first page
+             */
+            std::vector<sql_value> last_key() const;
+
+            /*!
+             * continues paging after a key, such as one saved from an earlier pager
+             * @param key the values of the key columns
+             * @return a reference to this instance
+             * @throws binding_error if the values do not match the key columns
+             */
+            keyset_pager &seek(const std::vector<sql_value> &key);
+
+            /*!
+             * starts paging again from the first page
+             */
+            void reset();
+        };
+    }
+}
+
+#endif
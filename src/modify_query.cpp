@@ -5,6 +5,7 @@
 #include "exception.h"
 #include "log.h"
 #include "schema.h"
+#include "session.h"
 #include "statement.h"
 
 using namespace std;
@@ -13,6 +14,41 @@ namespace rj
 {
     namespace db
     {
+        namespace helper
+        {
+            /*!
+             * a copy of the sql and values of a query, executed asynchronously
+             */
+            class async_query : public modify_query
+            {
+               private:
+                string sql_;
+
+               public:
+                async_query(const modify_query &other) : modify_query(other), sql_(other.to_string())
+                {
+                    // with its own statement, as the original may be executed again
+                    stmt_ = nullptr;
+                }
+
+                /*!
+                 * sends the query without waiting for its results
+                 * @return the statement to read the results from, or nullptr if it has to be executed synchronously
+                 */
+                shared_ptr<statement> send_query()
+                {
+                    prepare(sql_);
+
+                    return stmt_->send_query() ? stmt_ : nullptr;
+                }
+
+                string to_string() const
+                {
+                    return sql_;
+                }
+            };
+        }
+
         modify_query::modify_query(const std::shared_ptr<rj::db::session> &session) : query(session), flags_(0), numChanges_(0)
         {
         }
@@ -52,6 +88,58 @@ namespace rj
             return numChanges_;
         }
 
+        int modify_query::flags() const
+        {
+            return flags_;
+        }
+
+        modify_query &modify_query::flags(int value)
+        {
+            flags_ = value;
+            return *this;
+        }
+
+        std::future<int> modify_query::execute_async()
+        {
+            if (!is_valid()) {
+                throw database_exception("Invalid modify query");
+            }
+
+            if (flags_ & Buffered) {
+                throw database_exception("buffered values can not be executed asynchronously");
+            }
+
+            // a copy is executed, so this query can change or go away before the future is ready
+            auto copy = make_shared<helper::async_query>(*this);
+
+            // only one query can be sent at a time
+            session_->wait_for_results();
+
+            auto stmt = copy->send_query();
+
+            if (stmt != nullptr) {
+                auto changes = make_shared<promise<int>>();
+
+                // the session keeps the reader, so it holds the statement and not the copy, which holds the session
+                session_->on_results_ready([stmt, changes]() {
+                    try {
+                        if (stmt->result()) {
+                            changes->set_value(stmt->last_number_of_changes());
+                        } else {
+                            log::error("%s", stmt->last_error().c_str());
+                            changes->set_value(0);
+                        }
+                    } catch (...) {
+                        changes->set_exception(current_exception());
+                    }
+                });
+
+                return changes->get_future();
+            }
+
+            return std::async(std::launch::async, [copy]() { return copy->execute(); });
+        }
+
         int modify_query::execute()
         {
             if (!is_valid()) {
@@ -6,6 +6,7 @@
 #ifndef RJ_DB_MODIFY_QUERY_H
 #define RJ_DB_MODIFY_QUERY_H
 
+#include <future>
 #include "query.h"
 
 namespace rj
@@ -20,6 +21,18 @@ namespace rj
         class modify_query : public query
         {
            public:
+            /*!
+             * flags that change how a query executes
+             */
+            typedef enum {
+                /*! executes the same statement repeatedly, resetting it to a pre-bind state after each execute */
+                Batch = (1 << 0),
+                /*! update the existing row instead of failing when an insert conflicts on the primary key */
+                Upsert = (1 << 1),
+                /*! buffer inserted values and send them in as few statements as possible, until flushed */
+                Buffered = (1 << 2)
+            } flag;
+
             /*!
              * @param db the database in use
              */
@@ -48,11 +61,34 @@ namespace rj
              */
             virtual int execute();
 
+            /*!
+             * executes a copy of this query without blocking the caller
+             * backends that can send queries complete the future from session::consume_input or session::wait_for_results,
+             * others execute the copy on a worker thread
+             * the session must not be used for anything else until the future is ready
+             * results such as insert ids stay with the copy, only the number of changes is returned
+             * @return the future number of changes made by this query
+             * @throws database_exception if the query is invalid or has the Buffered flag
+             */
+            std::future<int> execute_async();
+
             /*!
              * @return the last number of changes made by this query
              */
             int last_number_of_changes() const;
 
+            /*!
+             * @return the flags for this query
+             */
+            int flags() const;
+
+            /*!
+             * sets the flags for this query
+             * @param value the flags
+             * @return a reference to this instance
+             */
+            modify_query &flags(int value);
+
            protected:
             int flags_;
             int numChanges_;
@@ -5,12 +5,12 @@
 #ifdef HAVE_LIBMYSQLCLIENT
 
 #include <time.h>
+#include <algorithm>
 #include <cassert>
 #include <codecvt>
 #include <cstdlib>
 #include <locale>
 #include <memory>
-#include <regex>
 
 #include "../alloc.h"
 #include "../exception.h"
@@ -38,6 +38,22 @@ namespace rj
                     return ptr;
                 }
 
+                /**
+                 * gets the buffer size for a string or blob result
+                 * @param field the field
+                 * @return the size in bytes
+                 */
+                static unsigned long result_buffer_length(const MYSQL_FIELD *field)
+                {
+                    // the longest value, known once results are stored with STMT_ATTR_UPDATE_MAX_LENGTH
+                    if (field->max_length > 0) {
+                        return field->max_length;
+                    }
+
+                    // the declared length can be gigabytes, longer values are fetched when they are truncated
+                    return std::min<unsigned long>(field->length, binding::DEFAULT_RESULT_BUFFER_SIZE);
+                }
+
                 /**
                 * function to assign a mysql field to a mysql binding value
                 * @param value the binding value
@@ -82,7 +98,7 @@ namespace rj
                         case MYSQL_TYPE_MEDIUM_BLOB:
                         case MYSQL_TYPE_LONG_BLOB:
                             value->length = c_alloc<unsigned long>();
-                            value->buffer_length = field->length;
+                            value->buffer_length = result_buffer_length(field);
                             break;
                         case MYSQL_TYPE_DATETIME:
                         case MYSQL_TYPE_DATE:
@@ -171,6 +187,63 @@ namespace rj
                 }
 
                 extern std::string last_stmt_error(MYSQL_STMT *stmt);
+
+#ifdef ENHANCED_PARAMETER_MAPPING
+                std::shared_ptr<rewritten_sql> rewrite_parameters(const std::string &sql)
+                {
+                    auto params = rj::db::helper::find_parameters(sql, true);
+
+                    auto value = std::make_shared<rewritten_sql>();
+
+                    size_t count = 0, max_index = 0;
+
+                    // every parameter becomes a ?, so map each binding index to the positions using it
+                    for (size_t i = 0; i < params.size(); i++) {
+                        size_t index;
+
+                        switch (params[i].type) {
+                            case '?':
+                                index = ++count;
+                                break;
+                            case '$':
+                                index = params[i].number;
+                                break;
+                            default:
+                                continue;
+                        }
+
+                        value->positions[index].insert(i + 1);
+                        max_index = std::max(max_index, index);
+                    }
+
+                    // named parameters go after the indexed ones
+                    for (size_t i = 0; i < params.size(); i++) {
+                        if (params[i].type != '@' && params[i].type != ':') {
+                            continue;
+                        }
+
+                        auto &indexes = value->named[sql.substr(params[i].offset, params[i].length)];
+
+                        if (indexes.empty()) {
+                            indexes.insert(++max_index);
+                        }
+
+                        value->positions[*indexes.begin()].insert(i + 1);
+                    }
+
+                    size_t last = 0;
+
+                    for (auto &param : params) {
+                        value->sql.append(sql, last, param.offset - last).append("?");
+
+                        last = param.offset + param.length;
+                    }
+
+                    value->sql.append(sql, last, std::string::npos);
+
+                    return value;
+                }
+#endif
             }
             namespace data_mapper
             {
@@ -222,12 +295,20 @@ namespace rj
                             return helper::parse_time(binding, sql_time::DATETIME);
                         case MYSQL_TYPE_VAR_STRING:
                         case MYSQL_TYPE_VARCHAR:
+                        case MYSQL_TYPE_STRING:
+                            // result buffers are sized to fit, so there may be no terminator
+                            if (binding->length) {
+                                if (binding->buffer == nullptr) {
+                                    return std::string();
+                                }
+                                return std::string(static_cast<const char *>(binding->buffer), std::min(*binding->length, binding->buffer_length));
+                            }
+                            return static_cast<const char *>(binding->buffer);
                         case MYSQL_TYPE_DECIMAL:
                         case MYSQL_TYPE_SET:
                         case MYSQL_TYPE_ENUM:
                         case MYSQL_TYPE_GEOMETRY:
                         case MYSQL_TYPE_NEWDECIMAL:
-                        case MYSQL_TYPE_STRING:
                         default: {
                             return static_cast<const char *>(binding->buffer);
                         }
@@ -244,7 +325,7 @@ namespace rj
                         case MYSQL_TYPE_LONG_BLOB:
                         case MYSQL_TYPE_BLOB: {
                             if (binding->length) {
-                                return sql_blob(binding->buffer, *binding->length);
+                                return sql_blob(binding->buffer, std::min(*binding->length, binding->buffer_length));
                             }
 
                             return sql_blob();
@@ -373,6 +454,9 @@ namespace rj
             }
 
 
+            constexpr const unsigned long binding::DEFAULT_RESULT_BUFFER_SIZE;
+            constexpr const unsigned long binding::MAX_POOLED_RESULT_BUFFER_SIZE;
+
             binding::binding() : value_(nullptr), size_(0)
             {
             }
@@ -494,6 +578,83 @@ namespace rj
                 return &value_[index];
             }
 
+            void binding::prepare_results(MYSQL_FIELD *fields, size_t size)
+            {
+                bool reusable = value_ != nullptr && size_ == size;
+
+                for (size_t i = 0; reusable && i < size; i++) {
+                    reusable = value_[i].buffer_type == fields[i].type && (value_[i].is_unsigned != 0) == ((fields[i].flags & UNSIGNED_FLAG) != 0);
+                }
+
+                if (!reusable) {
+                    clear_value();
+
+                    value_ = c_alloc<MYSQL_BIND>(size);
+                    size_ = size;
+
+                    for (size_t i = 0; i < size; i++) {
+                        helper::prepare_binding_from_field(&value_[i], &fields[i]);
+                    }
+                    return;
+                }
+
+                // only the variable length buffers need to change size
+                for (size_t i = 0; i < size; i++) {
+                    MYSQL_BIND *value = &value_[i];
+
+                    if (value->length == nullptr) {
+                        continue;
+                    }
+
+                    auto needed = helper::result_buffer_length(&fields[i]);
+
+                    if (value->buffer_length >= needed && value->buffer_length <= std::max(needed, MAX_POOLED_RESULT_BUFFER_SIZE)) {
+                        continue;
+                    }
+
+                    free(value->buffer);
+
+                    value->buffer = c_alloc(needed);
+                    value->buffer_length = needed;
+                }
+            }
+
+            bool binding::fetch_truncated(MYSQL_STMT *stmt)
+            {
+                if (stmt == nullptr || value_ == nullptr) {
+                    return false;
+                }
+
+                bool fetched = false;
+
+                for (size_t i = 0; i < size_; i++) {
+                    MYSQL_BIND *value = &value_[i];
+
+                    if (value->length == nullptr || *value->length <= value->buffer_length) {
+                        continue;
+                    }
+
+                    // grow the buffer to the value, it stays that size for the rows after
+                    free(value->buffer);
+
+                    value->buffer_length = *value->length;
+                    value->buffer = c_alloc(value->buffer_length);
+
+                    if (mysql_stmt_fetch_column(stmt, value, i, 0)) {
+                        throw binding_error(helper::last_stmt_error(stmt));
+                    }
+
+                    fetched = true;
+                }
+
+                // the statement keeps a copy of the bindings, so give it the new buffers
+                if (fetched) {
+                    bind_result(stmt);
+                }
+
+                return fetched;
+            }
+
             void binding::bind_result(MYSQL_STMT *stmt) const
             {
                 if (stmt == nullptr || value_ == nullptr || size_ == 0) {
@@ -780,37 +941,21 @@ namespace rj
             std::string binding::prepare(const std::string &sql)
             {
 #ifdef ENHANCED_PARAMETER_MAPPING
-                // now build the list of indexes
-                auto match_begin = std::sregex_iterator(sql.begin(), sql.end(), bindable::index_regex);
-                auto match_end = std::sregex_iterator();
-
-                indexes_.clear();
-
-                unsigned index = 0;
-                for (auto i = match_begin; i != match_end; ++i) {
-                    auto str = i->str();
-                    switch (str[0]) {
-                        // if its a ? parameter...
-                        case '?': {
-                            // then go to the next index
-                            ++index;
-                            break;
-                        }
-                        case '$': {
-                            auto sub = *i;
-                            // if its a $ parameter, mapp the real index
-                            auto pos = std::stol(sub[2].str());
-                            indexes_[pos].insert(++index);
-                            break;
-                        }
-                    }
+                static rewritten_sql_cache cache;
+
+                auto value = cache.get(sql);
+
+                if (value == nullptr) {
+                    value = helper::rewrite_parameters(sql);
+                    cache.put(sql, value);
                 }
 
+                indexes_ = value->positions;
+
                 // setup the named parameters
-                bind_mapping::prepare(sql, index);
+                bind_mapping::prepare(*value);
 
-                // replace all parameters to the mysql ? parameters
-                return regex_replace(sql, bindable::param_regex, std::string("?"));
+                return value->sql;
 #else
                 return sql;
 #endif
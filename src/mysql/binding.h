@@ -48,6 +48,12 @@ namespace rj
                 std::set<size_t> &get_indexes(size_t index);
 
                public:
+                /*! the buffer size of a string or blob result when its longest value is not known */
+                constexpr static const unsigned long DEFAULT_RESULT_BUFFER_SIZE = 1024;
+
+                /*! result buffers grown past this size are shrunk again for the next results */
+                constexpr static const unsigned long MAX_POOLED_RESULT_BUFFER_SIZE = 1024 * 1024;
+
                 /*!
                  * default constructor
                  */
@@ -131,6 +137,21 @@ namespace rj
                  */
                 void bind_result(MYSQL_STMT *stmt) const;
 
+                /*!
+                 * prepares the bindings to receive results, reusing the buffers from previous results of the same columns
+                 * string and blob buffers are sized to the longest value when the results were stored, or a small default
+                 * @param fields the fields of the results
+                 * @param size the number of fields
+                 */
+                void prepare_results(MYSQL_FIELD *fields, size_t size);
+
+                /*!
+                 * fetches the values of a row that did not fit their buffers, growing them
+                 * @param stmt the statement that returned MYSQL_DATA_TRUNCATED
+                 * @return true if any values were fetched again
+                 */
+                bool fetch_truncated(MYSQL_STMT *stmt);
+
                 /*!
                  * validates the sql and prepares the bindinds
                  * @param sql the sql to prepare
@@ -0,0 +1,213 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBMYSQLCLIENT
+
+#include "blob_stream.h"
+#include <cstring>
+#include "../exception.h"
+#include "../log.h"
+#include "../schema.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        namespace mysql
+        {
+            namespace helper
+            {
+                extern string last_stmt_error(MYSQL_STMT *stmt);
+
+                struct close_blob_stmt {
+                    void operator()(MYSQL_STMT *p) const
+                    {
+                        if (p != nullptr) {
+                            mysql_stmt_free_result(p);
+                            mysql_stmt_close(p);
+                        }
+                    }
+                };
+
+                /*!
+                 * prepares a statement outside of the session cache, as it stays busy while the blob is open
+                 */
+                static shared_ptr<MYSQL_STMT> prepare_blob_stmt(const shared_ptr<MYSQL> &db, binding &params, const string &sql)
+                {
+                    if (db == nullptr) {
+                        throw database_exception("database is not open");
+                    }
+
+                    MYSQL_STMT *temp = mysql_stmt_init(db.get());
+
+                    if (temp == nullptr) {
+                        throw database_exception("out of memory");
+                    }
+
+                    shared_ptr<MYSQL_STMT> stmt(temp, close_blob_stmt());
+
+                    auto formatted = params.prepare(sql);
+
+                    if (mysql_stmt_prepare(stmt.get(), formatted.c_str(), formatted.length())) {
+                        throw database_exception(last_stmt_error(stmt.get()));
+                    }
+
+                    return stmt;
+                }
+            }
+
+            blob_reader::blob_reader(const shared_ptr<MYSQL> &db, const shared_ptr<schema> &schema, const string &column, const sql_value &id)
+                : db_(db), length_(0), isNull_(0)
+            {
+                stmt_ = helper::prepare_blob_stmt(db_, params_,
+                                                  "SELECT " + column + " FROM " + schema->table_name() + " WHERE " + schema->primary_key() + " = ?");
+
+                params_.bind_value(1, id);
+
+                params_.bind_params(stmt_.get());
+
+                if (mysql_stmt_execute(stmt_.get())) {
+                    throw database_exception(helper::last_stmt_error(stmt_.get()));
+                }
+
+                // no buffer, so the fetch only reports the length
+                MYSQL_BIND result;
+                memset(&result, 0, sizeof(result));
+                result.buffer_type = MYSQL_TYPE_BLOB;
+                result.length = &length_;
+                result.is_null = &isNull_;
+
+                if (mysql_stmt_bind_result(stmt_.get(), &result)) {
+                    throw database_exception(helper::last_stmt_error(stmt_.get()));
+                }
+
+                int res = mysql_stmt_fetch(stmt_.get());
+
+                if (res == MYSQL_NO_DATA) {
+                    throw database_exception("no row in " + schema->table_name() + " for " + id.to_string());
+                }
+
+                if (res == 1) {
+                    throw database_exception(helper::last_stmt_error(stmt_.get()));
+                }
+
+                if (isNull_) {
+                    length_ = 0;
+                }
+            }
+
+            blob_reader::~blob_reader()
+            {
+            }
+
+            size_t blob_reader::size() const
+            {
+                return length_;
+            }
+
+            void blob_reader::read_at(void *buffer, size_t length, size_t offset)
+            {
+                unsigned long fetched = 0;
+                my_bool isNull = 0;
+
+                MYSQL_BIND chunk;
+                memset(&chunk, 0, sizeof(chunk));
+                chunk.buffer_type = MYSQL_TYPE_BLOB;
+                chunk.buffer = buffer;
+                chunk.buffer_length = length;
+                chunk.length = &fetched;
+                chunk.is_null = &isNull;
+
+                if (mysql_stmt_fetch_column(stmt_.get(), &chunk, 0, offset)) {
+                    throw database_exception(helper::last_stmt_error(stmt_.get()));
+                }
+            }
+
+            blob_writer::blob_writer(const shared_ptr<MYSQL> &db, const shared_ptr<schema> &schema, const string &column, const sql_value &id)
+                : db_(db)
+            {
+                // the update reports no changes for an unchanged value, so the row is checked up front
+                {
+                    binding params;
+
+                    auto exists =
+                        helper::prepare_blob_stmt(db_, params, "SELECT 1 FROM " + schema->table_name() + " WHERE " + schema->primary_key() + " = ?");
+
+                    params.bind_value(1, id);
+
+                    params.bind_params(exists.get());
+
+                    int found = 0;
+
+                    MYSQL_BIND result;
+                    memset(&result, 0, sizeof(result));
+                    result.buffer_type = MYSQL_TYPE_LONG;
+                    result.buffer = &found;
+
+                    if (mysql_stmt_execute(exists.get()) || mysql_stmt_bind_result(exists.get(), &result)) {
+                        throw database_exception(helper::last_stmt_error(exists.get()));
+                    }
+
+                    int res = mysql_stmt_fetch(exists.get());
+
+                    if (res == MYSQL_NO_DATA) {
+                        throw database_exception("no row in " + schema->table_name() + " for " + id.to_string());
+                    }
+
+                    if (res == 1) {
+                        throw database_exception(helper::last_stmt_error(exists.get()));
+                    }
+                }
+
+                stmt_ = helper::prepare_blob_stmt(db_, params_,
+                                                  "UPDATE " + schema->table_name() + " SET " + column + " = ? WHERE " + schema->primary_key() + " = ?");
+
+                // the value is sent in pieces before executing
+                params_.bind(1, sql_blob());
+
+                params_.bind_value(2, id);
+
+                params_.bind_params(stmt_.get());
+            }
+
+            blob_writer::~blob_writer()
+            {
+                // the sent data is only held by the statement, so nothing was written
+                if (stmt_ != nullptr) {
+                    log::warn("blob writer was not closed, discarding the value");
+                }
+            }
+
+            void blob_writer::write_next(const void *buffer, size_t length)
+            {
+                if (stmt_ == nullptr) {
+                    throw database_exception("blob writer is closed");
+                }
+
+                if (mysql_stmt_send_long_data(stmt_.get(), 0, static_cast<const char *>(buffer), length)) {
+                    throw database_exception(helper::last_stmt_error(stmt_.get()));
+                }
+            }
+
+            void blob_writer::close()
+            {
+                if (stmt_ == nullptr) {
+                    return;
+                }
+
+                auto stmt = stmt_;
+
+                stmt_ = nullptr;
+
+                if (mysql_stmt_execute(stmt.get())) {
+                    throw database_exception(helper::last_stmt_error(stmt.get()));
+                }
+            }
+        }
+    }
+}
+
+#endif
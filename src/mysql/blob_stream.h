@@ -0,0 +1,104 @@
+/*!
+ * @file blob_stream.h
+ * chunked blob io for mysql prepared statements
+ */
+#ifndef RJ_DB_MYSQL_BLOB_STREAM_H
+#define RJ_DB_MYSQL_BLOB_STREAM_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBMYSQLCLIENT
+
+#include <mysql/mysql.h>
+#include <memory>
+#include <string>
+#include "../blob_stream.h"
+#include "binding.h"
+
+namespace rj
+{
+    namespace db
+    {
+        class schema;
+
+        namespace mysql
+        {
+            /*!
+             * reads a blob column with mysql_stmt_fetch_column, one chunk at a time from the fetched row
+             * the row is read without binding a buffer for the whole value
+             * the connection can not be used for anything else until the reader is destroyed
+             */
+            class blob_reader : public rj::db::blob_reader
+            {
+               private:
+                std::shared_ptr<MYSQL> db_;
+                std::shared_ptr<MYSQL_STMT> stmt_;
+                binding params_;
+                unsigned long length_;
+                my_bool isNull_;
+
+               protected:
+                void read_at(void *buffer, size_t length, size_t offset);
+
+               public:
+                /*!
+                 * @param db the connection to query
+                 * @param schema the schema of the table
+                 * @param column the blob column
+                 * @param id the primary key value of the row
+                 * @throws database_exception if the row was not found
+                 */
+                blob_reader(const std::shared_ptr<MYSQL> &db, const std::shared_ptr<schema> &schema, const std::string &column,
+                            const sql_value &id);
+
+                virtual ~blob_reader();
+
+                size_t size() const;
+            };
+
+            /*!
+             * writes a blob column with mysql_stmt_send_long_data, executing the update when closed
+             * the whole value must still fit in the max_allowed_packet of the server
+             * the column only changes when the writer is closed
+             */
+            class blob_writer : public rj::db::blob_writer
+            {
+               private:
+                std::shared_ptr<MYSQL> db_;
+                std::shared_ptr<MYSQL_STMT> stmt_;
+                binding params_;
+
+               protected:
+                void write_next(const void *buffer, size_t length);
+
+               public:
+                /*!
+                 * @param db the connection to query
+                 * @param schema the schema of the table
+                 * @param column the blob column
+                 * @param id the primary key value of the row
+                 * @throws database_exception if the row was not found
+                 */
+                blob_writer(const std::shared_ptr<MYSQL> &db, const std::shared_ptr<schema> &schema, const std::string &column,
+                            const sql_value &id);
+
+                /*!
+                 * discards the value if the writer was not closed
+                 */
+                virtual ~blob_writer();
+
+                /*!
+                 * executes the update
+                 * @throws database_exception if the update failed
+                 */
+                void close();
+            };
+        }
+    }
+}
+
+#endif
+
+#endif
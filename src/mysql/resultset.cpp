@@ -32,15 +32,21 @@ namespace rj
             }
 
 
-            resultset::resultset(const std::shared_ptr<mysql::session> &sess, const shared_ptr<MYSQL_RES> &res)
-                : res_(res), row_(nullptr), sess_(sess)
+            resultset::resultset(const std::shared_ptr<mysql::session> &sess, const shared_ptr<MYSQL_RES> &res, bool buffered)
+                : res_(res), row_(nullptr), sess_(sess), buffered_(buffered), replay_(false), numRows_(0)
             {
                 if (sess_ == nullptr) {
                     throw database_exception("database not provided to mysql resultset");
                 }
             }
 
-            resultset::resultset(resultset &&other) : res_(std::move(other.res_)), row_(other.row_), sess_(std::move(other.sess_))
+            resultset::resultset(resultset &&other)
+                : res_(std::move(other.res_)),
+                  row_(other.row_),
+                  sess_(std::move(other.sess_)),
+                  buffered_(other.buffered_),
+                  replay_(other.replay_),
+                  numRows_(other.numRows_)
             {
                 other.sess_ = nullptr;
                 other.res_ = nullptr;
@@ -56,6 +62,9 @@ namespace rj
                 res_ = std::move(other.res_);
                 sess_ = std::move(other.sess_);
                 row_ = other.row_;
+                buffered_ = other.buffered_;
+                replay_ = other.replay_;
+                numRows_ = other.numRows_;
                 other.sess_ = nullptr;
                 other.res_ = nullptr;
                 other.row_ = nullptr;
@@ -79,26 +88,119 @@ namespace rj
                     return false;
                 }
 
+                if (replay_) {
+                    replay_ = false;
+                    numRows_++;
+                    return true;
+                }
+
                 row_ = mysql_fetch_row(res_.get());
 
-                return row_ != nullptr;
+                if (row_ == nullptr) {
+                    return false;
+                }
+
+                numRows_++;
+
+                return true;
             }
 
             void resultset::reset()
             {
-                if (res_ != nullptr) {
+                if (res_ == nullptr) {
+                    return;
+                }
+
+                if (buffered_) {
                     mysql_data_seek(res_.get(), 0);
+                    return;
+                }
+
+                // unbuffered rows can not be seeked, but the first row is kept so checking for results does not lose it
+                if (numRows_ == 0) {
+                    return;
+                }
+
+                if (numRows_ > 1 || row_ == nullptr) {
+                    throw database_exception("streamed mysql results can only be read once");
+                }
+
+                replay_ = true;
+                numRows_ = 0;
+            }
+
+            long long resultset::row_count()
+            {
+                if (res_ == nullptr) {
+                    return 0;
+                }
+
+                // unbuffered results are only counted as they are fetched
+                if (!buffered_) {
+                    return -1;
+                }
+
+                return mysql_num_rows(res_.get());
+            }
+
+            size_t resultset::column_count() const
+            {
+                if (res_ == nullptr) {
+                    return 0;
+                }
+
+                return mysql_num_fields(res_.get());
+            }
+
+            string resultset::column_name(size_t position) const
+            {
+                if (position >= column_count()) {
+                    throw no_such_column_exception();
+                }
+
+                auto field = mysql_fetch_field_direct(res_.get(), position);
+
+                if (field == nullptr || field->name == nullptr) {
+                    return string();
+                }
+
+                return field->name;
+            }
+
+            sql_value resultset::column_value(size_t position) const
+            {
+                if (position >= column_count() || row_ == nullptr) {
+                    throw no_such_column_exception();
                 }
+
+                auto field = mysql_fetch_field_direct(res_.get(), position);
+
+                if (field == nullptr) {
+                    throw no_such_column_exception();
+                }
+
+                auto lengths = mysql_fetch_lengths(res_.get());
+
+                return data_mapper::to_value(field->type, row_[position], !lengths ? 0 : lengths[position]);
             }
 
             resultset::row_type resultset::current_row()
             {
-                return row_type(make_shared<mysql::row>(sess_, res_, row_));
+                return row_type(make_shared<mysql::row>(sess_, res_, row_, names()));
             }
             /* Statement version */
 
-            stmt_resultset::stmt_resultset(const std::shared_ptr<mysql::session> &sess, const shared_ptr<MYSQL_STMT> &stmt)
-                : stmt_(stmt), metadata_(nullptr), sess_(sess), bindings_(nullptr), status_(-1)
+            stmt_resultset::stmt_resultset(const std::shared_ptr<mysql::session> &sess, const shared_ptr<MYSQL_STMT> &stmt, bool buffered,
+                                           const shared_ptr<mysql::binding> &bindings)
+                : stmt_(stmt),
+                  metadata_(nullptr),
+                  sess_(sess),
+                  bindings_(bindings),
+                  status_(INVALID),
+                  buffered_(buffered),
+                  replay_(false),
+                  done_(false),
+                  numRows_(0)
             {
                 if (stmt_ == nullptr) {
                     throw database_exception("invalid statement provided to mysql statement resultset");
@@ -106,6 +208,13 @@ namespace rj
                 if (sess_ == nullptr) {
                     throw database_exception("invalid database provided to mysql statement resultset");
                 }
+
+                // the columns are known once prepared, so names can be resolved before executing
+                MYSQL_RES *temp = mysql_stmt_result_metadata(stmt_.get());
+
+                if (temp != nullptr) {
+                    metadata_ = shared_ptr<MYSQL_RES>(temp, helper::res_delete());
+                }
             }
 
             stmt_resultset::stmt_resultset(stmt_resultset &&other)
@@ -113,7 +222,11 @@ namespace rj
                   metadata_(std::move(other.metadata_)),
                   sess_(std::move(other.sess_)),
                   bindings_(std::move(other.bindings_)),
-                  status_(other.status_)
+                  status_(other.status_),
+                  buffered_(other.buffered_),
+                  replay_(other.replay_),
+                  done_(other.done_),
+                  numRows_(other.numRows_)
             {
                 other.sess_ = nullptr;
                 other.stmt_ = nullptr;
@@ -123,6 +236,10 @@ namespace rj
 
             stmt_resultset::~stmt_resultset()
             {
+                // stored rows are freed with the results, and unread rows would leave the connection out of sync
+                if (stmt_ != nullptr && status_ != INVALID && (buffered_ || !done_)) {
+                    mysql_stmt_free_result(stmt_.get());
+                }
             }
 
             stmt_resultset &stmt_resultset::operator=(stmt_resultset &&other)
@@ -132,6 +249,10 @@ namespace rj
                 metadata_ = std::move(other.metadata_);
                 bindings_ = std::move(other.bindings_);
                 status_ = other.status_;
+                buffered_ = other.buffered_;
+                replay_ = other.replay_;
+                done_ = other.done_;
+                numRows_ = other.numRows_;
                 other.sess_ = nullptr;
                 other.bindings_ = nullptr;
                 other.metadata_ = nullptr;
@@ -145,24 +266,44 @@ namespace rj
                     return;
                 }
 
+                if (buffered_) {
+                    // storing the rows measures the longest value of each column, to size the buffers
+                    my_bool updateMaxLength = 1;
+
+                    mysql_stmt_attr_set(stmt_.get(), STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+                }
+
                 if ((status_ = mysql_stmt_execute(stmt_.get()))) {
                     throw database_exception(helper::last_stmt_error(stmt_.get()));
                 }
 
                 // get information about the results
-                MYSQL_RES *temp = mysql_stmt_result_metadata(stmt_.get());
-
-                if (temp == nullptr) {
+                if (metadata_ == nullptr) {
                     throw database_exception("No result data found.");
                 }
 
-                metadata_ = shared_ptr<MYSQL_RES>(temp, helper::res_delete());
+                // without storing, rows are fetched from the server one at a time
+                if (buffered_) {
+                    if (mysql_stmt_store_result(stmt_.get())) {
+                        throw database_exception(helper::last_stmt_error(stmt_.get()));
+                    }
+
+                    MYSQL_RES *temp = mysql_stmt_result_metadata(stmt_.get());
+
+                    if (temp != nullptr) {
+                        metadata_ = shared_ptr<MYSQL_RES>(temp, helper::res_delete());
+                    }
+                }
+
+                int size = mysql_num_fields(metadata_.get());
 
-                int size = mysql_num_fields(temp);
+                auto fields = mysql_fetch_fields(metadata_.get());
 
-                auto fields = mysql_fetch_fields(temp);
+                if (bindings_ == nullptr) {
+                    bindings_ = make_shared<mysql::binding>();
+                }
 
-                bindings_ = make_shared<mysql::binding>(fields, size);
+                bindings_->prepare_results(fields, size);
 
                 bindings_->bind_result(stmt_.get());
             }
@@ -187,38 +328,121 @@ namespace rj
                     }
                 }
 
+                if (replay_) {
+                    replay_ = false;
+                    numRows_++;
+                    return true;
+                }
+
+                if (done_) {
+                    return false;
+                }
+
                 int res = mysql_stmt_fetch(stmt_.get());
 
-                if (res == 1 || res == MYSQL_DATA_TRUNCATED) {
+                if (res == 1) {
                     throw database_exception(helper::last_stmt_error(stmt_.get()));
                 }
 
+                // only values longer than their buffers are fetched again
+                if (res == MYSQL_DATA_TRUNCATED && !bindings_->fetch_truncated(stmt_.get())) {
+                    throw database_exception("mysql result value was truncated");
+                }
+
                 if (res == MYSQL_NO_DATA) {
+                    done_ = true;
                     return false;
                 }
 
+                numRows_++;
+
                 return true;
             }
 
             void stmt_resultset::reset()
             {
-                bindings_.reset();
-
                 if (!is_valid()) {
                     log::warn("mysql stmt resultset reset invalid");
                     return;
                 }
 
-                status_ = INVALID;
+                if (status_ == INVALID) {
+                    return;
+                }
 
-                if (mysql_stmt_reset(stmt_.get())) {
-                    throw database_exception(helper::last_stmt_error(stmt_.get()));
+                if (buffered_) {
+                    // stored rows are seeked, instead of executing the statement again
+                    mysql_stmt_data_seek(stmt_.get(), 0);
+                    done_ = false;
+                    numRows_ = 0;
+                    return;
+                }
+
+                // the bound buffers still hold the first row, so checking for results does not lose it
+                if (numRows_ == 0) {
+                    return;
                 }
+
+                if (numRows_ > 1 || done_) {
+                    throw database_exception("streamed mysql results can only be read once");
+                }
+
+                replay_ = true;
+                numRows_ = 0;
+            }
+
+            long long stmt_resultset::row_count()
+            {
+                if (!is_valid() || !buffered_) {
+                    return -1;
+                }
+
+                // executing is what reading the first row would do anyway
+                prepare_results();
+
+                if (status_ == INVALID) {
+                    return -1;
+                }
+
+                return mysql_stmt_num_rows(stmt_.get());
+            }
+
+            size_t stmt_resultset::column_count() const
+            {
+                if (metadata_ == nullptr) {
+                    return 0;
+                }
+
+                return mysql_num_fields(metadata_.get());
+            }
+
+            string stmt_resultset::column_name(size_t position) const
+            {
+                if (position >= column_count()) {
+                    throw no_such_column_exception();
+                }
+
+                auto field = mysql_fetch_field_direct(metadata_.get(), position);
+
+                if (field == nullptr || field->name == nullptr) {
+                    return string();
+                }
+
+                return field->name;
+            }
+
+            sql_value stmt_resultset::column_value(size_t position) const
+            {
+                if (position >= column_count() || bindings_ == nullptr) {
+                    throw no_such_column_exception();
+                }
+
+                return bindings_->to_value(position);
             }
 
             resultset::row_type stmt_resultset::current_row()
             {
-                return row_type(make_shared<stmt_row>(sess_, stmt_, metadata_, bindings_));
+                return row_type(make_shared<stmt_row>(sess_, stmt_, metadata_, bindings_, names()));
             }
         }
     }
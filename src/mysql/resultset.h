@@ -36,13 +36,17 @@ namespace rj
                 std::shared_ptr<MYSQL_RES> res_;
                 MYSQL_ROW row_;
                 std::shared_ptr<mysql::session> sess_;
+                bool buffered_;
+                bool replay_;
+                long long numRows_;
 
                public:
                 /*!
                  * @param db the database in use
                  * @param res the query results
+                 * @param buffered false if the results are read from the server as they are fetched (mysql_use_result)
                  */
-                resultset(const std::shared_ptr<mysql::session> &sess, const std::shared_ptr<MYSQL_RES> &res);
+                resultset(const std::shared_ptr<mysql::session> &sess, const std::shared_ptr<MYSQL_RES> &res, bool buffered = true);
 
                 /* non-copyable boilerplate */
                 resultset(const resultset &other) = delete;
@@ -56,6 +60,10 @@ namespace rj
                 resultset::row_type current_row();
                 void reset();
                 bool next();
+                long long row_count();
+                size_t column_count() const;
+                std::string column_name(size_t position) const;
+                sql_value column_value(size_t position) const;
             };
 
             /*!
@@ -72,6 +80,10 @@ namespace rj
                 std::shared_ptr<mysql::session> sess_;
                 std::shared_ptr<mysql::binding> bindings_;
                 int status_;
+                bool buffered_;
+                bool replay_;
+                bool done_;
+                long long numRows_;
                 void prepare_results();
 
                 constexpr static const int INVALID = -1;
@@ -80,8 +92,12 @@ namespace rj
                 /*!
                  * @param db the database in use
                  * @param stmt the statement being executed
+                 * @param buffered false to fetch rows from the server as they are read, instead of storing them all
+                 * @param bindings the result buffers to fetch into, or nullptr to allocate them
+                 *                 they must not be shared with another live result set of the statement
                  */
-                stmt_resultset(const std::shared_ptr<mysql::session> &sess, const std::shared_ptr<MYSQL_STMT> &stmt);
+                stmt_resultset(const std::shared_ptr<mysql::session> &sess, const std::shared_ptr<MYSQL_STMT> &stmt, bool buffered = true,
+                               const std::shared_ptr<mysql::binding> &bindings = nullptr);
 
                 /* non-copyable boilerplate */
                 stmt_resultset(const stmt_resultset &other) = delete;
@@ -97,6 +113,10 @@ namespace rj
                 stmt_resultset::row_type current_row();
                 void reset();
                 bool next();
+                long long row_count();
+                size_t column_count() const;
+                std::string column_name(size_t position) const;
+                sql_value column_value(size_t position) const;
             };
 
             namespace helper
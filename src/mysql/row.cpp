@@ -17,8 +17,8 @@ namespace rj
     {
         namespace mysql
         {
-            row::row(const std::shared_ptr<mysql::session> &sess, const shared_ptr<MYSQL_RES> &res, MYSQL_ROW row)
-                : row_impl(), row_(row), res_(res), sess_(sess)
+            row::row(const std::shared_ptr<mysql::session> &sess, const shared_ptr<MYSQL_RES> &res, MYSQL_ROW row, const shared_ptr<column_names> &names)
+                : row_impl(), row_(row), res_(res), sess_(sess), names_(names)
             {
                 if (sess_ == nullptr) {
                     throw database_exception("no database provided for mysql row");
@@ -36,7 +36,12 @@ namespace rj
             }
 
             row::row(row &&other)
-                : row_impl(std::move(other)), row_(other.row_), res_(std::move(other.res_)), sess_(std::move(other.sess_)), size_(other.size_)
+                : row_impl(std::move(other)),
+                  row_(other.row_),
+                  res_(std::move(other.res_)),
+                  sess_(std::move(other.sess_)),
+                  size_(other.size_),
+                  names_(std::move(other.names_))
             {
                 other.row_ = nullptr;
                 other.sess_ = nullptr;
@@ -53,6 +58,7 @@ namespace rj
                 res_ = std::move(other.res_);
                 sess_ = std::move(other.sess_);
                 size_ = other.size_;
+                names_ = std::move(other.names_);
                 other.row_ = nullptr;
                 other.sess_ = nullptr;
                 other.res_ = nullptr;
@@ -83,6 +89,16 @@ namespace rj
                     throw no_such_column_exception();
                 }
 
+                if (names_ != nullptr) {
+                    int index = names_->index_of(name);
+
+                    if (index < 0) {
+                        throw no_such_column_exception(name);
+                    }
+
+                    return column(index);
+                }
+
                 for (size_t i = 0; i < size_; i++) {
                     auto field = mysql_fetch_field_direct(res_.get(), i);
 
@@ -125,8 +141,8 @@ namespace rj
 
 
             stmt_row::stmt_row(const std::shared_ptr<mysql::session> &sess, const shared_ptr<MYSQL_STMT> &stmt, const shared_ptr<MYSQL_RES> &metadata,
-                               const shared_ptr<mysql::binding> &fields)
-                : row_impl(), fields_(fields), metadata_(metadata), stmt_(stmt), sess_(sess), size_(0)
+                               const shared_ptr<mysql::binding> &fields, const shared_ptr<column_names> &names)
+                : row_impl(), fields_(fields), metadata_(metadata), stmt_(stmt), sess_(sess), size_(0), names_(names)
             {
                 if (sess_ == nullptr) {
                     throw database_exception("No database provided for mysql row");
@@ -143,7 +159,8 @@ namespace rj
                   metadata_(std::move(other.metadata_)),
                   stmt_(std::move(other.stmt_)),
                   sess_(std::move(other.sess_)),
-                  size_(other.size_)
+                  size_(other.size_),
+                  names_(std::move(other.names_))
             {
                 other.sess_ = nullptr;
                 other.fields_ = nullptr;
@@ -162,6 +179,7 @@ namespace rj
                 sess_ = std::move(other.sess_);
                 size_ = other.size_;
                 stmt_ = std::move(other.stmt_);
+                names_ = std::move(other.names_);
                 other.sess_ = nullptr;
                 other.fields_ = nullptr;
                 other.metadata_ = nullptr;
@@ -193,6 +211,16 @@ namespace rj
                     throw no_such_column_exception();
                 }
 
+                if (names_ != nullptr) {
+                    int index = names_->index_of(name);
+
+                    if (index < 0) {
+                        throw no_such_column_exception(name);
+                    }
+
+                    return column(index);
+                }
+
                 for (size_t i = 0; i < size(); i++) {
                     auto field = mysql_fetch_field_direct(metadata_.get(), i);
 
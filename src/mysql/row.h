@@ -35,14 +35,17 @@ namespace rj
                 std::shared_ptr<MYSQL_RES> res_;
                 std::shared_ptr<mysql::session> sess_;
                 size_t size_;
+                std::shared_ptr<rj::db::column_names> names_;
 
                public:
                 /*!
                  * @param db the database in use
                  * @param res the query result
                  * @param row the row values
+                 * @param names the column name lookups shared by the results, or nullptr to scan the names
                  */
-                row(const std::shared_ptr<mysql::session> &db, const std::shared_ptr<MYSQL_RES> &res, MYSQL_ROW row);
+                row(const std::shared_ptr<mysql::session> &db, const std::shared_ptr<MYSQL_RES> &res, MYSQL_ROW row,
+                    const std::shared_ptr<rj::db::column_names> &names = nullptr);
 
                 /* non-copyable boilerplate */
                 virtual ~row();
@@ -70,6 +73,7 @@ namespace rj
                 std::shared_ptr<MYSQL_STMT> stmt_;
                 std::shared_ptr<mysql::session> sess_;
                 size_t size_;
+                std::shared_ptr<rj::db::column_names> names_;
 
                public:
                 /*!
@@ -77,9 +81,11 @@ namespace rj
                  * @param stmt the query statement
                  * @param metadata the query meta data
                  * @param fields the bindings for the statement
+                 * @param names the column name lookups shared by the results, or nullptr to scan the names
                  */
                 stmt_row(const std::shared_ptr<mysql::session> &sess, const std::shared_ptr<MYSQL_STMT> &stmt,
-                         const std::shared_ptr<MYSQL_RES> &metadata, const std::shared_ptr<mysql::binding> &fields);
+                         const std::shared_ptr<MYSQL_RES> &metadata, const std::shared_ptr<mysql::binding> &fields,
+                         const std::shared_ptr<rj::db::column_names> &names = nullptr);
 
                 /* non-copyable boilerplate */
                 virtual ~stmt_row();
@@ -7,6 +7,7 @@
 #include <sstream>
 #include "../schema.h"
 #include "../select_query.h"
+#include "blob_stream.h"
 #include "resultset.h"
 #include "session.h"
 #include "statement.h"
@@ -31,6 +32,15 @@ namespace rj
                     }
                 };
 
+                void stmt_reset::operator()(MYSQL_STMT *p) const
+                {
+                    if (p != nullptr) {
+                        // pending rows would leave the connection out of sync
+                        mysql_stmt_free_result(p);
+                        mysql_stmt_reset(p);
+                    }
+                }
+
                 string last_stmt_error(MYSQL_STMT *stmt)
                 {
                     if (!stmt) {
@@ -55,9 +65,11 @@ namespace rj
             {
             }
 
-            session::session(session &&other) : session_impl(std::move(other)), db_(std::move(other.db_))
+            session::session(session &&other)
+                : session_impl(std::move(other)), db_(std::move(other.db_)), statements_(std::move(other.statements_))
             {
                 other.db_ = nullptr;
+                other.statements_.clear();
             }
 
             session &session::operator=(session &&other)
@@ -65,7 +77,9 @@ namespace rj
                 session_impl::operator=(std::move(other));
 
                 db_ = std::move(other.db_);
+                statements_ = std::move(other.statements_);
                 other.db_ = nullptr;
+                other.statements_.clear();
 
                 return *this;
             }
@@ -118,6 +132,8 @@ namespace rj
 
             void session::close()
             {
+                statements_.clear();
+
                 if (db_ != nullptr) {
                     db_ = nullptr;
                 }
@@ -155,6 +171,16 @@ namespace rj
                 return mysql_affected_rows(db_.get());
             }
 
+            bool session::in_transaction() const
+            {
+                if (db_ == nullptr) {
+                    return false;
+                }
+
+                // the server reports the status with every reply
+                return (db_->server_status & SERVER_STATUS_IN_TRANS) != 0;
+            }
+
             std::shared_ptr<resultset_impl> session::query(const string &sql)
             {
                 MYSQL_RES *res = nullptr;
@@ -176,6 +202,27 @@ namespace rj
                 return make_shared<resultset>(shared_from_this(), shared_ptr<MYSQL_RES>(res, helper::res_delete()));
             }
 
+            std::shared_ptr<resultset_impl> session::stream(const string &sql)
+            {
+                MYSQL_RES *res = nullptr;
+
+                if (db_ == nullptr) {
+                    throw database_exception("database is not open");
+                }
+
+                if (mysql_real_query(db_.get(), sql.c_str(), sql.length())) {
+                    throw database_exception(last_error());
+                }
+
+                res = mysql_use_result(db_.get());
+
+                if (res == nullptr && mysql_field_count(db_.get()) != 0) {
+                    throw database_exception(last_error());
+                }
+
+                return make_shared<resultset>(shared_from_this(), shared_ptr<MYSQL_RES>(res, helper::res_delete()), false);
+            }
+
             bool session::execute(const string &sql)
             {
                 if (db_ == nullptr) {
@@ -194,6 +241,83 @@ namespace rj
             {
                 return make_shared<mysql::transaction>(db_);
             }
+
+            string session::upsert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns, size_t rows) const
+            {
+                ostringstream buf;
+
+                auto keys = schema->primary_keys();
+
+                buf << "INSERT INTO " << schema->table_name();
+
+                buf << "(";
+
+                buf << rj::db::helper::join_csv(columns);
+
+                buf << ") VALUES";
+
+                buf << rj::db::helper::join_values(columns, rows);
+
+                if (!keys.empty()) {
+                    auto assignments = rj::db::helper::join_assignments(columns, keys, "VALUES(", ")");
+
+                    // a no-op assignment when only the keys are inserted
+                    if (assignments.empty()) {
+                        assignments = keys[0] + " = " + keys[0];
+                    }
+
+                    buf << " ON DUPLICATE KEY UPDATE " << assignments;
+                }
+
+                buf << ";";
+
+                return buf.str();
+            }
+
+            size_t session::max_parameters() const
+            {
+                // the protocol uses a 16 bit placeholder count
+                return 65535;
+            }
+
+            void session::set_statement_cache_size(size_t value)
+            {
+                statements_.capacity(value);
+            }
+
+            size_t session::statement_cache_size() const
+            {
+                return statements_.capacity();
+            }
+
+            unsigned long long session::statement_cache_hits() const
+            {
+                return statements_.hits();
+            }
+
+            unsigned long long session::statement_cache_misses() const
+            {
+                return statements_.misses();
+            }
+
+            void session::clear_statement_cache()
+            {
+                statements_.clear();
+            }
+
+            std::shared_ptr<rj::db::blob_reader> session::open_blob_reader(const std::shared_ptr<schema> &schema, const string &column,
+                                                                           const sql_value &id)
+            {
+                return make_shared<mysql::blob_reader>(db_, schema, column, id);
+            }
+
+            std::shared_ptr<rj::db::blob_writer> session::open_blob_writer(const std::shared_ptr<schema> &schema, const string &column,
+                                                                           const sql_value &id, size_t size)
+            {
+                // the value is sized by the data sent
+                return make_shared<mysql::blob_writer>(db_, schema, column, id);
+            }
+
             void session::query_schema(const string &dbName, const string &tableName, std::vector<column_definition> &columns)
             {
                 if (!is_open()) return;
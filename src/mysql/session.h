@@ -14,6 +14,7 @@
 #include <mysql/mysql.h>
 #include "../session.h"
 #include "../session_factory.h"
+#include "../statement_cache.h"
 
 namespace rj
 {
@@ -29,6 +30,16 @@ namespace rj
                 std::shared_ptr<rj::db::session_impl> create(const uri &uri);
             };
 
+            namespace helper
+            {
+                /*!
+                 * helper to reset a cached statement when it is returned
+                 */
+                struct stmt_reset {
+                    void operator()(MYSQL_STMT *p) const;
+                };
+            }
+
             /*!
              * a mysql specific implementation of a database
              */
@@ -41,6 +52,7 @@ namespace rj
 
                protected:
                 std::shared_ptr<MYSQL> db_;
+                statement_cache<MYSQL_STMT, helper::stmt_reset> statements_;
 
                public:
                 /*!
@@ -67,7 +79,30 @@ namespace rj
                 bool execute(const std::string &sql);
                 std::shared_ptr<statement_type> create_statement();
                 std::shared_ptr<transaction_impl> create_transaction() const;
+                /*!
+                 * uses ON DUPLICATE KEY UPDATE, which mysql applies on a conflict with any unique key, not only the primary key
+                 */
+                std::string upsert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns, size_t rows = 1) const;
+                size_t max_parameters() const;
+                bool in_transaction() const;
+                void set_statement_cache_size(size_t value);
+                size_t statement_cache_size() const;
+                unsigned long long statement_cache_hits() const;
+                unsigned long long statement_cache_misses() const;
+                void clear_statement_cache();
+                std::shared_ptr<rj::db::blob_reader> open_blob_reader(const std::shared_ptr<schema> &schema, const std::string &column,
+                                                                      const sql_value &id);
+                std::shared_ptr<rj::db::blob_writer> open_blob_writer(const std::shared_ptr<schema> &schema, const std::string &column,
+                                                                      const sql_value &id, size_t size);
                 void query_schema(const std::string &dbName, const std::string &tablename, std::vector<column_definition> &columns);
+
+                /*!
+                 * executes a sql statement, fetching the results from the server as they are read
+                 * the connection can not be used for anything else until the results are read or destroyed
+                 * @param  sql the sql string to execute
+                 * @return     the results of the query, readable once
+                 */
+                std::shared_ptr<resultset_impl> stream(const std::string &sql);
             };
         }
     }
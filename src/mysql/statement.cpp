@@ -23,6 +23,9 @@ namespace rj
                 extern string last_stmt_error(MYSQL_STMT *stmt);
 
                 struct stmt_delete {
+                    // the result buffers live as long as the statement, so every execution can reuse them
+                    shared_ptr<binding> results;
+
                     void operator()(MYSQL_STMT *p) const
                     {
                         if (p != nullptr) {
@@ -30,6 +33,26 @@ namespace rj
                         }
                     }
                 };
+
+                /*!
+                 * gets the result bindings kept with a statement, when nothing else is using them
+                 */
+                static shared_ptr<binding> result_bindings(const shared_ptr<MYSQL_STMT> &stmt)
+                {
+                    // a cached statement is checked out under a different deleter
+                    auto deleter = std::get_deleter<stmt_delete>(statement_cache<MYSQL_STMT, stmt_reset>::owner(stmt));
+
+                    if (deleter == nullptr) {
+                        return nullptr;
+                    }
+
+                    // buffers still read by an earlier result set or row are left to it
+                    if (deleter->results == nullptr || deleter->results.use_count() > 1) {
+                        deleter->results = make_shared<binding>();
+                    }
+
+                    return deleter->results;
+                }
             }
 
             statement::statement(const std::shared_ptr<session> &sess) : sess_(sess), stmt_(nullptr)
@@ -67,19 +90,29 @@ namespace rj
                     throw database_exception("database is not open");
                 }
 
+                string formatted_sql = bindings_.prepare(sql);
+
+                auto cached = sess_->statements_.get(formatted_sql);
+
+                // a returned statement was already reset
+                if (cached != nullptr) {
+                    stmt_ = cached;
+                    return;
+                }
+
                 MYSQL_STMT *temp = mysql_stmt_init(sess_->db_.get());
 
                 if (temp == nullptr) {
                     throw database_exception("out of memory");
                 }
 
-                stmt_ = shared_ptr<MYSQL_STMT>(temp, helper::stmt_delete());
-
-                string formatted_sql = bindings_.prepare(sql);
+                auto stmt = shared_ptr<MYSQL_STMT>(temp, helper::stmt_delete());
 
-                if (mysql_stmt_prepare(stmt_.get(), formatted_sql.c_str(), formatted_sql.length())) {
+                if (mysql_stmt_prepare(stmt.get(), formatted_sql.c_str(), formatted_sql.length())) {
                     throw database_exception(sess_->last_error());
                 }
+
+                stmt_ = sess_->statements_.put(formatted_sql, stmt);
             }
 
             bool statement::is_valid() const
@@ -166,7 +199,18 @@ namespace rj
 
                 bindings_.bind_params(stmt_.get());
 
-                return resultset_type(make_shared<stmt_resultset>(sess_, stmt_));
+                return resultset_type(make_shared<stmt_resultset>(sess_, stmt_, true, helper::result_bindings(stmt_)));
+            }
+
+            statement::resultset_type statement::stream_results()
+            {
+                if (!is_valid()) {
+                    throw database_exception("statement not ready");
+                }
+
+                bindings_.bind_params(stmt_.get());
+
+                return resultset_type(make_shared<stmt_resultset>(sess_, stmt_, false, helper::result_bindings(stmt_)));
             }
 
             bool statement::result()
@@ -207,10 +251,8 @@ namespace rj
             {
                 bindings_.reset();
 
-                if (stmt_ != nullptr) {
-                    mysql_stmt_free_result(stmt_.get());
-                    stmt_ = nullptr;
-                }
+                // a result set may still be reading, so the results are freed when the statement is returned
+                stmt_ = nullptr;
             }
 
             void statement::reset()
@@ -235,6 +277,12 @@ namespace rj
 
                 return mysql_stmt_insert_id(stmt_.get());
             }
+
+            vector<long long> statement::last_insert_ids()
+            {
+                // mysql only reports the first id of a multi row insert
+                return vector<long long>();
+            }
         }
     }
 }
@@ -50,11 +50,13 @@ namespace rj
                 void prepare(const std::string &sql);
                 bool is_valid() const;
                 resultset_type results();
+                resultset_type stream_results();
                 bool result();
                 void finish();
                 void reset();
                 int last_number_of_changes();
                 long long last_insert_id();
+                std::vector<long long> last_insert_ids();
                 std::string last_error();
 
                 /* bindable overrides */
@@ -9,12 +9,16 @@
 #include <libpq-fe.h>
 #include <postgres.h>
 #include <time.h>
+#include <algorithm>
 #include <cassert>
+#include <cfloat>
 #include <codecvt>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <locale>
 #include <memory>
-#include <regex>
 #include "catalog/pg_type.h"
 
 #include "../alloc.h"
@@ -31,16 +35,378 @@ namespace rj
     {
         namespace postgres
         {
+            namespace helper
+            {
+                // seconds between the unix and postgres epochs
+                static const long long POSTGRES_EPOCH = 946684800LL;
+
+                static const long long MICROS_PER_SECOND = 1000000LL;
+
+                /*!
+                 * allocates a value in network byte order
+                 */
+                static char *to_network(uint64_t value, int bytes)
+                {
+                    auto buf = c_alloc<char>(bytes);
+
+                    for (int i = bytes - 1; i >= 0; i--) {
+                        buf[bytes - 1 - i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+                    }
+
+                    return buf;
+                }
+
+                /*!
+                 * reads a value in network byte order
+                 */
+                static uint64_t from_network(const char *value, int bytes)
+                {
+                    auto data = reinterpret_cast<const unsigned char *>(value);
+
+                    uint64_t result = 0;
+
+                    for (int i = 0; i < bytes; i++) {
+                        result = (result << 8) | data[i];
+                    }
+
+                    return result;
+                }
+
+                static long long floor_div(long long value, long long divisor)
+                {
+                    long long result = value / divisor;
+
+                    if ((value % divisor) != 0 && value < 0) {
+                        result--;
+                    }
+
+                    return result;
+                }
+
+                /*!
+                 * widens a float using the shortest text that reads back the same, as the text protocol would
+                 */
+                static double to_double(float value)
+                {
+                    char buf[32] = {0};
+
+                    for (int precision = FLT_DIG; precision <= FLT_DIG + 3; precision++) {
+                        snprintf(buf, sizeof(buf), "%.*g", precision, value);
+
+                        if (strtof(buf, nullptr) == value) {
+                            break;
+                        }
+                    }
+
+                    return strtod(buf, nullptr);
+                }
+
+                static string uuid_to_string(const char *value)
+                {
+                    static const char digits[] = "0123456789abcdef";
+
+                    auto data = reinterpret_cast<const unsigned char *>(value);
+
+                    string result;
+
+                    for (int i = 0; i < 16; i++) {
+                        if (i == 4 || i == 6 || i == 8 || i == 10) {
+                            result.push_back('-');
+                        }
+                        result.push_back(digits[data[i] >> 4]);
+                        result.push_back(digits[data[i] & 0x0F]);
+                    }
+
+                    return result;
+                }
+
+                /*!
+                 * counts days since the unix epoch for a date in the proleptic gregorian calendar
+                 */
+                static long long days_from_civil(long long year, unsigned month, unsigned day)
+                {
+                    year -= month <= 2;
+
+                    long long era = (year >= 0 ? year : year - 399) / 400;
+                    unsigned yoe = static_cast<unsigned>(year - era * 400);
+                    unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+                    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+                    return era * 146097 + static_cast<long long>(doe) - 719468;
+                }
+
+                /*!
+                 * reads the iso text of a date, time or timestamp as the binary format would decode it
+                 * @param value the text, ex. "2001-02-03 04:05:06.789+02"
+                 * @param format the part of the value to read
+                 * @param seconds set to the seconds since the unix epoch, or since midnight for a time
+                 * @return false if the text is not in the iso format
+                 */
+                static bool parse_time(const char *value, sql_time::formats format, long long &seconds)
+                {
+                    int year = 1970, month = 1, day = 1, hour = 0, minute = 0, second = 0, used = 0;
+
+                    const char *pos = value;
+
+                    if (format != sql_time::TIME) {
+                        if (sscanf(pos, "%d-%d-%d%n", &year, &month, &day, &used) != 3) {
+                            return false;
+                        }
+                        pos += used;
+
+                        if (*pos == ' ' || *pos == 'T') {
+                            pos++;
+                        }
+                    }
+
+                    if (format != sql_time::DATE) {
+                        if (sscanf(pos, "%d:%d:%d%n", &hour, &minute, &second, &used) != 3) {
+                            return false;
+                        }
+                        pos += used;
+
+                        // the binary value is floored to the second as well
+                        if (*pos == '.') {
+                            for (pos++; isdigit(static_cast<unsigned char>(*pos)); pos++)
+                                ;
+                        }
+                    }
+
+                    seconds = hour * 3600LL + minute * 60LL + second;
+
+                    if (format == sql_time::TIME) {
+                        return true;
+                    }
+
+                    seconds += days_from_civil(year, month, day) * 86400LL;
+
+                    // a time zone offset of +hh, +hh:mm or +hh:mm:ss
+                    if (*pos == '+' || *pos == '-') {
+                        int sign = *pos == '-' ? -1 : 1, parts[3] = {0, 0, 0};
+
+                        sscanf(pos + 1, "%d:%d:%d", &parts[0], &parts[1], &parts[2]);
+
+                        seconds -= sign * (parts[0] * 3600LL + parts[1] * 60LL + parts[2]);
+                    }
+
+                    // ex. 2001-02-03 BC
+                    return strstr(pos, "BC") == nullptr;
+                }
+
+                /*!
+                 * formats a binary numeric, which is a list of base 10000 digits
+                 */
+                static sql_value numeric_to_value(const char *value, int len)
+                {
+                    static const int NUMERIC_POS = 0x0000;
+                    static const int NUMERIC_NEG = 0x4000;
+                    static const int NUMERIC_NAN = 0xC000;
+                    static const int NUMERIC_PINF = 0xD000;
+                    static const int NUMERIC_NINF = 0xF000;
+
+                    if (len < 8) {
+                        return sql_null;
+                    }
+
+                    int ndigits = static_cast<int16_t>(from_network(value, 2));
+                    int weight = static_cast<int16_t>(from_network(value + 2, 2));
+                    int sign = static_cast<uint16_t>(from_network(value + 4, 2));
+                    int dscale = static_cast<int16_t>(from_network(value + 6, 2));
+
+                    switch (sign) {
+                        case NUMERIC_POS:
+                        case NUMERIC_NEG:
+                            break;
+                        case NUMERIC_NAN:
+                            return "NaN";
+                        case NUMERIC_PINF:
+                            return "Infinity";
+                        case NUMERIC_NINF:
+                            return "-Infinity";
+                        default:
+                            log::warn("unknown sign %x in a postgres numeric", sign);
+                            return sql_null;
+                    }
+
+                    if (len < 8 + ndigits * 2) {
+                        return sql_null;
+                    }
+
+                    auto digit = [&](int i) { return i >= 0 && i < ndigits ? static_cast<int>(from_network(value + 8 + i * 2, 2)) : 0; };
+
+                    char buf[8] = {0};
+
+                    string result = sign == NUMERIC_NEG ? "-" : "";
+
+                    if (weight < 0) {
+                        result.push_back('0');
+                    }
+
+                    for (int i = 0; i <= weight; i++) {
+                        snprintf(buf, sizeof(buf), i == 0 ? "%d" : "%04d", digit(i));
+                        result.append(buf);
+                    }
+
+                    if (dscale > 0) {
+                        string fraction;
+
+                        for (int i = weight + 1; static_cast<int>(fraction.size()) < dscale; i++) {
+                            snprintf(buf, sizeof(buf), "%04d", digit(i));
+                            fraction.append(buf);
+                        }
+
+                        result.append(".").append(fraction, 0, dscale);
+                    }
+
+                    return result;
+                }
+            }
+
             namespace data_mapper
             {
+                // Decodes a value sent in the binary format
+                static sql_value binary_to_value(Oid type, const char *value, int len)
+                {
+                    switch (type) {
+                        case BYTEAOID:
+                            return binary(value, len);
+                        case BOOLOID:
+                            if (len < 1) {
+                                return sql_null;
+                            }
+                            return value[0] != 0;
+                        case CHAROID:
+                            return string(value, len);
+                        case INT2OID:
+                            if (len < 2) {
+                                return sql_null;
+                            }
+                            return static_cast<long>(static_cast<int16_t>(helper::from_network(value, 2)));
+                        case INT4OID:
+                            if (len < 4) {
+                                return sql_null;
+                            }
+                            return static_cast<long>(static_cast<int32_t>(helper::from_network(value, 4)));
+                        case OIDOID:
+                            if (len < 4) {
+                                return sql_null;
+                            }
+                            return static_cast<long long>(static_cast<uint32_t>(helper::from_network(value, 4)));
+                        case INT8OID:
+                            if (len < 8) {
+                                return sql_null;
+                            }
+                            return static_cast<long long>(helper::from_network(value, 8));
+                        case FLOAT4OID: {
+                            if (len < 4) {
+                                return sql_null;
+                            }
+                            uint32_t bits = static_cast<uint32_t>(helper::from_network(value, 4));
+                            float real;
+                            memcpy(&real, &bits, sizeof(real));
+                            return helper::to_double(real);
+                        }
+                        case FLOAT8OID: {
+                            if (len < 8) {
+                                return sql_null;
+                            }
+                            uint64_t bits = helper::from_network(value, 8);
+                            double real;
+                            memcpy(&real, &bits, sizeof(real));
+                            return static_cast<long double>(real);
+                        }
+                        case TIMESTAMPOID:
+                        case TIMESTAMPTZOID: {
+                            if (len < 8) {
+                                return sql_null;
+                            }
+                            // microseconds since the postgres epoch
+                            long long micros = static_cast<long long>(helper::from_network(value, 8));
+                            return sql_time(helper::POSTGRES_EPOCH + helper::floor_div(micros, helper::MICROS_PER_SECOND), sql_time::TIMESTAMP);
+                        }
+                        case DATEOID: {
+                            if (len < 4) {
+                                return sql_null;
+                            }
+                            // days since the postgres epoch
+                            long long days = static_cast<int32_t>(helper::from_network(value, 4));
+                            return sql_time(helper::POSTGRES_EPOCH + days * 86400LL, sql_time::DATE);
+                        }
+                        case TIMEOID: {
+                            if (len < 8) {
+                                return sql_null;
+                            }
+                            // microseconds since midnight
+                            long long micros = static_cast<long long>(helper::from_network(value, 8));
+                            return sql_time(micros / helper::MICROS_PER_SECOND, sql_time::TIME);
+                        }
+                        case UUIDOID:
+                            if (len < 16) {
+                                return sql_null;
+                            }
+                            return helper::uuid_to_string(value);
+                        case NUMERICOID:
+                            return helper::numeric_to_value(value, len);
+                        case JSONBOID:
+                            // skip the version number
+                            if (len < 1) {
+                                return sql_null;
+                            }
+                            return string(value + 1, len - 1);
+                        case UNKNOWNOID:
+                            return nullptr;
+                        default:
+                            // text types are sent as is
+                            return string(value, len);
+                    }
+                }
+
+                bool decodes_binary(Oid type)
+                {
+                    switch (type) {
+                        case BYTEAOID:
+                        case BOOLOID:
+                        case CHAROID:
+                        case INT2OID:
+                        case INT4OID:
+                        case OIDOID:
+                        case INT8OID:
+                        case FLOAT4OID:
+                        case FLOAT8OID:
+                        case TIMESTAMPOID:
+                        case TIMESTAMPTZOID:
+                        case DATEOID:
+                        case TIMEOID:
+                        case UUIDOID:
+                        case NUMERICOID:
+                        case JSONBOID:
+                        case UNKNOWNOID:
+                        // the binary format of text types is the text
+                        case TEXTOID:
+                        case VARCHAROID:
+                        case BPCHAROID:
+                        case NAMEOID:
+                        case JSONOID:
+                        case XMLOID:
+                            return true;
+                        default:
+                            // ex. intervals, arrays, network addresses, bit strings, money or user defined types
+                            return false;
+                    }
+                }
+
                 // Key function here. Handles conversion from Oid to sql_value
                 // TODO: test more
-                sql_value to_value(Oid type, const char *value, int len)
+                sql_value to_value(Oid type, const char *value, int len, int format)
                 {
                     if (value == nullptr) {
                         return sql_null;
                     }
 
+                    if (format == 1) {
+                        return binary_to_value(type, value, len);
+                    }
+
                     switch (type) {
                         case BYTEAOID: {
                             size_t blen = 0;
@@ -49,18 +415,45 @@ namespace rj
                             free(b);
                             return bin;
                         }
+                        // the same types as the binary format, so a row reads the same whichever format it was sent in
                         case BOOLOID:
+                            if (value[0] == 't') {
+                                return true;
+                            }
+                            if (value[0] == 'f') {
+                                return false;
+                            }
+                            return sql_null;
                         case CHAROID:
+                            return string(value, len);
                         case INT8OID:
+                        case OIDOID:
+                            try {
+                                return stoll(value);
+                            } catch (const std::exception &e) {
+                                return sql_null;
+                            }
                         case INT2OID:
                         case INT4OID:
-                        case TIMESTAMPOID:
                         case BITOID:
                             try {
                                 return stol(value);
                             } catch (const std::exception &e) {
                                 return sql_null;
                             }
+                        case TIMESTAMPOID:
+                        case TIMESTAMPTZOID:
+                        case DATEOID:
+                        case TIMEOID: {
+                            auto format = type == DATEOID ? sql_time::DATE : type == TIMEOID ? sql_time::TIME : sql_time::TIMESTAMP;
+                            long long seconds = 0;
+
+                            // ex. infinity, which has no time to convert to
+                            if (!helper::parse_time(value, format, seconds)) {
+                                return value;
+                            }
+                            return sql_time(seconds, format);
+                        }
                         case FLOAT4OID:
                             try {
                                 return stod(value);
@@ -77,8 +470,6 @@ namespace rj
                             return nullptr;
                         case VARCHAROID:
                         case TEXTOID:
-                        case DATEOID:
-                        case TIMEOID:
                         case UUIDOID:
                             return value;
                         default:
@@ -87,6 +478,72 @@ namespace rj
                 }
             }
 
+#ifdef ENHANCED_PARAMETER_MAPPING
+            namespace helper
+            {
+                shared_ptr<rewritten_sql> rewrite_parameters(const string &sql)
+                {
+                    auto params = rj::db::helper::find_parameters(sql);
+
+                    auto value = make_shared<rewritten_sql>();
+
+                    vector<size_t> numbers(params.size());
+
+                    size_t count = 0, max_index = 0;
+
+                    // ? parameters are numbered in order, $n parameters keep their number
+                    for (size_t i = 0; i < params.size(); i++) {
+                        switch (params[i].type) {
+                            case '?':
+                                numbers[i] = ++count;
+                                break;
+                            case '$':
+                                numbers[i] = params[i].number;
+                                break;
+                            default:
+                                continue;
+                        }
+                        max_index = std::max(max_index, numbers[i]);
+                    }
+
+                    // named parameters go after the indexed ones, postgres can reuse one index for each occurrence
+                    for (size_t i = 0; i < params.size(); i++) {
+                        if (params[i].type != '@' && params[i].type != ':') {
+                            continue;
+                        }
+
+                        auto &indexes = value->named[sql.substr(params[i].offset, params[i].length)];
+
+                        if (indexes.empty()) {
+                            indexes.insert(++max_index);
+                        }
+
+                        numbers[i] = *indexes.begin();
+                    }
+
+                    size_t last = 0;
+
+                    for (size_t i = 0; i < params.size(); i++) {
+                        auto &param = params[i];
+
+                        value->sql.append(sql, last, param.offset - last);
+
+                        if (param.type == '$') {
+                            value->sql.append(sql, param.offset, param.length);
+                        } else {
+                            value->sql.append("$").append(std::to_string(numbers[i]));
+                        }
+
+                        last = param.offset + param.length;
+                    }
+
+                    value->sql.append(sql, last, string::npos);
+
+                    return value;
+                }
+            }
+#endif
+
             binding::binding() : values_(nullptr), types_(nullptr), lengths_(nullptr), formats_(nullptr), size_(0)
             {
             }
@@ -152,7 +609,14 @@ namespace rj
                     types_[i] = value.types_[i];
                     lengths_[i] = value.lengths_[i];
                     formats_[i] = value.formats_[i];
-                    if (value.values_[i]) {
+                    if (value.values_[i] == nullptr) {
+                        continue;
+                    }
+                    if (formats_[i] == 1) {
+                        // binary values can hold zeros
+                        values_[i] = c_alloc<char>(lengths_[i] + 1);
+                        memcpy(values_[i], value.values_[i], lengths_[i]);
+                    } else {
                         values_[i] = strdup(value.values_[i]);
                     }
                 }
@@ -210,7 +674,7 @@ namespace rj
                 if (index >= size_ || values_ == nullptr || values_[index] == nullptr) {
                     return sql_null;
                 }
-                return data_mapper::to_value(types_[index], values_[index], lengths_[index]);
+                return data_mapper::to_value(types_[index], values_[index], lengths_[index], formats_[index]);
             }
 
             int binding::sql_type(size_t index) const
@@ -254,10 +718,10 @@ namespace rj
             binding &binding::bind(size_t index, int value)
             {
                 if (reallocate_value(index)) {
-                    values_[index - 1] = strdup(std::to_string(value).c_str());
-                    types_[index - 1] = sizeof(int) == 2 ? INT2OID : sizeof(int) == 4 ? INT4OID : INT8OID;
-                    lengths_[index - 1] = sizeof(int);
-                    formats_[index - 1] = 0;
+                    values_[index - 1] = helper::to_network(static_cast<uint32_t>(value), 4);
+                    types_[index - 1] = INT4OID;
+                    lengths_[index - 1] = 4;
+                    formats_[index - 1] = 1;
                 } else {
                     log::warn("unable to reallocate bindings for index %ld", index);
                 }
@@ -267,10 +731,11 @@ namespace rj
             binding &binding::bind(size_t index, unsigned value)
             {
                 if (reallocate_value(index)) {
-                    values_[index - 1] = strdup(std::to_string(value).c_str());
-                    types_[index - 1] = sizeof(unsigned) <= 2 ? INT2OID : sizeof(unsigned) <= 4 ? INT4OID : INT8OID;
-                    lengths_[index - 1] = sizeof(unsigned);
-                    formats_[index - 1] = 0;
+                    // postgres has no unsigned types, so widen to fit
+                    values_[index - 1] = helper::to_network(value, 8);
+                    types_[index - 1] = INT8OID;
+                    lengths_[index - 1] = 8;
+                    formats_[index - 1] = 1;
                 } else {
                     log::warn("unable to reallocate bindings for index %ld", index);
                 }
@@ -280,10 +745,10 @@ namespace rj
             binding &binding::bind(size_t index, long long value)
             {
                 if (reallocate_value(index)) {
-                    values_[index - 1] = strdup(std::to_string(value).c_str());
-                    types_[index - 1] = sizeof(long long) == 2 ? INT2OID : sizeof(long long) == 4 ? INT4OID : INT8OID;
-                    lengths_[index - 1] = sizeof(long long);
-                    formats_[index - 1] = 0;
+                    values_[index - 1] = helper::to_network(static_cast<uint64_t>(value), 8);
+                    types_[index - 1] = INT8OID;
+                    lengths_[index - 1] = 8;
+                    formats_[index - 1] = 1;
                 } else {
                     log::warn("unable to reallocate bindings for index %ld", index);
                 }
@@ -293,8 +758,9 @@ namespace rj
             binding &binding::bind(size_t index, unsigned long long value)
             {
                 if (reallocate_value(index)) {
+                    // too large for a bigint, so let the server convert the text
                     values_[index - 1] = strdup(std::to_string(value).c_str());
-                    types_[index - 1] = sizeof(unsigned long long) <= 2 ? INT2OID : sizeof(unsigned long long) <= 4 ? INT4OID : INT8OID;
+                    types_[index - 1] = INT8OID;
                     lengths_[index - 1] = sizeof(unsigned long long);
                     formats_[index - 1] = 0;
                 } else {
@@ -306,10 +772,12 @@ namespace rj
             binding &binding::bind(size_t index, float value)
             {
                 if (reallocate_value(index)) {
-                    values_[index - 1] = strdup(std::to_string(value).c_str());
+                    uint32_t bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    values_[index - 1] = helper::to_network(bits, 4);
                     types_[index - 1] = FLOAT4OID;
-                    lengths_[index - 1] = sizeof(float);
-                    formats_[index - 1] = 0;
+                    lengths_[index - 1] = 4;
+                    formats_[index - 1] = 1;
                 } else {
                     log::warn("unable to reallocate bindings for index %ld", index);
                 }
@@ -319,10 +787,12 @@ namespace rj
             binding &binding::bind(size_t index, double value)
             {
                 if (reallocate_value(index)) {
-                    values_[index - 1] = strdup(std::to_string(value).c_str());
-                    types_[index - 1] = sizeof(double) <= 4 ? FLOAT4OID : FLOAT8OID;
-                    lengths_[index - 1] = sizeof(double);
-                    formats_[index - 1] = 0;
+                    uint64_t bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    values_[index - 1] = helper::to_network(bits, 8);
+                    types_[index - 1] = FLOAT8OID;
+                    lengths_[index - 1] = 8;
+                    formats_[index - 1] = 1;
                 } else {
                     log::warn("unable to reallocate bindings for index %ld", index);
                 }
@@ -361,7 +831,11 @@ namespace rj
             binding &binding::bind(size_t index, const sql_blob &value)
             {
                 if (reallocate_value(index)) {
-                    values_[index - 1] = strdup(value.to_string().c_str());
+                    // the raw bytes, which can include zeros
+                    values_[index - 1] = c_alloc<char>(value.size() + 1);
+                    if (value.size() > 0) {
+                        memcpy(values_[index - 1], value.value(), value.size());
+                    }
                     types_[index - 1] = BYTEAOID;
                     lengths_[index - 1] = value.size();
                     formats_[index - 1] = 1;
@@ -389,21 +863,33 @@ namespace rj
             binding &binding::bind(size_t index, const sql_time &value)
             {
                 if (reallocate_value(index)) {
-                    values_[index - 1] = strdup(value.to_string().c_str());
+                    long long seconds = value.to_llong();
+
                     switch (value.format()) {
                         case sql_time::DATE:
+                            // days since the postgres epoch
+                            values_[index - 1] = helper::to_network(
+                                static_cast<uint32_t>(helper::floor_div(seconds - helper::POSTGRES_EPOCH, 86400LL)), 4);
                             types_[index - 1] = DATEOID;
+                            lengths_[index - 1] = 4;
                             break;
                         case sql_time::TIME:
+                            // microseconds since midnight
+                            values_[index - 1] = helper::to_network(
+                                static_cast<uint64_t>((seconds - helper::floor_div(seconds, 86400LL) * 86400LL) * helper::MICROS_PER_SECOND), 8);
                             types_[index - 1] = TIMEOID;
+                            lengths_[index - 1] = 8;
                             break;
                         case sql_time::DATETIME:
                         case sql_time::TIMESTAMP:
+                            // microseconds since the postgres epoch
+                            values_[index - 1] =
+                                helper::to_network(static_cast<uint64_t>((seconds - helper::POSTGRES_EPOCH) * helper::MICROS_PER_SECOND), 8);
                             types_[index - 1] = TIMESTAMPOID;
+                            lengths_[index - 1] = 8;
                             break;
                     }
-                    lengths_[index - 1] = value.size();
-                    formats_[index - 1] = 0;
+                    formats_[index - 1] = 1;
                 } else {
                     log::warn("unable to reallocate bindings for index %ld", index);
                 }
@@ -431,65 +917,19 @@ namespace rj
             std::string binding::prepare(const string &sql)
             {
 #ifdef ENHANCED_PARAMETER_MAPPING
-                auto match_begin = std::sregex_iterator(sql.begin(), sql.end(), bindable::index_regex);
-                auto match_end = std::sregex_iterator();
-
-                std::vector<size_t> indexes;
-
-                // determine max index, to add named params at end
-                // postgres can reuse indexes so this is necessary over just counting
-                size_t max_index = 0;
-                for (auto match = match_begin; match != match_end; ++match) {
-                    auto str = match->str();
-                    if (str[0] == '$') {
-                        auto sub = *match;
-                        auto pos = std::stol(sub[2].str());
-                        // don't increment max index if not needed
-                        if (pos < max_index) {
-                            continue;
-                        }
-                    } else {
-                        indexes.push_back(indexes.size() + 1);
-                    }
-                    ++max_index;
-                }
+                static rewritten_sql_cache cache;
 
-                // map the named parameters
-                bind_mapping::prepare(sql, max_index);
-
-                // do replacing while searching.
-                // TODO: this is ineffecient, find a better way
-                std::string formatted = sql;
-
-                match_begin = std::sregex_iterator(sql.begin(), sql.end(), bindable::param_regex);
-                match_end = std::sregex_iterator();
-
-                for (auto match = match_begin; match != match_end; ++match) {
-                    auto str = match->str();
-                    // if it is a named parameter...
-                    if (str[0] == '@' || str[0] == ':') {
-                        // get the determined positions for the named parameter
-                        auto mapped = get_named_param_indexes(str);
-                        if (!mapped.empty()) {
-                            // postgres only needs the first determined index as it can re-use
-                            // parameter indexes
-                            auto pos = *mapped.begin();
-                            // replace the sql with the positional parameter
-                            formatted.replace(formatted.find(str), str.length(), "$" + std::to_string(pos));
-                        }
-                        continue;
-                    }
+                auto value = cache.get(sql);
 
-                    // if its not a postgres parameter, replace it with one
-                    if (str[0] == '?') {
-                        // otherwise, replace the matched paramter with the current index
-                        auto pos = indexes.back();
-                        formatted.replace(formatted.find(str), str.length(), "$" + std::to_string(pos));
-                        indexes.pop_back();
-                    }
+                if (value == nullptr) {
+                    value = helper::rewrite_parameters(sql);
+                    cache.put(sql, value);
                 }
 
-                return formatted;
+                // map the named parameters
+                bind_mapping::prepare(*value);
+
+                return value->sql;
 #else
                 return sql;
 #endif
@@ -24,7 +24,22 @@ namespace rj
         {
             namespace data_mapper
             {
-                sql_value to_value(Oid type, const char *value, int len);
+                /*!
+                 * converts a postgres value
+                 * @param type the type of the value
+                 * @param value the value data
+                 * @param len the length of the value data
+                 * @param format zero for the text format, one for the binary format
+                 * @return the converted value
+                 */
+                sql_value to_value(Oid type, const char *value, int len, int format = 0);
+
+                /*!
+                 * tests if values of a type are decoded from the binary format
+                 * @param type the type of the value
+                 * @return true if the type is decoded, false if it has to be read in the text format
+                 */
+                bool decodes_binary(Oid type);
             }
             /*
              * utility class to simplify binding query parameters
@@ -33,6 +48,7 @@ namespace rj
             {
                 friend class column;
                 friend class statement;
+                friend class pipeline;
 
                private:
                 char **values_;
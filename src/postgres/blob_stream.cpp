@@ -0,0 +1,233 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBPQ
+
+#include "blob_stream.h"
+#include <libpq/libpq-fs.h>
+#include <cstring>
+#include "../exception.h"
+#include "../log.h"
+#include "../resultset.h"
+#include "../schema.h"
+#include "../statement.h"
+#include "session.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        namespace postgres
+        {
+            blob_reader::blob_reader(const shared_ptr<session> &sess, const shared_ptr<schema> &schema, const string &column,
+                                     const sql_value &id)
+                : id_(id), size_(0)
+            {
+                auto length = sess->create_statement();
+
+                length->prepare("SELECT octet_length(" + column + ") FROM " + schema->table_name() + " WHERE " + schema->primary_key() +
+                                " = $1");
+
+                length->bind_value(1, id_);
+
+                auto rs = length->results();
+
+                if (!rs.next()) {
+                    throw database_exception("no row in " + schema->table_name() + " for " + id.to_string());
+                }
+
+                // a null value reads as empty
+                size_ = rs.current_row().column(0).to_value().to_llong();
+
+                stmt_ = sess->create_statement();
+
+                stmt_->prepare("SELECT substring(" + column + " FROM $1 FOR $2) FROM " + schema->table_name() + " WHERE " +
+                               schema->primary_key() + " = $3");
+            }
+
+            size_t blob_reader::size() const
+            {
+                return size_;
+            }
+
+            void blob_reader::read_at(void *buffer, size_t length, size_t offset)
+            {
+                // substring positions start at one, and a bytea is at most a gigabyte
+                stmt_->bind(1, static_cast<int>(offset + 1));
+                stmt_->bind(2, static_cast<int>(length));
+                stmt_->bind_value(3, id_);
+
+                auto rs = stmt_->results();
+
+                if (!rs.next()) {
+                    throw database_exception("blob row was deleted while reading");
+                }
+
+                auto chunk = rs.current_row().column(0).to_value().to_binary();
+
+                if (chunk.size() != length) {
+                    throw database_exception("blob was changed while reading");
+                }
+
+                memcpy(buffer, chunk.value(), length);
+
+                stmt_->reset();
+            }
+
+            namespace helper
+            {
+                /*!
+                 * executes a command that returns no rows
+                 * @return true if it succeeded
+                 */
+                static bool exec_blob_command(PGconn *conn, const char *sql)
+                {
+                    PGresult *res = PQexec(conn, sql);
+
+                    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+
+                    PQclear(res);
+
+                    return success;
+                }
+            }
+
+            blob_writer::blob_writer(const shared_ptr<session> &sess, const shared_ptr<schema> &schema, const string &column,
+                                     const sql_value &id)
+                : sess_(sess), id_(id), object_(InvalidOid), fd_(-1), ownsTransaction_(false)
+            {
+                PGconn *conn = sess_->db_.get();
+
+                if (conn == nullptr) {
+                    throw database_exception("database is not open");
+                }
+
+                auto exists = sess_->create_statement();
+
+                exists->prepare("SELECT 1 FROM " + schema->table_name() + " WHERE " + schema->primary_key() + " = $1");
+
+                exists->bind_value(1, id_);
+
+                if (!exists->results().next()) {
+                    throw database_exception("no row in " + schema->table_name() + " for " + id.to_string());
+                }
+
+                // large objects only exist in a transaction, and it hides the value until it is complete
+                ownsTransaction_ = !sess_->in_transaction();
+
+                if (!helper::exec_blob_command(conn, ownsTransaction_ ? "BEGIN" : "SAVEPOINT rj_blob")) {
+                    throw database_exception(sess_->last_error());
+                }
+
+                object_ = lo_creat(conn, INV_READ | INV_WRITE);
+
+                if (object_ != InvalidOid) {
+                    fd_ = lo_open(conn, object_, INV_WRITE);
+                }
+
+                if (fd_ < 0) {
+                    auto error = sess_->last_error();
+                    discard();
+                    throw database_exception(error);
+                }
+
+                stmt_ = sess_->create_statement();
+
+                stmt_->prepare("UPDATE " + schema->table_name() + " SET " + column + " = lo_get($1::oid) WHERE " + schema->primary_key() +
+                               " = $2");
+            }
+
+            blob_writer::~blob_writer()
+            {
+                if (fd_ < 0) {
+                    return;
+                }
+
+                log::warn("blob writer was not closed, discarding the value");
+
+                lo_close(sess_->db_.get(), fd_);
+
+                fd_ = -1;
+
+                discard();
+            }
+
+            void blob_writer::discard()
+            {
+                PGconn *conn = sess_->db_.get();
+
+                if (conn == nullptr) {
+                    return;
+                }
+
+                if (ownsTransaction_) {
+                    helper::exec_blob_command(conn, "ROLLBACK");
+                    return;
+                }
+
+                helper::exec_blob_command(conn, "ROLLBACK TO SAVEPOINT rj_blob");
+                helper::exec_blob_command(conn, "RELEASE SAVEPOINT rj_blob");
+            }
+
+            void blob_writer::write_next(const void *buffer, size_t length)
+            {
+                if (fd_ < 0) {
+                    throw database_exception("blob writer is closed");
+                }
+
+                // large object writes append at the end, in time proportional to the chunk
+                if (lo_write(sess_->db_.get(), fd_, static_cast<const char *>(buffer), length) != static_cast<int>(length)) {
+                    throw database_exception(sess_->last_error());
+                }
+            }
+
+            void blob_writer::close()
+            {
+                if (fd_ < 0) {
+                    return;
+                }
+
+                PGconn *conn = sess_->db_.get();
+
+                int fd = fd_;
+
+                fd_ = -1;
+
+                try {
+                    if (lo_close(conn, fd) < 0) {
+                        throw database_exception(sess_->last_error());
+                    }
+
+                    stmt_->bind(1, static_cast<long long>(object_));
+                    stmt_->bind_value(2, id_);
+
+                    if (!stmt_->result()) {
+                        throw database_exception(stmt_->last_error());
+                    }
+
+                    if (stmt_->last_number_of_changes() == 0) {
+                        throw database_exception("blob row was deleted while writing");
+                    }
+
+                    stmt_->reset();
+
+                    if (lo_unlink(conn, object_) < 0) {
+                        throw database_exception(sess_->last_error());
+                    }
+
+                    if (!helper::exec_blob_command(conn, ownsTransaction_ ? "COMMIT" : "RELEASE SAVEPOINT rj_blob")) {
+                        throw database_exception(sess_->last_error());
+                    }
+                } catch (...) {
+                    discard();
+                    throw;
+                }
+            }
+        }
+    }
+}
+
+#endif
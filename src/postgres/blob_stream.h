@@ -0,0 +1,111 @@
+/*!
+ * @file blob_stream.h
+ * chunked bytea io for postgres
+ */
+#ifndef RJ_DB_POSTGRES_BLOB_STREAM_H
+#define RJ_DB_POSTGRES_BLOB_STREAM_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBPQ
+
+#include <libpq-fe.h>
+#include <memory>
+#include <string>
+#include "../blob_stream.h"
+#include "../sql_value.h"
+
+namespace rj
+{
+    namespace db
+    {
+        class schema;
+        class statement;
+
+        namespace postgres
+        {
+            class session;
+
+            /*!
+             * reads a bytea column with substring(), one chunk per query
+             */
+            class blob_reader : public rj::db::blob_reader
+            {
+               private:
+                std::shared_ptr<rj::db::statement> stmt_;
+                sql_value id_;
+                size_t size_;
+
+               protected:
+                void read_at(void *buffer, size_t length, size_t offset);
+
+               public:
+                /*!
+                 * @param sess the session to query
+                 * @param schema the schema of the table
+                 * @param column the bytea column
+                 * @param id the primary key value of the row
+                 * @throws database_exception if the row was not found
+                 */
+                blob_reader(const std::shared_ptr<session> &sess, const std::shared_ptr<schema> &schema, const std::string &column,
+                            const sql_value &id);
+
+                size_t size() const;
+            };
+
+            /*!
+             * writes a bytea column by streaming the chunks into a temporary large object
+             * closing copies the large object to the column with lo_get and removes it
+             * the writer runs in its own transaction, or a savepoint of the current one, so the column only changes when closed
+             * the connection can not commit or roll back that transaction until the writer is closed or destroyed
+             */
+            class blob_writer : public rj::db::blob_writer
+            {
+               private:
+                std::shared_ptr<session> sess_;
+                std::shared_ptr<rj::db::statement> stmt_;
+                sql_value id_;
+                Oid object_;
+                int fd_;
+                bool ownsTransaction_;
+
+                /*!
+                 * rolls back everything the writer did, including creating the large object
+                 */
+                void discard();
+
+               protected:
+                void write_next(const void *buffer, size_t length);
+
+               public:
+                /*!
+                 * starts the transaction and creates the large object to write to
+                 * @param sess the session to query
+                 * @param schema the schema of the table
+                 * @param column the bytea column
+                 * @param id the primary key value of the row
+                 * @throws database_exception if the row was not found
+                 */
+                blob_writer(const std::shared_ptr<session> &sess, const std::shared_ptr<schema> &schema, const std::string &column,
+                            const sql_value &id);
+
+                /*!
+                 * discards the value if the writer was not closed
+                 */
+                virtual ~blob_writer();
+
+                /*!
+                 * saves the value to the column and ends the transaction
+                 * @throws database_exception if the value could not be saved, in which case nothing is changed
+                 */
+                void close();
+            };
+        }
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,490 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBPQ
+
+#undef PACKAGE_NAME
+#undef PACKAGE_VERSION
+#include <postgres.h>
+#include <cstdint>
+#include <cstring>
+#include "catalog/pg_type.h"
+
+#include "../exception.h"
+#include "../log.h"
+#include "../query.h"
+#include "bulk_loader.h"
+#include "session.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        namespace postgres
+        {
+            namespace helper
+            {
+                // the copy binary signature, including its terminating zero
+                static const char COPY_SIGNATURE[] = "PGCOPY\n\377\r\n";
+
+                // seconds between the unix and postgres epochs
+                static const long long POSTGRES_EPOCH = 946684800LL;
+
+                void append_uint(string &buf, uint64_t value, int bytes)
+                {
+                    // network byte order
+                    for (int i = bytes - 1; i >= 0; i--) {
+                        buf.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+                    }
+                }
+
+                void append_field(string &buf, const void *data, size_t len)
+                {
+                    append_uint(buf, len, 4);
+                    buf.append(static_cast<const char *>(data), len);
+                }
+
+                void append_escaped(string &buf, const string &value)
+                {
+                    for (auto c : value) {
+                        switch (c) {
+                            case '\\':
+                                buf.append("\\\\");
+                                break;
+                            case '\t':
+                                buf.append("\\t");
+                                break;
+                            case '\n':
+                                buf.append("\\n");
+                                break;
+                            case '\r':
+                                buf.append("\\r");
+                                break;
+                            default:
+                                buf.push_back(c);
+                                break;
+                        }
+                    }
+                }
+
+                void append_hex(string &buf, const sql_blob &value)
+                {
+                    static const char digits[] = "0123456789abcdef";
+
+                    auto bytes = static_cast<const unsigned char *>(value.value());
+
+                    // the bytea hex format, with its backslash escaped for copy
+                    buf.append("\\\\x");
+
+                    for (size_t i = 0; i < value.size(); i++) {
+                        buf.push_back(digits[bytes[i] >> 4]);
+                        buf.push_back(digits[bytes[i] & 0x0F]);
+                    }
+                }
+
+                long long to_timestamp(const sql_value &value)
+                {
+                    if (value.is_time()) {
+                        return value.to_time().to_llong();
+                    }
+                    return value.to_llong();
+                }
+
+                /*!
+                 * reads an integer for a column of a smaller type
+                 * @throws binding_error if the value does not fit
+                 */
+                long long to_integer(const sql_value &value, long long min, long long max, const string &column)
+                {
+                    long long number = value.to_llong();
+
+                    if (number < min || number > max) {
+                        throw binding_error("value " + value.to_string() + " is out of range for column " + column);
+                    }
+
+                    return number;
+                }
+
+                /*!
+                 * divides rounding towards negative infinity, so times before an epoch fall on the day before it
+                 */
+                long long floor_divide(long long value, long long divisor)
+                {
+                    long long quotient = value / divisor;
+
+                    if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+                        quotient--;
+                    }
+
+                    return quotient;
+                }
+            }
+
+            const size_t bulk_loader::BUFFER_SIZE;
+
+            bulk_loader::bulk_loader(const std::shared_ptr<postgres::session> &sess, const std::string &tableName,
+                                     const std::vector<std::string> &columns, format fmt)
+                : sess_(sess), tableName_(tableName), columns_(columns), format_(fmt), numRows_(0), active_(false)
+            {
+                if (sess_ == nullptr) {
+                    throw database_exception("no database provided to postgres bulk loader");
+                }
+
+                if (tableName_.empty() || columns_.empty()) {
+                    throw database_exception("postgres bulk loader requires a table and columns");
+                }
+            }
+
+            bulk_loader::bulk_loader(bulk_loader &&other)
+                : sess_(std::move(other.sess_)),
+                  tableName_(std::move(other.tableName_)),
+                  columns_(std::move(other.columns_)),
+                  types_(std::move(other.types_)),
+                  format_(other.format_),
+                  buffer_(std::move(other.buffer_)),
+                  numRows_(other.numRows_),
+                  active_(other.active_)
+            {
+                other.sess_ = nullptr;
+                other.active_ = false;
+            }
+
+            bulk_loader &bulk_loader::operator=(bulk_loader &&other)
+            {
+                if (active_) {
+                    cancel();
+                }
+
+                sess_ = std::move(other.sess_);
+                tableName_ = std::move(other.tableName_);
+                columns_ = std::move(other.columns_);
+                types_ = std::move(other.types_);
+                format_ = other.format_;
+                buffer_ = std::move(other.buffer_);
+                numRows_ = other.numRows_;
+                active_ = other.active_;
+
+                other.sess_ = nullptr;
+                other.active_ = false;
+
+                return *this;
+            }
+
+            bulk_loader::~bulk_loader()
+            {
+                if (active_) {
+                    cancel();
+                }
+            }
+
+            void bulk_loader::start()
+            {
+                if (active_) {
+                    return;
+                }
+
+                if (sess_ == nullptr || !sess_->is_open()) {
+                    throw database_exception("database is not open");
+                }
+
+                PGconn *conn = sess_->db_.get();
+
+                string columns = rj::db::helper::join_csv(columns_);
+
+                if (format_ == binary && types_.empty()) {
+                    // binary values must match the column types exactly
+                    string sql = "SELECT " + columns + " FROM " + tableName_ + " LIMIT 0";
+
+                    PGresult *res = PQexec(conn, sql.c_str());
+
+                    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+                        PQclear(res);
+                        throw database_exception(sess_->last_error());
+                    }
+
+                    for (int i = 0; i < PQnfields(res); i++) {
+                        types_.push_back(PQftype(res, i));
+                    }
+
+                    PQclear(res);
+                }
+
+                string sql = "COPY " + tableName_ + "(" + columns + ") FROM STDIN";
+
+                if (format_ == binary) {
+                    sql += " WITH (FORMAT binary)";
+                }
+
+                PGresult *res = PQexec(conn, sql.c_str());
+
+                if (PQresultStatus(res) != PGRES_COPY_IN) {
+                    PQclear(res);
+                    throw database_exception(sess_->last_error());
+                }
+
+                PQclear(res);
+
+                active_ = true;
+                numRows_ = 0;
+                buffer_.clear();
+
+                if (format_ == binary) {
+                    buffer_.append(helper::COPY_SIGNATURE, sizeof(helper::COPY_SIGNATURE));
+                    // flags and header extension length
+                    helper::append_uint(buffer_, 0, 4);
+                    helper::append_uint(buffer_, 0, 4);
+                }
+            }
+
+            bulk_loader &bulk_loader::values(const std::vector<sql_value> &row)
+            {
+                if (row.size() != columns_.size()) {
+                    throw binding_error("bulk load values do not match the columns");
+                }
+
+                start();
+
+                size_t size = buffer_.size();
+
+                try {
+                    if (format_ == binary) {
+                        encode_binary(row);
+                    } else {
+                        encode_text(row);
+                    }
+                } catch (...) {
+                    // drop the partly encoded row, so the copy can go on without it
+                    buffer_.resize(size);
+                    throw;
+                }
+
+                numRows_++;
+
+                if (buffer_.size() >= BUFFER_SIZE) {
+                    send();
+                }
+
+                return *this;
+            }
+
+            void bulk_loader::encode_text(const std::vector<sql_value> &row)
+            {
+                for (size_t i = 0; i < row.size(); i++) {
+                    auto &value = row[i];
+
+                    if (i > 0) {
+                        buffer_.push_back('\t');
+                    }
+
+                    switch (value.type()) {
+                        case variant::NULLTYPE:
+                            buffer_.append("\\N");
+                            break;
+                        case variant::BOOL:
+                            buffer_.push_back(value.to_bool() ? 't' : 'f');
+                            break;
+                        case variant::BINARY:
+                            helper::append_hex(buffer_, value.to_binary());
+                            break;
+                        case variant::COMPLEX:
+                            if (value.is_time()) {
+                                helper::append_escaped(buffer_, value.to_time().to_string());
+                                break;
+                            }
+                            throw binding_error("unknown custom type in bulk load");
+                        default:
+                            helper::append_escaped(buffer_, value.to_string());
+                            break;
+                    }
+                }
+
+                buffer_.push_back('\n');
+            }
+
+            void bulk_loader::encode_binary(const std::vector<sql_value> &row)
+            {
+                helper::append_uint(buffer_, row.size(), 2);
+
+                for (size_t i = 0; i < row.size(); i++) {
+                    auto &value = row[i];
+
+                    if (value.type() == variant::NULLTYPE) {
+                        // a length of -1 is null
+                        helper::append_uint(buffer_, 0xFFFFFFFF, 4);
+                        continue;
+                    }
+
+                    switch (types_[i]) {
+                        case BOOLOID:
+                            helper::append_uint(buffer_, 1, 4);
+                            buffer_.push_back(value.to_bool() ? 1 : 0);
+                            break;
+                        case INT2OID:
+                            helper::append_uint(buffer_, 2, 4);
+                            helper::append_uint(buffer_, static_cast<uint16_t>(helper::to_integer(value, INT16_MIN, INT16_MAX, columns_[i])), 2);
+                            break;
+                        case INT4OID:
+                            helper::append_uint(buffer_, 4, 4);
+                            helper::append_uint(buffer_, static_cast<uint32_t>(helper::to_integer(value, INT32_MIN, INT32_MAX, columns_[i])), 4);
+                            break;
+                        case INT8OID:
+                            helper::append_uint(buffer_, 8, 4);
+                            helper::append_uint(buffer_, static_cast<uint64_t>(value.to_llong()), 8);
+                            break;
+                        case FLOAT4OID: {
+                            float real = value.to_float();
+                            uint32_t bits;
+                            memcpy(&bits, &real, sizeof(bits));
+                            helper::append_uint(buffer_, 4, 4);
+                            helper::append_uint(buffer_, bits, 4);
+                            break;
+                        }
+                        case FLOAT8OID: {
+                            double real = value.to_double();
+                            uint64_t bits;
+                            memcpy(&bits, &real, sizeof(bits));
+                            helper::append_uint(buffer_, 8, 4);
+                            helper::append_uint(buffer_, bits, 8);
+                            break;
+                        }
+                        case TIMESTAMPOID:
+                        case TIMESTAMPTZOID: {
+                            // microseconds since the postgres epoch
+                            long long micros = (helper::to_timestamp(value) - helper::POSTGRES_EPOCH) * 1000000LL;
+                            helper::append_uint(buffer_, 8, 4);
+                            helper::append_uint(buffer_, static_cast<uint64_t>(micros), 8);
+                            break;
+                        }
+                        case DATEOID: {
+                            // days since the postgres epoch
+                            long long days = helper::floor_divide(helper::to_timestamp(value) - helper::POSTGRES_EPOCH, 86400LL);
+                            helper::append_uint(buffer_, 4, 4);
+                            helper::append_uint(buffer_, static_cast<uint32_t>(days), 4);
+                            break;
+                        }
+                        case BYTEAOID:
+                            if (value.type() == variant::BINARY) {
+                                auto bin = value.to_binary();
+                                helper::append_field(buffer_, bin.value(), bin.size());
+                                break;
+                            }
+                        // fall through to the string representation
+                        case TEXTOID:
+                        case VARCHAROID:
+                        case BPCHAROID:
+                        case NAMEOID: {
+                            auto str = value.to_string();
+                            helper::append_field(buffer_, str.data(), str.size());
+                            break;
+                        }
+                        default:
+                            throw binding_error("binary bulk load does not support the type of column " + columns_[i]);
+                    }
+                }
+            }
+
+            void bulk_loader::send()
+            {
+                if (buffer_.empty()) {
+                    return;
+                }
+
+                if (PQputCopyData(sess_->db_.get(), buffer_.data(), buffer_.size()) != 1) {
+                    throw database_exception(sess_->last_error());
+                }
+
+                buffer_.clear();
+            }
+
+            long long bulk_loader::finish()
+            {
+                if (!active_) {
+                    return 0;
+                }
+
+                if (format_ == binary) {
+                    // the file trailer is a field count of -1
+                    helper::append_uint(buffer_, 0xFFFF, 2);
+                }
+
+                try {
+                    send();
+                } catch (const database_exception &e) {
+                    cancel(e.what());
+                    throw;
+                }
+
+                PGconn *conn = sess_->db_.get();
+
+                active_ = false;
+
+                if (PQputCopyEnd(conn, nullptr) != 1) {
+                    throw database_exception(sess_->last_error());
+                }
+
+                long long rows = 0;
+                string error;
+
+                // the copy ends with its command result, collect it and anything after
+                PGresult *res;
+
+                while ((res = PQgetResult(conn)) != nullptr) {
+                    if (PQresultStatus(res) == PGRES_COMMAND_OK) {
+                        try {
+                            rows = stoll(PQcmdTuples(res));
+                        } catch (const std::exception &e) {
+                            rows = numRows_;
+                        }
+                    } else if (error.empty()) {
+                        error = PQresultErrorMessage(res);
+                    }
+                    PQclear(res);
+                }
+
+                if (!error.empty()) {
+                    throw database_exception(error);
+                }
+
+                return rows;
+            }
+
+            void bulk_loader::cancel(const std::string &reason)
+            {
+                if (!active_) {
+                    return;
+                }
+
+                active_ = false;
+                buffer_.clear();
+
+                PGconn *conn = sess_->db_.get();
+
+                if (PQputCopyEnd(conn, reason.c_str()) != 1) {
+                    log::error("unable to cancel bulk load: %s", sess_->last_error().c_str());
+                    return;
+                }
+
+                PGresult *res;
+
+                while ((res = PQgetResult(conn)) != nullptr) {
+                    PQclear(res);
+                }
+            }
+
+            long long bulk_loader::rows() const
+            {
+                return numRows_;
+            }
+
+            bool bulk_loader::is_active() const
+            {
+                return active_;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*!
+ * @file bulk_loader.h
+ * loads rows into a postgres table with COPY
+ */
+#ifndef RJ_DB_POSTGRES_BULK_LOADER_H
+#define RJ_DB_POSTGRES_BULK_LOADER_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBPQ
+
+#include <libpq-fe.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../sql_value.h"
+
+namespace rj
+{
+    namespace db
+    {
+        namespace postgres
+        {
+            class session;
+
+            /*!
+             * streams rows to the server with COPY ... FROM STDIN
+             * the rows are only visible once finish is called, destroying an unfinished loader cancels it
+             */
+            class bulk_loader
+            {
+               public:
+                /*!
+                 * the encoding of the copied data
+                 */
+                typedef enum { text, binary } format;
+
+                /*! the number of encoded bytes buffered before sending to the server */
+                constexpr static const size_t BUFFER_SIZE = 64 * 1024;
+
+               private:
+                std::shared_ptr<postgres::session> sess_;
+                std::string tableName_;
+                std::vector<std::string> columns_;
+                std::vector<Oid> types_;
+                format format_;
+                std::string buffer_;
+                long long numRows_;
+                bool active_;
+
+                void encode_text(const std::vector<sql_value> &row);
+                void encode_binary(const std::vector<sql_value> &row);
+                void send();
+
+               public:
+                /*!
+                 * @param sess the session to load into
+                 * @param tableName the table to load into
+                 * @param columns the columns of each row
+                 * @param fmt the encoding to send rows in
+                 */
+                bulk_loader(const std::shared_ptr<postgres::session> &sess, const std::string &tableName, const std::vector<std::string> &columns,
+                            format fmt = text);
+
+                /* non-copyable boilerplate */
+                bulk_loader(const bulk_loader &other) = delete;
+                bulk_loader(bulk_loader &&other);
+                bulk_loader &operator=(const bulk_loader &other) = delete;
+                bulk_loader &operator=(bulk_loader &&other);
+                virtual ~bulk_loader();
+
+                /*!
+                 * starts the copy, called on the first row if needed
+                 * @throws database_exception if the server rejects the copy
+                 */
+                void start();
+
+                /*!
+                 * adds a row to the copy, in the order of the columns
+                 * @param value a value to add
+                 * @param argv a variadic list of values to add
+                 * @return a reference to this instance
+                 */
+                template <typename T, typename... List>
+                bulk_loader &values(const T &value, const List &... argv)
+                {
+                    return values(std::vector<sql_value>{value, argv...});
+                }
+
+                /*!
+                 * adds a row to the copy, in the order of the columns
+                 * @param row the values of the row
+                 * @return a reference to this instance
+                 * @throws binding_error if the values do not match the columns, in which case the row is skipped
+                 */
+                bulk_loader &values(const std::vector<sql_value> &row);
+
+                /*!
+                 * ends the copy, committing the rows
+                 * @return the number of rows loaded
+                 * @throws database_exception if the server rejects the data
+                 */
+                long long finish();
+
+                /*!
+                 * aborts the copy, discarding all rows
+                 * @param reason the error reported to the server
+                 */
+                void cancel(const std::string &reason = "bulk load cancelled");
+
+                /*!
+                 * @return the number of rows added since the copy started
+                 */
+                long long rows() const;
+
+                /*!
+                 * @return true if a copy is in progress
+                 */
+                bool is_active() const;
+            };
+        }
+    }
+}
+
+#endif
+
+#endif
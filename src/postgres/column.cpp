@@ -49,7 +49,7 @@ namespace rj
                 }
 
                 return data_mapper::to_value(PQftype(stmt_.get(), column_), PQgetvalue(stmt_.get(), row_, column_),
-                                             PQgetlength(stmt_.get(), row_, column_));
+                                             PQgetlength(stmt_.get(), row_, column_), PQfformat(stmt_.get(), column_));
             }
 
             int column::sql_type() const
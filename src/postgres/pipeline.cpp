@@ -0,0 +1,263 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBPQ
+
+#include <errno.h>
+#include <poll.h>
+#include <cstdlib>
+
+#include "../exception.h"
+#include "../log.h"
+#include "pipeline.h"
+#include "session.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        namespace postgres
+        {
+            namespace helper
+            {
+#ifdef LIBPQ_HAS_PIPELINING
+                /*!
+                 * sends the output buffer, reading results as they arrive so the server never blocks on a full socket
+                 * @return false if the connection failed
+                 */
+                static bool flush_pipeline(PGconn *conn)
+                {
+                    int rc;
+
+                    while ((rc = PQflush(conn)) == 1) {
+                        struct pollfd fd;
+
+                        fd.fd = PQsocket(conn);
+                        fd.events = POLLIN | POLLOUT;
+                        fd.revents = 0;
+
+                        if (poll(&fd, 1, -1) < 0) {
+                            if (errno == EINTR) {
+                                continue;
+                            }
+                            return false;
+                        }
+
+                        if ((fd.revents & POLLIN) && !PQconsumeInput(conn)) {
+                            return false;
+                        }
+                    }
+
+                    return rc == 0;
+                }
+#endif
+            }
+
+            pipeline::pipeline(const std::shared_ptr<postgres::session> &sess) : sess_(sess)
+            {
+                if (sess_ == nullptr) {
+                    throw database_exception("no database provided to postgres pipeline");
+                }
+            }
+
+            pipeline::pipeline(pipeline &&other) : sess_(std::move(other.sess_)), queue_(std::move(other.queue_))
+            {
+                other.sess_ = nullptr;
+                other.queue_.clear();
+            }
+
+            pipeline &pipeline::operator=(pipeline &&other)
+            {
+                sess_ = std::move(other.sess_);
+                queue_ = std::move(other.queue_);
+
+                other.sess_ = nullptr;
+                other.queue_.clear();
+
+                return *this;
+            }
+
+            pipeline::~pipeline()
+            {
+            }
+
+            pipeline &pipeline::add(const modify_query &query)
+            {
+                binding bindings;
+
+                string sql = bindings.prepare(query.to_string());
+
+                query.bind_params(bindings);
+
+                queue_.emplace_back(sql, std::move(bindings));
+
+                return *this;
+            }
+
+            pipeline &pipeline::add(const std::string &sql, const std::vector<sql_value> &values)
+            {
+                binding bindings;
+
+                string prepared = bindings.prepare(sql);
+
+                for (size_t i = 0; i < values.size(); i++) {
+                    bindings.bind_value(i + 1, values[i]);
+                }
+
+                queue_.emplace_back(prepared, std::move(bindings));
+
+                return *this;
+            }
+
+            size_t pipeline::size() const
+            {
+                return queue_.size();
+            }
+
+            void pipeline::clear()
+            {
+                queue_.clear();
+            }
+
+            vector<int> pipeline::execute()
+            {
+                vector<int> changes;
+
+                if (queue_.empty()) {
+                    return changes;
+                }
+
+                if (sess_ == nullptr || !sess_->is_open()) {
+                    throw database_exception("database is not open");
+                }
+
+                PGconn *conn = sess_->db_.get();
+
+                string error;
+
+#ifdef LIBPQ_HAS_PIPELINING
+                if (!PQenterPipelineMode(conn)) {
+                    throw database_exception(sess_->last_error());
+                }
+
+                // queue everything before reading anything, so the statements share one round trip
+                PQsetnonblocking(conn, 1);
+
+                for (auto &entry : queue_) {
+                    auto &bindings = entry.second;
+
+                    if (!PQsendQueryParams(conn, entry.first.c_str(), bindings.size(), bindings.types_, bindings.values_, bindings.lengths_,
+                                           bindings.formats_, 0)) {
+                        error = sess_->last_error();
+                        break;
+                    }
+                }
+
+                // without a sync the server may never send the results, so they are only read once it is sent
+                bool sending = PQpipelineSync(conn) == 1 && helper::flush_pipeline(conn);
+
+                PQsetnonblocking(conn, 0);
+
+                bool synced = false;
+
+                // read until the sync, even after an error, or the connection can not leave pipeline mode
+                for (int nulls = 0; sending && nulls < 2 && PQstatus(conn) == CONNECTION_OK;) {
+                    PGresult *res = PQgetResult(conn);
+
+                    // each statement's results end with a null, and two in a row means nothing more is coming
+                    if (res == nullptr) {
+                        nulls++;
+                        continue;
+                    }
+
+                    nulls = 0;
+
+                    ExecStatusType status = PQresultStatus(res);
+
+                    if (status == PGRES_PIPELINE_SYNC) {
+                        PQclear(res);
+                        synced = true;
+                        break;
+                    }
+
+                    switch (status) {
+                        case PGRES_COMMAND_OK:
+                        case PGRES_TUPLES_OK:
+                            changes.push_back(atoi(PQcmdTuples(res)));
+                            break;
+                        case PGRES_PIPELINE_ABORTED:
+                            // skipped because of an earlier error
+                            changes.push_back(0);
+                            break;
+                        default:
+                            if (error.empty()) {
+                                error = PQresultErrorMessage(res);
+                            }
+                            changes.push_back(0);
+                            break;
+                    }
+
+                    PQclear(res);
+                }
+
+                if (!synced && error.empty()) {
+                    error = sess_->last_error();
+                }
+
+                // a connection left in pipeline mode can not run anything else, so start over with a new one
+                if (!PQexitPipelineMode(conn)) {
+                    log::error("unable to exit pipeline mode, resetting the connection: %s", sess_->last_error().c_str());
+
+                    // through the session, so its prepared statement cache is cleared with the connection
+                    try {
+                        sess_->reset();
+                    } catch (const database_exception &e) {
+                        log::error("unable to reset the connection: %s", e.what());
+                    }
+                }
+#else
+                // without pipeline support, run a round trip per statement in a transaction, so a failure still discards all of them
+                bool ownsTransaction = !sess_->in_transaction();
+
+                if (ownsTransaction && !sess_->execute("BEGIN")) {
+                    throw database_exception(sess_->last_error());
+                }
+
+                for (auto &entry : queue_) {
+                    auto &bindings = entry.second;
+
+                    PGresult *res = PQexecParams(conn, entry.first.c_str(), bindings.size(), bindings.types_, bindings.values_, bindings.lengths_,
+                                                 bindings.formats_, 0);
+
+                    if (PQresultStatus(res) != PGRES_COMMAND_OK && PQresultStatus(res) != PGRES_TUPLES_OK) {
+                        error = PQresultErrorMessage(res);
+                        PQclear(res);
+                        break;
+                    }
+
+                    changes.push_back(atoi(PQcmdTuples(res)));
+
+                    PQclear(res);
+                }
+
+                if (ownsTransaction && !sess_->execute(error.empty() ? "COMMIT" : "ROLLBACK") && error.empty()) {
+                    error = sess_->last_error();
+                }
+#endif
+
+                queue_.clear();
+
+                if (!error.empty()) {
+                    throw database_exception(error);
+                }
+
+                return changes;
+            }
+        }
+    }
+}
+
+#endif
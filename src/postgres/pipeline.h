@@ -0,0 +1,92 @@
+/*!
+ * @file pipeline.h
+ * sends many postgres statements without waiting on each result
+ */
+#ifndef RJ_DB_POSTGRES_PIPELINE_H
+#define RJ_DB_POSTGRES_PIPELINE_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBPQ
+
+#include <libpq-fe.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../modify_query.h"
+#include "binding.h"
+
+namespace rj
+{
+    namespace db
+    {
+        namespace postgres
+        {
+            class session;
+
+            /*!
+             * queues statements and sends them together in pipeline mode, so they cost about one round trip
+             * the queued statements run in one implicit transaction, so a failure discards all of them
+             * without pipeline support in libpq they are sent one at a time, in a transaction of their own if none is open
+             */
+            class pipeline
+            {
+               private:
+                std::shared_ptr<postgres::session> sess_;
+                std::vector<std::pair<std::string, binding>> queue_;
+
+               public:
+                /*!
+                 * @param sess the session to execute on
+                 */
+                pipeline(const std::shared_ptr<postgres::session> &sess);
+
+                /* non-copyable boilerplate */
+                pipeline(const pipeline &other) = delete;
+                pipeline(pipeline &&other);
+                pipeline &operator=(const pipeline &other) = delete;
+                pipeline &operator=(pipeline &&other);
+                virtual ~pipeline();
+
+                /*!
+                 * queues an insert, update or delete with its bound values
+                 * @param query the query to queue
+                 * @return a reference to this instance
+                 */
+                pipeline &add(const modify_query &query);
+
+                /*!
+                 * queues a sql statement
+                 * @param sql the sql to execute
+                 * @param values the indexed values to bind
+                 * @return a reference to this instance
+                 */
+                pipeline &add(const std::string &sql, const std::vector<sql_value> &values = {});
+
+                /*!
+                 * sends all queued statements and waits for their results
+                 * @return the number of changes made by each statement, in the order they were queued
+                 * @throws database_exception if any statement fails
+                 */
+                std::vector<int> execute();
+
+                /*!
+                 * @return the number of queued statements
+                 */
+                size_t size() const;
+
+                /*!
+                 * discards the queued statements
+                 */
+                void clear();
+            };
+        }
+    }
+}
+
+#endif
+
+#endif
@@ -1,6 +1,9 @@
 #include "resultset.h"
+#include "../log.h"
+#include "binding.h"
 #include "row.h"
 #include "session.h"
+#include "statement.h"
 
 #ifdef HAVE_LIBPQ
 
@@ -64,9 +67,276 @@ namespace rj
                 currentRow_ = -1;
             }
 
+            long long resultset::row_count()
+            {
+                if (!is_valid()) {
+                    return 0;
+                }
+
+                return PQntuples(stmt_.get());
+            }
+
+            size_t resultset::column_count() const
+            {
+                if (!is_valid()) {
+                    return 0;
+                }
+
+                return PQnfields(stmt_.get());
+            }
+
+            string resultset::column_name(size_t position) const
+            {
+                if (position >= column_count()) {
+                    throw no_such_column_exception();
+                }
+
+                return PQfname(stmt_.get(), position);
+            }
+
+            sql_value resultset::column_value(size_t position) const
+            {
+                if (position >= column_count() || currentRow_ < 0) {
+                    throw no_such_column_exception();
+                }
+
+                return data_mapper::to_value(PQftype(stmt_.get(), position), PQgetvalue(stmt_.get(), currentRow_, position),
+                                             PQgetlength(stmt_.get(), currentRow_, position), PQfformat(stmt_.get(), position));
+            }
+
             resultset::row_type resultset::current_row()
             {
-                return row_type(make_shared<row>(sess_, stmt_, currentRow_));
+                return row_type(make_shared<row>(sess_, stmt_, currentRow_, names()));
+            }
+
+            const int stream_resultset::CHUNK_SIZE;
+
+            void stream_resultset::set_row_mode(PGconn *conn)
+            {
+#ifdef LIBPQ_HAS_CHUNK_MODE
+                if (PQsetChunkedRowsMode(conn, CHUNK_SIZE)) {
+                    return;
+                }
+#endif
+                if (!PQsetSingleRowMode(conn)) {
+                    log::warn("unable to stream postgres results, they will be read at once");
+                }
+            }
+
+            stream_resultset::stream_resultset(const std::shared_ptr<postgres::session> &sess, PGresult *first)
+                : stmt_(nullptr), sess_(sess), pending_(first), currentRow_(-1), numRows_(0), done_(false)
+            {
+                if (sess_ == nullptr) {
+                    if (pending_ != nullptr) {
+                        PQclear(pending_);
+                    }
+                    throw database_exception("No database provided to postgres resultset");
+                }
+
+                switch (PQresultStatus(pending_)) {
+                    case PGRES_SINGLE_TUPLE:
+                    case PGRES_TUPLES_OK:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+                    case PGRES_TUPLES_CHUNK:
+#endif
+                        break;
+                    default: {
+                        string error = pending_ != nullptr ? PQresultErrorMessage(pending_) : sess_->last_error();
+                        finish();
+                        throw database_exception(error);
+                    }
+                }
+            }
+
+            stream_resultset::stream_resultset(stream_resultset &&other)
+                : stmt_(std::move(other.stmt_)),
+                  sess_(std::move(other.sess_)),
+                  pending_(other.pending_),
+                  currentRow_(other.currentRow_),
+                  numRows_(other.numRows_),
+                  done_(other.done_)
+            {
+                other.stmt_ = nullptr;
+                other.sess_ = nullptr;
+                other.pending_ = nullptr;
+                other.done_ = true;
+            }
+
+            stream_resultset::~stream_resultset()
+            {
+                cancel();
+            }
+
+            stream_resultset &stream_resultset::operator=(stream_resultset &&other)
+            {
+                cancel();
+
+                stmt_ = std::move(other.stmt_);
+                sess_ = std::move(other.sess_);
+                pending_ = other.pending_;
+                currentRow_ = other.currentRow_;
+                numRows_ = other.numRows_;
+                done_ = other.done_;
+
+                other.stmt_ = nullptr;
+                other.sess_ = nullptr;
+                other.pending_ = nullptr;
+                other.done_ = true;
+
+                return *this;
+            }
+
+            void stream_resultset::cancel()
+            {
+                PGconn *conn = sess_ == nullptr ? nullptr : sess_->db_.get();
+
+                // a cancel would abort the transaction of the caller, and once the server is done it could hit the next query instead
+                if (conn != nullptr && !done_ && !sess_->in_transaction() && PQconsumeInput(conn) && PQisBusy(conn)) {
+                    // stop the server from sending the rows nobody will read
+                    PGcancel *cancel = PQgetCancel(conn);
+
+                    if (cancel != nullptr) {
+                        char error[256] = {0};
+                        PQcancel(cancel, error, sizeof(error));
+                        PQfreeCancel(cancel);
+                    }
+                }
+
+                finish();
+            }
+
+            void stream_resultset::finish()
+            {
+                if (pending_ != nullptr) {
+                    PQclear(pending_);
+                    pending_ = nullptr;
+                }
+
+                if (done_ || sess_ == nullptr) {
+                    done_ = true;
+                    return;
+                }
+
+                done_ = true;
+
+                // the connection is busy until every result is read
+                PGresult *res;
+
+                while ((res = PQgetResult(sess_->db_.get())) != nullptr) {
+                    PQclear(res);
+                }
+            }
+
+            bool stream_resultset::is_valid() const
+            {
+                return sess_ != nullptr;
+            }
+
+            bool stream_resultset::next()
+            {
+                if (!is_valid()) {
+                    return false;
+                }
+
+                if (stmt_ != nullptr && currentRow_ + 1 < PQntuples(stmt_.get())) {
+                    currentRow_++;
+                    numRows_++;
+                    return true;
+                }
+
+                if (done_) {
+                    return false;
+                }
+
+                PGresult *res = pending_ != nullptr ? pending_ : PQgetResult(sess_->db_.get());
+
+                pending_ = nullptr;
+
+                if (res == nullptr) {
+                    done_ = true;
+                    return false;
+                }
+
+                switch (PQresultStatus(res)) {
+                    case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+                    case PGRES_TUPLES_CHUNK:
+#endif
+                        stmt_ = shared_ptr<PGresult>(res, helper::res_delete());
+                        currentRow_ = 0;
+                        numRows_++;
+                        return true;
+                    case PGRES_TUPLES_OK:
+                        // the end of the rows, or all of them if the row mode was not set
+                        if (PQntuples(res) > 0) {
+                            stmt_ = shared_ptr<PGresult>(res, helper::res_delete());
+                            currentRow_ = 0;
+                            numRows_++;
+                            finish();
+                            return true;
+                        }
+                        PQclear(res);
+                        finish();
+                        return false;
+                    default: {
+                        string error = PQresultErrorMessage(res);
+                        PQclear(res);
+                        finish();
+                        throw database_exception(error);
+                    }
+                }
+            }
+
+            void stream_resultset::reset()
+            {
+                // the first row is kept so checking for results does not lose it
+                if (numRows_ > 1) {
+                    throw database_exception("streamed postgres results can only be read once");
+                }
+
+                if (numRows_ == 1) {
+                    currentRow_ = -1;
+                    numRows_ = 0;
+                }
+            }
+
+            long long stream_resultset::row_count()
+            {
+                // the rows are still on the server
+                return -1;
+            }
+
+            size_t stream_resultset::column_count() const
+            {
+                if (stmt_ == nullptr) {
+                    return 0;
+                }
+
+                return PQnfields(stmt_.get());
+            }
+
+            string stream_resultset::column_name(size_t position) const
+            {
+                if (position >= column_count()) {
+                    throw no_such_column_exception();
+                }
+
+                return PQfname(stmt_.get(), position);
+            }
+
+            sql_value stream_resultset::column_value(size_t position) const
+            {
+                if (position >= column_count() || currentRow_ < 0) {
+                    throw no_such_column_exception();
+                }
+
+                return data_mapper::to_value(PQftype(stmt_.get(), position), PQgetvalue(stmt_.get(), currentRow_, position),
+                                             PQgetlength(stmt_.get(), currentRow_, position), PQfformat(stmt_.get(), position));
+            }
+
+            stream_resultset::row_type stream_resultset::current_row()
+            {
+                return row_type(make_shared<row>(sess_, stmt_, currentRow_, names()));
             }
         }
     }
@@ -55,6 +55,66 @@ namespace rj
                 row_type current_row();
                 void reset();
                 bool next();
+                long long row_count();
+                size_t column_count() const;
+                std::string column_name(size_t position) const;
+                sql_value column_value(size_t position) const;
+            };
+
+            /*!
+             * a postgres result set that fetches rows from the server as they are read
+             * the rows can only be read once, and the session can not run other queries until they are exhausted
+             */
+            class stream_resultset : public resultset_impl
+            {
+               private:
+                std::shared_ptr<PGresult> stmt_;
+                std::shared_ptr<postgres::session> sess_;
+                PGresult *pending_;
+                int currentRow_;
+                long long numRows_;
+                bool done_;
+
+                void finish();
+
+                /*!
+                 * stops a partly read stream, cancelling it only outside a transaction while the server is still sending
+                 */
+                void cancel();
+
+               public:
+                /*! the number of rows fetched at a time, when chunked rows are supported */
+                constexpr static const int CHUNK_SIZE = 1000;
+
+                /*!
+                 * switches a connection with a query just sent into single row or chunked mode
+                 * @param conn the connection
+                 */
+                static void set_row_mode(PGconn *conn);
+
+                /*!
+                 * @param sess the session the query was sent on
+                 * @param first the first result for the query, owned by this result set
+                 * @throws database_exception if the first result is an error
+                 */
+                stream_resultset(const std::shared_ptr<postgres::session> &sess, PGresult *first);
+
+                /* non-copyable boilerplate */
+                stream_resultset(const stream_resultset &other) = delete;
+                stream_resultset(stream_resultset &&other);
+                virtual ~stream_resultset();
+                stream_resultset &operator=(const stream_resultset &other) = delete;
+                stream_resultset &operator=(stream_resultset &&other);
+
+                /* resultset_impl overrides */
+                bool is_valid() const;
+                row_type current_row();
+                void reset();
+                bool next();
+                long long row_count();
+                size_t column_count() const;
+                std::string column_name(size_t position) const;
+                sql_value column_value(size_t position) const;
             };
         }
     }
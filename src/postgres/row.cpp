@@ -12,8 +12,8 @@ namespace rj
     {
         namespace postgres
         {
-            row::row(const std::shared_ptr<postgres::session> &sess, const shared_ptr<PGresult> &stmt, int row)
-                : row_impl(), stmt_(stmt), sess_(sess), row_(row)
+            row::row(const std::shared_ptr<postgres::session> &sess, const shared_ptr<PGresult> &stmt, int row, const shared_ptr<column_names> &names)
+                : row_impl(), stmt_(stmt), sess_(sess), row_(row), names_(names)
             {
                 if (sess_ == NULL) {
                     throw database_exception("no database provided to postgres row");
@@ -27,7 +27,12 @@ namespace rj
             }
 
             row::row(row &&other)
-                : row_impl(std::move(other)), stmt_(std::move(other.stmt_)), sess_(std::move(other.sess_)), size_(other.size_), row_(other.row_)
+                : row_impl(std::move(other)),
+                  stmt_(std::move(other.stmt_)),
+                  sess_(std::move(other.sess_)),
+                  size_(other.size_),
+                  row_(other.row_),
+                  names_(std::move(other.names_))
             {
                 other.stmt_ = nullptr;
                 other.sess_ = NULL;
@@ -44,6 +49,7 @@ namespace rj
                 sess_ = std::move(other.sess_);
                 size_ = other.size_;
                 row_ = other.row_;
+                names_ = std::move(other.names_);
                 other.stmt_ = nullptr;
                 other.sess_ = NULL;
 
@@ -65,6 +71,16 @@ namespace rj
                     throw no_such_column_exception();
                 }
 
+                if (names_ != nullptr) {
+                    int index = names_->index_of(name);
+
+                    if (index < 0) {
+                        throw no_such_column_exception(name);
+                    }
+
+                    return column(index);
+                }
+
                 for (size_t i = 0; i < size_; i++) {
                     const char *col_name = PQfname(stmt_.get(), i);
 
@@ -33,14 +33,17 @@ namespace rj
                 std::shared_ptr<postgres::session> sess_;
                 size_t size_;
                 int row_;
+                std::shared_ptr<rj::db::column_names> names_;
 
                public:
                 /*!
                  * @param db    the database in use
                  * @param stmt  the query statement result in use
                  * @param row   the row index
+                 * @param names  the column name lookups shared by the results, or nullptr to scan the names
                  */
-                row(const std::shared_ptr<postgres::session> &sess, const std::shared_ptr<PGresult> &stmt, int row);
+                row(const std::shared_ptr<postgres::session> &sess, const std::shared_ptr<PGresult> &stmt, int row,
+                    const std::shared_ptr<rj::db::column_names> &names = nullptr);
 
                 /* non-copyable boilerplate */
                 virtual ~row();
@@ -6,6 +6,7 @@
 
 #include "../schema.h"
 #include "../select_query.h"
+#include "blob_stream.h"
 #include "resultset.h"
 #include "session.h"
 #include "statement.h"
@@ -29,21 +30,62 @@ namespace rj
                         }
                     }
                 };
+
+                /*!
+                 * executes a command that returns no rows
+                 * @return true if it succeeded
+                 */
+                static bool exec_command(PGconn *conn, const char *sql)
+                {
+                    PGresult *res = PQexec(conn, sql);
+
+                    bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+
+                    PQclear(res);
+
+                    return success;
+                }
             }
 
+            const size_t session::DEFAULT_STATEMENT_CACHE_SIZE;
+
             std::shared_ptr<rj::db::session_impl> factory::create(const uri &uri)
             {
                 return std::make_shared<session>(uri);
             }
 
-            session::session(const uri &info) : session_impl(info), db_(nullptr), lastId_(0), lastNumChanges_(0)
+            session::session(const uri &info)
+                : session_impl(info),
+                  db_(nullptr),
+                  connecting_(nullptr),
+                  lastId_(0),
+                  lastNumChanges_(0),
+                  cacheSize_(DEFAULT_STATEMENT_CACHE_SIZE),
+                  cacheHits_(0),
+                  cacheMisses_(0),
+                  cacheCounter_(0),
+                  binaryResults_(true)
             {
             }
 
             session::session(session &&other)
-                : session_impl(std::move(other)), db_(std::move(other.db_)), lastId_(other.lastId_), lastNumChanges_(other.lastNumChanges_)
+                : session_impl(std::move(other)),
+                  db_(std::move(other.db_)),
+                  connecting_(std::move(other.connecting_)),
+                  lastId_(other.lastId_),
+                  lastNumChanges_(other.lastNumChanges_),
+                  cacheSize_(other.cacheSize_),
+                  cacheHits_(other.cacheHits_),
+                  cacheMisses_(other.cacheMisses_),
+                  cacheCounter_(other.cacheCounter_),
+                  binaryResults_(other.binaryResults_),
+                  cacheOrder_(std::move(other.cacheOrder_)),
+                  cache_(std::move(other.cache_))
             {
                 other.db_ = nullptr;
+                other.connecting_ = nullptr;
+                other.cache_.clear();
+                other.cacheOrder_.clear();
             }
 
             session &session::operator=(session &&other)
@@ -51,9 +93,20 @@ namespace rj
                 session_impl::operator=(std::move(other));
 
                 db_ = std::move(other.db_);
+                connecting_ = std::move(other.connecting_);
                 lastId_ = other.lastId_;
                 lastNumChanges_ = other.lastNumChanges_;
+                cacheSize_ = other.cacheSize_;
+                cacheHits_ = other.cacheHits_;
+                cacheMisses_ = other.cacheMisses_;
+                cacheCounter_ = other.cacheCounter_;
+                binaryResults_ = other.binaryResults_;
+                cacheOrder_ = std::move(other.cacheOrder_);
+                cache_ = std::move(other.cache_);
                 other.db_ = nullptr;
+                other.connecting_ = nullptr;
+                other.cache_.clear();
+                other.cacheOrder_.clear();
 
                 return *this;
             }
@@ -79,6 +132,10 @@ namespace rj
                     throw database_exception(errmsg);
                 }
 
+                // a new connection has no prepared statements
+                cache_.clear();
+                cacheOrder_.clear();
+
                 db_ = shared_ptr<PGconn>(conn, helper::close_db());
             }
 
@@ -89,11 +146,33 @@ namespace rj
 
             void session::close()
             {
+                cache_.clear();
+                cacheOrder_.clear();
+
+                connecting_ = nullptr;
+
                 if (db_ != nullptr) {
                     db_ = nullptr;
                 }
             }
 
+            void session::reset()
+            {
+                if (db_ == nullptr) {
+                    return;
+                }
+
+                // prepared statements do not survive a reset
+                cache_.clear();
+                cacheOrder_.clear();
+
+                PQreset(db_.get());
+
+                if (PQstatus(db_.get()) != CONNECTION_OK) {
+                    throw database_exception(last_error());
+                }
+            }
+
             string session::last_error() const
             {
                 if (db_ == nullptr) {
@@ -123,6 +202,203 @@ namespace rj
                 lastNumChanges_ = value;
             }
 
+            bool session::in_transaction() const
+            {
+                if (db_ == nullptr) {
+                    return false;
+                }
+
+                // a failed transaction is still open until it is rolled back
+                auto status = PQtransactionStatus(db_.get());
+
+                return status == PQTRANS_INTRANS || status == PQTRANS_INERROR;
+            }
+
+            void session::set_statement_cache_size(size_t value)
+            {
+                cacheSize_ = value;
+
+                while (cache_.size() > cacheSize_) {
+                    evict_statement();
+                }
+            }
+
+            size_t session::statement_cache_size() const
+            {
+                return cacheSize_;
+            }
+
+            void session::set_binary_results(bool value)
+            {
+                binaryResults_ = value;
+            }
+
+            bool session::binary_results() const
+            {
+                return binaryResults_;
+            }
+
+            unsigned long long session::statement_cache_hits() const
+            {
+                return cacheHits_;
+            }
+
+            unsigned long long session::statement_cache_misses() const
+            {
+                return cacheMisses_;
+            }
+
+            void session::clear_statement_cache()
+            {
+                if (is_open() && !cache_.empty()) {
+                    PGresult *res = PQexec(db_.get(), "DEALLOCATE ALL");
+                    PQclear(res);
+                }
+                cache_.clear();
+                cacheOrder_.clear();
+            }
+
+            bool session::describes_binary(const string &name)
+            {
+                PGresult *res = PQdescribePrepared(db_.get(), name.c_str());
+
+                bool binary = PQresultStatus(res) == PGRES_COMMAND_OK;
+
+                for (int i = 0; binary && i < PQnfields(res); i++) {
+                    binary = data_mapper::decodes_binary(PQftype(res, i));
+                }
+
+                PQclear(res);
+
+                return binary;
+            }
+
+            string session::cache_statement(const string &sql, int size, const Oid *types, int &format)
+            {
+                // without a description of the columns, the results are read as text
+                format = 0;
+
+                if (cacheSize_ == 0 || db_ == nullptr) {
+                    return string();
+                }
+
+                // a connection that was dropped has lost its prepared statements
+                if (PQstatus(db_.get()) != CONNECTION_OK) {
+                    cache_.clear();
+                    cacheOrder_.clear();
+                    return string();
+                }
+
+                // the parameter types are part of the prepared statement, so they are part of the key
+                string key = sql;
+
+                key.push_back('\0');
+
+                for (int i = 0; i < size; i++) {
+                    key += std::to_string(types[i]);
+                    key.push_back(',');
+                }
+
+                auto it = cache_.find(key);
+
+                if (it != cache_.end()) {
+                    ++cacheHits_;
+                    cacheOrder_.splice(cacheOrder_.begin(), cacheOrder_, it->second.order);
+
+                    if (binaryResults_) {
+                        // described once, the first time binary results are wanted
+                        if (it->second.binary == -1) {
+                            it->second.binary = describes_binary(it->second.name) ? 1 : 0;
+                        }
+                        format = it->second.binary;
+                    }
+                    return it->second.name;
+                }
+
+                ++cacheMisses_;
+
+                auto status = PQtransactionStatus(db_.get());
+
+                // an aborted transaction fails everything until it is rolled back, so leave the error to the caller
+                if (status == PQTRANS_INERROR) {
+                    return string();
+                }
+
+                // a failed prepare would abort the transaction, so it is tried in a savepoint
+                bool savepoint = status == PQTRANS_INTRANS && helper::exec_command(db_.get(), "SAVEPOINT rj_prepare");
+
+                if (status == PQTRANS_INTRANS && !savepoint) {
+                    return string();
+                }
+
+                string name = "rj_stmt_" + std::to_string(++cacheCounter_);
+
+                PGresult *res = PQprepare(db_.get(), name.c_str(), sql.c_str(), size, types);
+
+                bool error = PQresultStatus(res) != PGRES_COMMAND_OK;
+
+                PQclear(res);
+
+                if (savepoint) {
+                    if (error) {
+                        helper::exec_command(db_.get(), "ROLLBACK TO SAVEPOINT rj_prepare");
+                    }
+                    helper::exec_command(db_.get(), "RELEASE SAVEPOINT rj_prepare");
+                }
+
+                if (error) {
+                    // let the caller execute unprepared so the error is reported normally
+                    return string();
+                }
+
+                while (!cacheOrder_.empty() && cache_.size() >= cacheSize_) {
+                    evict_statement();
+                }
+
+                cacheOrder_.push_front(key);
+
+                int binary = -1;
+
+                if (binaryResults_) {
+                    binary = describes_binary(name) ? 1 : 0;
+                    format = binary;
+                }
+
+                cache_[key] = cached_statement{name, cacheOrder_.begin(), binary};
+
+                return name;
+            }
+
+            void session::evict_statement()
+            {
+                if (cacheOrder_.empty()) {
+                    return;
+                }
+
+                auto it = cache_.find(cacheOrder_.back());
+
+                if (it != cache_.end()) {
+                    if (is_open() && PQstatus(db_.get()) == CONNECTION_OK) {
+                        PGresult *res = PQexec(db_.get(), ("DEALLOCATE " + it->second.name).c_str());
+                        PQclear(res);
+                    }
+                    cache_.erase(it);
+                }
+
+                cacheOrder_.pop_back();
+            }
+
+            void session::uncache_statement(const string &name)
+            {
+                for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+                    if (it->second.name == name) {
+                        cacheOrder_.erase(it->second.order);
+                        cache_.erase(it);
+                        return;
+                    }
+                }
+            }
+
             std::shared_ptr<resultset_impl> session::query(const string &sql)
             {
                 if (db_ == nullptr) {
@@ -138,6 +414,154 @@ namespace rj
                 return make_shared<resultset>(shared_from_this(), shared_ptr<PGresult>(res, helper::res_delete()));
             }
 
+            std::shared_ptr<resultset_impl> session::stream(const string &sql)
+            {
+                if (db_ == nullptr) {
+                    throw database_exception("database is not open");
+                }
+
+                if (!PQsendQuery(db_.get(), sql.c_str())) {
+                    throw database_exception(last_error());
+                }
+
+                stream_resultset::set_row_mode(db_.get());
+
+                return make_shared<stream_resultset>(shared_from_this(), PQgetResult(db_.get()));
+            }
+
+            bool session::start_open()
+            {
+                if (db_ != nullptr || connecting_ != nullptr) {
+                    return true;
+                }
+
+                PGconn *conn = PQconnectStart(connection_info().value.c_str());
+
+                if (conn == nullptr) {
+                    throw database_exception("unable to allocate postgres connection");
+                }
+
+                if (PQstatus(conn) == CONNECTION_BAD) {
+                    std::string errmsg = PQerrorMessage(conn);
+                    PQfinish(conn);
+                    throw database_exception(errmsg);
+                }
+
+                connecting_ = shared_ptr<PGconn>(conn, helper::close_db());
+
+                return true;
+            }
+
+            session::open_state session::poll_open()
+            {
+                if (db_ != nullptr) {
+                    return OpenReady;
+                }
+
+                if (connecting_ == nullptr) {
+                    open();
+                    return OpenReady;
+                }
+
+                switch (PQconnectPoll(connecting_.get())) {
+                    case PGRES_POLLING_READING:
+                        return OpenReading;
+                    case PGRES_POLLING_WRITING:
+                        return OpenWriting;
+                    case PGRES_POLLING_OK:
+                        // a new connection has no prepared statements
+                        cache_.clear();
+                        cacheOrder_.clear();
+                        db_ = std::move(connecting_);
+                        connecting_ = nullptr;
+                        return OpenReady;
+                    default: {
+                        std::string errmsg = PQerrorMessage(connecting_.get());
+                        connecting_ = nullptr;
+                        throw database_exception(errmsg);
+                    }
+                }
+            }
+
+            int session::socket() const
+            {
+                if (db_ != nullptr) {
+                    return PQsocket(db_.get());
+                }
+
+                if (connecting_ != nullptr) {
+                    return PQsocket(connecting_.get());
+                }
+
+                return -1;
+            }
+
+            bool session::send_query(const string &sql)
+            {
+                if (db_ == nullptr) {
+                    throw database_exception("database is not open");
+                }
+
+                if (!PQsendQuery(db_.get(), sql.c_str())) {
+                    throw database_exception(last_error());
+                }
+
+                return true;
+            }
+
+            bool session::consume_input()
+            {
+                if (db_ == nullptr) {
+                    throw database_exception("database is not open");
+                }
+
+                if (!PQconsumeInput(db_.get())) {
+                    throw database_exception(last_error());
+                }
+
+                return !PQisBusy(db_.get());
+            }
+
+            std::shared_ptr<resultset_impl> session::get_results()
+            {
+                if (db_ == nullptr) {
+                    throw database_exception("database is not open");
+                }
+
+                PGresult *res = last_result();
+
+                if (res == nullptr) {
+                    throw database_exception("no query was sent");
+                }
+
+                if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
+                    string error = PQresultErrorMessage(res);
+                    PQclear(res);
+                    throw database_exception(error);
+                }
+
+                return make_shared<resultset>(shared_from_this(), shared_ptr<PGresult>(res, helper::res_delete()));
+            }
+
+            PGresult *session::last_result()
+            {
+                PGresult *res = nullptr, *next = nullptr;
+
+                // keep the last result or the first error, as PQexec would
+                while ((next = PQgetResult(db_.get())) != nullptr) {
+                    if (res != nullptr && PQresultStatus(res) == PGRES_FATAL_ERROR) {
+                        PQclear(next);
+                        continue;
+                    }
+                    if (res != nullptr) {
+                        PQclear(res);
+                    }
+                    res = next;
+                }
+
+                return res;
+            }
+
             bool session::execute(const string &sql)
             {
                 if (db_ == nullptr) {
@@ -155,7 +579,7 @@ namespace rj
 
             shared_ptr<rj::db::session::statement_type> session::create_statement()
             {
-                return make_shared<statement>(static_pointer_cast<postgres::session>(shared_from_this()));
+                return make_shared<statement>(shared_from_this());
             }
 
             shared_ptr<transaction_impl> session::create_transaction() const
@@ -168,7 +592,7 @@ namespace rj
                 return make_shared<postgres::transaction>(db_, mode);
             }
 
-            string session::insert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns) const
+            string session::insert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns, size_t rows) const
             {
                 if (schema == nullptr) {
                     return string();
@@ -182,30 +606,84 @@ namespace rj
 
                 buf << rj::db::helper::join_csv(columns);
 
-                buf << ") VALUES(";
+                buf << ") VALUES";
+
+                buf << rj::db::helper::join_values(columns, rows);
+
+                auto keys = schema->primary_keys();
+
+                if (!keys.empty()) {
+                    buf << " RETURNING " << rj::db::helper::join_csv(keys);
+                }
+
+                buf << ";";
 
-                buf << rj::db::helper::join_params(columns, false);
+                return buf.str();
+            }
+            string session::upsert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns, size_t rows) const
+            {
+                if (schema == nullptr) {
+                    return string();
+                }
 
-                buf << ")";
+                ostringstream buf;
 
                 auto keys = schema->primary_keys();
 
-                auto it = keys.begin();
+                buf << "INSERT INTO " << schema->table_name();
+
+                buf << "(";
+
+                buf << rj::db::helper::join_csv(columns);
+
+                buf << ") VALUES";
 
-                if (it != keys.end()) {
-                    buf << " RETURNING ";
+                buf << rj::db::helper::join_values(columns, rows);
 
-                    while (it < keys.end() - 1) {
-                        buf << *it << ",";
+                if (!keys.empty()) {
+                    auto assignments = rj::db::helper::join_assignments(columns, keys, "EXCLUDED.");
+
+                    buf << " ON CONFLICT(" << rj::db::helper::join_csv(keys) << ") DO ";
+
+                    if (assignments.empty()) {
+                        buf << "NOTHING";
+                    } else {
+                        buf << "UPDATE SET " << assignments;
                     }
 
-                    buf << *it;
+                    buf << " RETURNING " << rj::db::helper::join_csv(keys);
                 }
 
                 buf << ";";
 
                 return buf.str();
             }
+
+            size_t session::max_parameters() const
+            {
+                // the bind message uses a 16 bit parameter count
+                return 65535;
+            }
+
+            bool session::reports_insert_ids() const
+            {
+                // inserts return the primary keys of every row
+                return true;
+            }
+
+            std::shared_ptr<rj::db::blob_reader> session::open_blob_reader(const std::shared_ptr<schema> &schema, const string &column,
+                                                                           const sql_value &id)
+            {
+                return make_shared<postgres::blob_reader>(shared_from_this(), schema, column, id);
+            }
+
+            std::shared_ptr<rj::db::blob_writer> session::open_blob_writer(const std::shared_ptr<schema> &schema, const string &column,
+                                                                           const sql_value &id, size_t size)
+            {
+                // bytea values grow as they are written
+                return make_shared<postgres::blob_writer>(shared_from_this(), schema, column, id);
+            }
+
             void session::query_schema(const string &dbName, const string &tableName, std::vector<column_definition> &columns)
             {
                 if (!is_open()) return;
@@ -12,6 +12,8 @@
 #ifdef HAVE_LIBPQ
 
 #include <libpq-fe.h>
+#include <list>
+#include <unordered_map>
 #include "../session.h"
 #include "../session_factory.h"
 #include "transaction.h"
@@ -35,11 +37,19 @@ namespace rj
             {
                 friend class statement;
                 friend class factory;
+                friend class bulk_loader;
+                friend class pipeline;
+                friend class stream_resultset;
+                friend class blob_writer;
 
                protected:
                 std::shared_ptr<PGconn> db_;
+                std::shared_ptr<PGconn> connecting_;
 
                public:
+                /*! the default number of prepared statements kept per connection */
+                constexpr static const size_t DEFAULT_STATEMENT_CACHE_SIZE = 64;
+
                 /*!
                  * @param info the connection uri
                  */
@@ -65,13 +75,129 @@ namespace rj
                 std::shared_ptr<transaction_impl> create_transaction() const;
                 std::shared_ptr<transaction_impl> create_transaction(const transaction::mode &mode) const;
                 void query_schema(const std::string &dbName, const std::string &tablename, std::vector<column_definition> &columns);
-                std::string insert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns) const;
+                std::string insert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns, size_t rows = 1) const;
+                std::string upsert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns, size_t rows = 1) const;
+                size_t max_parameters() const;
+                bool reports_insert_ids() const;
+                bool in_transaction() const;
+                std::shared_ptr<rj::db::blob_reader> open_blob_reader(const std::shared_ptr<schema> &schema, const std::string &column,
+                                                                      const sql_value &id);
+                std::shared_ptr<rj::db::blob_writer> open_blob_writer(const std::shared_ptr<schema> &schema, const std::string &column,
+                                                                      const sql_value &id, size_t size);
+
+                /*!
+                 * sets the number of server side prepared statements to keep per connection
+                 * @param value the capacity, zero disables the cache
+                 */
+                void set_statement_cache_size(size_t value);
+
+                /*!
+                 * @return the number of server side prepared statements kept per connection
+                 */
+                size_t statement_cache_size() const;
+
+                /*!
+                 * @return the number of executions that reused a prepared statement
+                 */
+                unsigned long long statement_cache_hits() const;
+
+                /*!
+                 * @return the number of executions that had to prepare a statement
+                 */
+                unsigned long long statement_cache_misses() const;
+
+                /*!
+                 * sets if statements request their results in the binary format
+                 * only cached prepared statements whose columns are all decoded from the binary format use it,
+                 * other statements and queries read their results as text
+                 * @param value true for binary results, false for text results
+                 */
+                void set_binary_results(bool value);
+
+                /*!
+                 * @return true if statements request their results in the binary format
+                 */
+                bool binary_results() const;
+
+                /*!
+                 * forgets all cached prepared statements, deallocating them if the connection is open
+                 */
+                void clear_statement_cache();
+
+                /*!
+                 * executes a sql statement, fetching the results from the server as they are read
+                 * @param  sql the sql string to execute
+                 * @return     the results of the query, readable once
+                 */
+                std::shared_ptr<resultset_impl> stream(const std::string &sql);
+
+                /*!
+                 * resets the connection to the server, invalidating cached statements
+                 */
+                void reset();
+
+                /* asynchronous overrides */
+                bool start_open();
+                open_state poll_open();
+                int socket() const;
+                bool send_query(const std::string &sql);
+                bool consume_input();
+                std::shared_ptr<resultset_impl> get_results();
 
                private:
+                typedef std::list<std::string> cache_order_type;
+
+                struct cached_statement {
+                    std::string name;
+                    cache_order_type::iterator order;
+                    /*! one if every result column is decoded from the binary format, zero if not, -1 until described */
+                    int binary;
+                };
+
                 long long lastId_;
                 int lastNumChanges_;
+                size_t cacheSize_;
+                unsigned long long cacheHits_;
+                unsigned long long cacheMisses_;
+                unsigned long long cacheCounter_;
+                bool binaryResults_;
+                cache_order_type cacheOrder_;
+                std::unordered_map<std::string, cached_statement> cache_;
                 void set_last_insert_id(long long value);
                 void set_last_number_of_changes(int value);
+
+                /*!
+                 * reads every result of a sent query, waiting for them if needed
+                 * @return the last result or the first error, or nullptr if no query was sent
+                 */
+                PGresult *last_result();
+
+                /*!
+                 * gets or creates a server side prepared statement
+                 * @param sql the sql to prepare
+                 * @param size the number of parameters
+                 * @param types the parameter types
+                 * @param format set to the result format the statement should request
+                 * @return the prepared statement name or an empty string if it could not be prepared
+                 */
+                std::string cache_statement(const std::string &sql, int size, const Oid *types, int &format);
+
+                /*!
+                 * tests if every result column of a prepared statement is decoded from the binary format
+                 * @param name the prepared statement name
+                 */
+                bool describes_binary(const std::string &name);
+
+                /*!
+                 * deallocates the least recently used prepared statement
+                 */
+                void evict_statement();
+
+                /*!
+                 * forgets a prepared statement that the server no longer knows about
+                 * @param name the prepared statement name
+                 */
+                void uncache_statement(const std::string &name);
             };
         }
     }
@@ -1,6 +1,7 @@
 
 #include "statement.h"
 #include <algorithm>
+#include <cstring>
 #include "../log.h"
 #include "resultset.h"
 #include "session.h"
@@ -23,8 +24,22 @@ namespace rj
                         PQclear(p);
                     }
                 }
+
+                /*!
+                 * reads a generated id in either result format
+                 */
+                static long long to_id(PGresult *res, int row)
+                {
+                    auto value = data_mapper::to_value(PQftype(res, 0), PQgetvalue(res, row, 0), PQgetlength(res, row, 0), PQfformat(res, 0));
+
+                    try {
+                        return value.to_llong();
+                    } catch (const std::exception &e) {
+                        return 0;
+                    }
+                }
             }
-            statement::statement(const std::shared_ptr<postgres::session> &sess) : sess_(sess), stmt_(nullptr)
+            statement::statement(const std::shared_ptr<postgres::session> &sess) : sess_(sess), stmt_(nullptr), sent_(false)
             {
                 if (sess_ == nullptr) {
                     throw database_exception("no database provided to postgres statement");
@@ -32,8 +47,13 @@ namespace rj
             }
 
             statement::statement(statement &&other)
-                : sess_(std::move(other.sess_)), stmt_(std::move(other.stmt_)), bindings_(std::move(other.bindings_)), sql_(std::move(other.sql_))
+                : sess_(std::move(other.sess_)),
+                  stmt_(std::move(other.stmt_)),
+                  bindings_(std::move(other.bindings_)),
+                  sql_(std::move(other.sql_)),
+                  sent_(other.sent_)
             {
+                other.sent_ = false;
                 other.stmt_ = nullptr;
                 other.sess_ = nullptr;
             }
@@ -44,7 +64,9 @@ namespace rj
                 stmt_ = std::move(other.stmt_);
                 bindings_ = std::move(other.bindings_);
                 sql_ = std::move(other.sql_);
+                sent_ = other.sent_;
 
+                other.sent_ = false;
                 other.stmt_ = nullptr;
                 other.sess_ = nullptr;
                 other.sql_.clear();
@@ -164,14 +186,137 @@ namespace rj
                 return *this;
             }
 
+            PGresult *statement::execute()
+            {
+                // the results of a sent query are read instead of executing it again
+                if (sent_) {
+                    sent_ = false;
+                    return sess_->last_result();
+                }
+
+                int resultFormat = 0;
+
+                auto name = sess_->cache_statement(sql_, bindings_.size(), bindings_.types_, resultFormat);
+
+                if (name.empty()) {
+                    return PQexecParams(sess_->db_.get(), sql_.c_str(), bindings_.size(), bindings_.types_, bindings_.values_, bindings_.lengths_,
+                                        bindings_.formats_, resultFormat);
+                }
+
+                PGresult *res =
+                    PQexecPrepared(sess_->db_.get(), name.c_str(), bindings_.size(), bindings_.values_, bindings_.lengths_, bindings_.formats_, resultFormat);
+
+                const char *state = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+
+                // the server lost the prepared statement (ex. DISCARD ALL), so forget it and run unprepared
+                if (state != nullptr && strcmp(state, "26000") == 0) {
+                    sess_->uncache_statement(name);
+
+                    // the failure aborted the transaction, so running it again would only fail again
+                    if (PQtransactionStatus(sess_->db_.get()) != PQTRANS_IDLE) {
+                        return res;
+                    }
+
+                    PQclear(res);
+
+                    // the columns of an unprepared statement are not described
+                    resultFormat = 0;
+
+                    return PQexecParams(sess_->db_.get(), sql_.c_str(), bindings_.size(), bindings_.types_, bindings_.values_, bindings_.lengths_,
+                                        bindings_.formats_, resultFormat);
+                }
+
+                return res;
+            }
+
+            PGresult *statement::send()
+            {
+                PGconn *conn = sess_->db_.get();
+
+                int resultFormat = 0;
+
+                auto name = sess_->cache_statement(sql_, bindings_.size(), bindings_.types_, resultFormat);
+
+                int sent = name.empty() ? PQsendQueryParams(conn, sql_.c_str(), bindings_.size(), bindings_.types_, bindings_.values_,
+                                                             bindings_.lengths_, bindings_.formats_, resultFormat)
+                                        : PQsendQueryPrepared(conn, name.c_str(), bindings_.size(), bindings_.values_, bindings_.lengths_,
+                                                              bindings_.formats_, resultFormat);
+
+                if (!sent) {
+                    throw database_exception(last_error());
+                }
+
+                stream_resultset::set_row_mode(conn);
+
+                PGresult *res = PQgetResult(conn);
+
+                const char *state = res != nullptr ? PQresultErrorField(res, PG_DIAG_SQLSTATE) : nullptr;
+
+                // the server lost the prepared statement, so forget it and send unprepared
+                if (!name.empty() && state != nullptr && strcmp(state, "26000") == 0) {
+                    PGresult *rest;
+
+                    while ((rest = PQgetResult(conn)) != nullptr) {
+                        PQclear(rest);
+                    }
+
+                    sess_->uncache_statement(name);
+
+                    // the failure aborted the transaction, so sending it again would only fail again
+                    if (PQtransactionStatus(conn) != PQTRANS_IDLE) {
+                        return res;
+                    }
+
+                    PQclear(res);
+
+                    resultFormat = 0;
+
+                    if (!PQsendQueryParams(conn, sql_.c_str(), bindings_.size(), bindings_.types_, bindings_.values_, bindings_.lengths_,
+                                           bindings_.formats_, resultFormat)) {
+                        throw database_exception(last_error());
+                    }
+
+                    stream_resultset::set_row_mode(conn);
+
+                    res = PQgetResult(conn);
+                }
+
+                return res;
+            }
+
+            bool statement::send_query()
+            {
+                if (sess_ == nullptr) {
+                    throw database_exception("statement::send_query invalid database");
+                }
+
+                // sent unprepared, as a prepared statement lost by the server could not be retried once sent
+                if (!PQsendQueryParams(sess_->db_.get(), sql_.c_str(), bindings_.size(), bindings_.types_, bindings_.values_, bindings_.lengths_,
+                                       bindings_.formats_, 0)) {
+                    throw database_exception(last_error());
+                }
+
+                sent_ = true;
+
+                return true;
+            }
+
+            statement::resultset_type statement::stream_results()
+            {
+                if (sess_ == nullptr) {
+                    throw database_exception("statement::results invalid database");
+                }
+
+                return resultset_type(make_shared<stream_resultset>(sess_, send()));
+            }
+
             statement::resultset_type statement::results()
             {
                 if (sess_ == nullptr) {
                     throw database_exception("statement::results invalid database");
                 }
 
-                PGresult *res = PQexecParams(sess_->db_.get(), sql_.c_str(), bindings_.size(), bindings_.types_, bindings_.values_,
-                                             bindings_.lengths_, bindings_.formats_, 0);
+                PGresult *res = execute();
 
                 if (PQresultStatus(res) != PGRES_TUPLES_OK) {
                     throw database_exception(last_error());
@@ -188,8 +333,7 @@ namespace rj
                     throw database_exception("statement::results invalid database");
                 }
 
-                PGresult *res = PQexecParams(sess_->db_.get(), sql_.c_str(), bindings_.size(), bindings_.types_, bindings_.values_,
-                                             bindings_.lengths_, bindings_.formats_, 0);
+                PGresult *res = execute();
 
                 if (PQresultStatus(res) != PGRES_COMMAND_OK && PQresultStatus(res) != PGRES_TUPLES_OK) {
                     PQclear(res);
@@ -232,19 +376,32 @@ namespace rj
                 if (PQntuples(stmt_.get()) <= 0) {
                     return value;
                 }
-                auto val = PQgetvalue(stmt_.get(), 0, 0);
-                if (val != nullptr) {
-                    try {
-                        value = stoll(val);
-                    } catch (const std::exception &e) {
-                        value = 0;
-                    }
-                }
+                value = helper::to_id(stmt_.get(), 0);
 
                 sess_->set_last_insert_id(value);
 
                 return value;
             }
+
+            vector<long long> statement::last_insert_ids()
+            {
+                vector<long long> values;
+
+                if (stmt_ == nullptr) {
+                    return values;
+                }
+
+                // each row returned by an insert holds its primary key, and a null key is kept as zero so rows stay in place
+                for (int i = 0; i < PQntuples(stmt_.get()); i++) {
+                    values.push_back(PQgetisnull(stmt_.get(), i, 0) ? 0 : helper::to_id(stmt_.get(), i));
+                }
+
+                if (!values.empty()) {
+                    sess_->set_last_insert_id(values.back());
+                }
+
+                return values;
+            }
         }
     }
 }
@@ -33,6 +33,19 @@ namespace rj
                 std::shared_ptr<PGresult> stmt_;
                 binding bindings_;
                 std::string sql_;
+                bool sent_;
+
+                /*!
+                 * executes the sql, using a cached server side prepared statement when possible
+                 * @return the raw result
+                 */
+                PGresult *execute();
+
+                /*!
+                 * sends the sql without waiting for all the results, for streaming
+                 * @return the first result
+                 */
+                PGresult *send();
 
                public:
                 /*!
@@ -50,13 +63,16 @@ namespace rj
                 /* statement overrides */
                 void prepare(const std::string &sql);
                 bool is_valid() const;
+                bool send_query();
                 resultset_type results();
+                resultset_type stream_results();
                 bool result();
                 void finish();
                 void reset();
                 int last_number_of_changes();
                 std::string last_error();
                 long long last_insert_id();
+                std::vector<long long> last_insert_ids();
 
                 /* bindable overrides */
                 statement &bind(size_t index, int value);
@@ -3,6 +3,7 @@
  * @copyright ryan jennings (ryan-jennings.net), 2013
  */
 #include "query.h"
+#include <algorithm>
 #include <cassert>
 #include "exception.h"
 #include "log.h"
@@ -39,6 +40,50 @@ namespace rj
                 }
                 return buf.str();
             }
+
+            string join_values(const vector<string> &columns, size_t rows)
+            {
+                ostringstream buf;
+
+                size_t index = 1;
+
+                for (size_t row = 0; row < rows; row++) {
+                    if (row > 0) {
+                        buf.put(',');
+                    }
+
+                    buf.put('(');
+
+                    for (string::size_type i = 0; i < columns.size(); i++) {
+                        if (i > 0) {
+                            buf.put(',');
+                        }
+                        buf.put('$');
+                        buf << index++;
+                    }
+
+                    buf.put(')');
+                }
+                return buf.str();
+            }
+
+            string join_assignments(const vector<string> &columns, const vector<string> &keys, const string &prefix, const string &suffix)
+            {
+                ostringstream buf;
+
+                for (auto &column : columns) {
+                    if (find(keys.begin(), keys.end(), column) != keys.end()) {
+                        continue;
+                    }
+
+                    if (buf.tellp() > 0) {
+                        buf.put(',');
+                    }
+
+                    buf << column << " = " << prefix << column << suffix;
+                }
+                return buf.str();
+            }
         }
         query::query(const std::shared_ptr<rj::db::session> &session)
             : is_dirty_(false), session_(session), stmt_(nullptr), params_(), named_params_()
@@ -110,17 +155,25 @@ namespace rj
                 return;
             }
 
-            for (size_t i = 1; i <= params_.size(); i++) {
-                auto &value = params_[i - 1];
+            bind_params(*stmt_);
+
+            is_dirty_ = false;
+        }
+
+        size_t query::bound_params() const
+        {
+            return params_.size();
+        }
 
-                stmt_->bind_value(i, value);
+        void query::bind_params(bindable &other) const
+        {
+            for (size_t i = 1; i <= params_.size(); i++) {
+                other.bind_value(i, params_[i - 1]);
             }
 
             for (auto &it : named_params_) {
-                stmt_->bind(it.first, it.second);
+                other.bind(it.first, it.second);
             }
-
-            is_dirty_ = false;
         }
 
         size_t query::assert_binding_index(size_t index)
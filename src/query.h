@@ -112,6 +112,17 @@ namespace rj
             query &bind(size_t index, const sql_time &value);
             query &bind(const std::string &name, const sql_value &value);
 
+            /*!
+             * @return the number of indexed parameters bound to this query
+             */
+            size_t bound_params() const;
+
+            /*!
+             * binds the parameters of this query to another bindable, such as a statement executed elsewhere
+             * @param other the bindable to bind to
+             */
+            void bind_params(bindable &other) const;
+
             /*!
              * returns the last error the query encountered, if any
              */
@@ -147,6 +158,23 @@ namespace rj
             }
 
             std::string join_params(const std::vector<std::string> &columns, bool update);
+
+            /*!
+             * utility method used in creating multi row insert sql
+             * @return the parameter tuples, ex. ($1,$2),($3,$4)
+             */
+            std::string join_values(const std::vector<std::string> &columns, size_t rows);
+
+            /*!
+             * utility method used in creating upsert sql
+             * @param columns the columns to assign
+             * @param keys the key columns to leave out
+             * @param prefix the text before the column in each value, ex. excluded.
+             * @param suffix the text after the column in each value
+             * @return the assignments, ex. a = excluded.a,b = excluded.b
+             */
+            std::string join_assignments(const std::vector<std::string> &columns, const std::vector<std::string> &keys, const std::string &prefix,
+                                         const std::string &suffix = std::string());
         }
     }
 }
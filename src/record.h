@@ -7,12 +7,17 @@
 #define RJ_DB_BASE_RECORD_H
 
 #include <algorithm>
+#include <functional>
+#include <map>
 #include <memory>
+#include <sstream>
 #include "delete_query.h"
+#include "identity_map.h"
 #include "insert_query.h"
 #include "schema.h"
 #include "select_query.h"
 #include "session.h"
+#include "transaction.h"
 #include "update_query.h"
 
 namespace rj
@@ -22,6 +27,43 @@ namespace rj
         template <typename T>
         class record;
 
+        namespace helper
+        {
+            /*!
+             * creates a record from a row, or reuses the instance already loaded for its primary key
+             * @param schema the schema of the record
+             * @param values the row to load
+             * @return the record
+             */
+            template <typename T>
+            inline std::shared_ptr<T> materialize(const std::shared_ptr<schema> &schema, const row &values)
+            {
+                auto identities = schema->get_session()->get_identity_map();
+                auto pk = schema->primary_key();
+
+                if (identities == nullptr || pk.empty()) {
+                    auto record = std::make_shared<T>(schema);
+                    record->init(values);
+                    return record;
+                }
+
+                auto id = values.column(pk).to_value();
+
+                auto record = identities->get<T>(schema->table_name(), id);
+
+                if (record != nullptr) {
+                    return record;
+                }
+
+                record = std::make_shared<T>(schema);
+                record->init(values);
+
+                identities->put(schema->table_name(), id, record);
+
+                return record;
+            }
+        }
+
         /*!
          * finds all records for a schema
          * @param schema the schema to find records for
@@ -38,9 +80,7 @@ namespace rj
 
             for (auto &row : results) {
                 if (row.is_valid()) {
-                    auto record = std::make_shared<T>(schema);
-                    record->init(row);
-                    funk(record);
+                    funk(helper::materialize<T>(schema, row));
                 }
             }
         }
@@ -81,9 +121,7 @@ namespace rj
             if (!results.is_valid()) return;
 
             for (auto &row : results) {
-                auto record = std::make_shared<T>(schema);
-                record->init(row);
-                funk(record);
+                funk(helper::materialize<T>(schema, row));
             }
         }
 
@@ -116,6 +154,18 @@ namespace rj
         inline void find_one(const std::shared_ptr<schema> &schema, const std::string &name, const sql_value &value,
                              const typename record<T>::callback &funk)
         {
+            auto identities = schema->get_session()->get_identity_map();
+
+            // a record already loaded by its primary key needs no query
+            if (identities != nullptr && name == schema->primary_key()) {
+                auto record = identities->get<T>(schema->table_name(), value);
+
+                if (record != nullptr) {
+                    funk(record);
+                    return;
+                }
+            }
+
             select_query query(schema);
 
             query.where(name + " = $1", value).limit("1");
@@ -132,9 +182,7 @@ namespace rj
                 return;
             }
 
-            auto record = std::make_shared<T>(schema);
-            record->init(*it);
-            funk(record);
+            funk(helper::materialize<T>(schema, *it));
         }
 
         /*!
@@ -181,13 +229,16 @@ namespace rj
            private:
             std::shared_ptr<schema_type> schema_;
             std::unordered_map<std::string, sql_value> values_;
+            std::unordered_map<std::string, sql_value> original_;
+            // cleared by a delete, which does not otherwise change the record
+            mutable bool persisted_;
 
            public:
             /*!
              * @param schema the schema to operate on
              * @param columnName the name of the id column in the schema
              */
-            record(const std::shared_ptr<schema_type> &schema) : schema_(schema)
+            record(const std::shared_ptr<schema_type> &schema) : schema_(schema), persisted_(false)
             {
                 if (schema_ == nullptr) {
                     throw database_exception("no schema for record");
@@ -205,14 +256,19 @@ namespace rj
             /*!
              * copy constructor
              */
-            record(const record &other) : schema_(other.schema_), values_(other.values_)
+            record(const record &other)
+                : schema_(other.schema_), values_(other.values_), original_(other.original_), persisted_(other.persisted_)
             {
             }
 
             /*!
              * move constructor
              */
-            record(record &&other) : schema_(std::move(other.schema_)), values_(std::move(other.values_))
+            record(record &&other)
+                : schema_(std::move(other.schema_)),
+                  values_(std::move(other.values_)),
+                  original_(std::move(other.original_)),
+                  persisted_(other.persisted_)
             {
             }
 
@@ -226,7 +282,9 @@ namespace rj
             record &operator=(const record &other)
             {
                 values_ = other.values_;
+                original_ = other.original_;
                 schema_ = other.schema_;
+                persisted_ = other.persisted_;
 
                 return *this;
             }
@@ -237,7 +295,9 @@ namespace rj
             record &operator=(record &&other)
             {
                 values_ = std::move(other.values_);
+                original_ = std::move(other.original_);
                 schema_ = std::move(other.schema_);
+                persisted_ = other.persisted_;
 
                 return *this;
             }
@@ -255,6 +315,9 @@ namespace rj
                     set(v.name(), v->to_value());
                 }
 
+                original_ = values_;
+                persisted_ = true;
+
                 on_record_init(values);
             }
 
@@ -288,6 +351,47 @@ namespace rj
                 return schema_;
             }
 
+            /*!
+             * @return true if this record was read from or saved to the database
+             */
+            bool is_persisted() const
+            {
+                return persisted_;
+            }
+
+            /*!
+             * @return true if a value was set since the record was read or saved
+             */
+            bool is_dirty() const
+            {
+                return !changed_columns().empty();
+            }
+
+            /*!
+             * gets the columns with values that differ from when the record was read or saved
+             * @return the changed column names, in schema order
+             */
+            std::vector<std::string> changed_columns() const
+            {
+                std::vector<std::string> changed;
+
+                for (auto &column : schema()->column_names()) {
+                    auto value = values_.find(column);
+
+                    if (value == values_.end()) {
+                        continue;
+                    }
+
+                    auto original = original_.find(column);
+
+                    if (original == original_.end() || !(original->second == value->second)) {
+                        changed.push_back(column);
+                    }
+                }
+
+                return changed;
+            }
+
             /*!
              *  @return true if a record with the id column value exists
              */
@@ -308,39 +412,212 @@ namespace rj
 
             /*!
              * saves this instance
-             * @param insert_only set to true to never perform an update if the record exists
+             * a persisted record updates only its changed columns, a record with an id is upserted, otherwise it is inserted
              * @return true if the save was successful
              */
             bool save()
             {
-                bool rval = false;
-                bool exists = record::exists();
-                auto cols_to_save = available_columns(exists);
                 auto pk = schema()->primary_key();
 
-                if (exists) {
-                    update_query query(schema(), cols_to_save);
+                if (persisted_ && has(pk)) {
+                    auto cols_to_save = changed_columns();
 
-                    bind_columns_to_query(query, cols_to_save);
+                    if (cols_to_save.empty()) {
+                        return true;
+                    }
+
+                    if (update_row(cols_to_save)) {
+                        mark_saved();
+                        return true;
+                    }
 
-                    query.where(pk + " = @" + pk);
-                    query.bind("@" + pk, get(pk));
+                    // the row is gone, so insert it again below
+                }
 
-                    rval = query.execute();
-                } else {
-                    insert_query query(schema(), cols_to_save);
+                bool upsert = has(pk);
+                auto cols_to_save = available_columns(upsert);
 
+                insert_query query(schema(), cols_to_save);
+
+                if (!upsert) {
                     bind_columns_to_query(query, cols_to_save);
 
-                    rval = query.execute();
+                    if (!query.execute()) {
+                        return false;
+                    }
+
+                    // set the new id
+                    set(pk, query.last_insert_id());
+                    mark_saved();
+                    return true;
+                }
+
+                // one statement instead of checking if the record exists first
+                // an upsert of unchanged values can report no changes, so like save_all only a failed statement is an error
+                query.flags(modify_query::Upsert | modify_query::Buffered);
+
+                bind_columns_to_query(query, cols_to_save);
+
+                query.execute();
+
+                try {
+                    query.flush();
+                } catch (const database_exception &) {
+                    // the error is still on the session
+                    return false;
+                }
+
+                mark_saved();
+
+                return true;
+            }
+
+            /*!
+             * saves many records of this type in one transaction
+             * changed persisted records are updated, records with an id are upserted and the rest are inserted,
+             * using multi row statements where the backend allows it
+             * joins the current transaction if one is active
+             * @param begin an iterator to the first record pointer
+             * @param end an iterator past the last record pointer
+             * @return the number of records written
+             * @throws database_exception if a statement fails, leaving the records unchanged
+             */
+            template <typename Iterator>
+            static size_t save_all(Iterator begin, Iterator end)
+            {
+                if (begin == end) {
+                    return 0;
+                }
+
+                auto schema = (*begin)->schema();
+                auto session = schema->get_session();
+                auto pk = schema->primary_key();
+
+                // group the records by the statement and columns they need
+                std::vector<std::pair<record *, std::vector<std::string>>> updates;
+                std::map<std::vector<std::string>, std::vector<record *>> upserts, inserts;
 
-                    if (rval) {
-                        // set the new id
-                        set(pk, query.last_insert_id());
+                for (auto it = begin; it != end; ++it) {
+                    record *rec = &**it;
+
+                    if (rec->persisted_ && rec->has(pk)) {
+                        auto columns = rec->changed_columns();
+
+                        if (!columns.empty()) {
+                            updates.emplace_back(rec, columns);
+                        }
+                    } else if (rec->has(pk)) {
+                        upserts[rec->available_columns(true)].push_back(rec);
+                    } else {
+                        inserts[rec->available_columns(false)].push_back(rec);
                     }
                 }
 
-                return rval;
+                // the records only change once the transaction commits
+                std::vector<record *> saved;
+                std::vector<std::pair<record *, long long>> ids;
+
+                in_transaction(session, [&]() {
+                    for (auto &update : updates) {
+                        if (update.first->update_row(update.second)) {
+                            saved.push_back(update.first);
+                        } else {
+                            // the row is gone, so insert it again
+                            upserts[update.first->available_columns(true)].push_back(update.first);
+                        }
+                    }
+
+                    for (auto &group : upserts) {
+                        insert_rows(schema, group.first, group.second, modify_query::Upsert, nullptr);
+
+                        saved.insert(saved.end(), group.second.begin(), group.second.end());
+                    }
+
+                    for (auto &group : inserts) {
+                        insert_rows(schema, group.first, group.second, 0, &ids);
+
+                        saved.insert(saved.end(), group.second.begin(), group.second.end());
+                    }
+                });
+
+                for (auto &id : ids) {
+                    id.first->set(pk, id.second);
+                }
+
+                for (auto rec : saved) {
+                    rec->mark_saved();
+                }
+
+                return saved.size();
+            }
+
+            /*!
+             * deletes many records of this type in one transaction, by their id column
+             * joins the current transaction if one is active
+             * @param begin an iterator to the first record pointer
+             * @param end an iterator past the last record pointer
+             * @return the number of rows deleted
+             * @throws database_exception if a statement fails
+             */
+            template <typename Iterator>
+            static size_t delete_all(Iterator begin, Iterator end)
+            {
+                if (begin == end) {
+                    return 0;
+                }
+
+                auto schema = (*begin)->schema();
+                auto session = schema->get_session();
+                auto pk = schema->primary_key();
+
+                std::vector<record *> records;
+
+                for (auto it = begin; it != end; ++it) {
+                    record *rec = &**it;
+
+                    if (rec->has(pk)) {
+                        records.push_back(rec);
+                    }
+                }
+
+                size_t count = 0;
+                size_t limit = std::max<size_t>(1, session->max_parameters());
+
+                in_transaction(session, [&]() {
+                    for (size_t offset = 0; offset < records.size(); offset += limit) {
+                        size_t rows = std::min(limit, records.size() - offset);
+
+                        std::ostringstream where;
+
+                        where << pk << " IN (";
+
+                        for (size_t i = 0; i < rows; i++) {
+                            if (i > 0) {
+                                where << ",";
+                            }
+                            where << "$" << (i + 1);
+                        }
+
+                        where << ")";
+
+                        delete_query query(schema);
+
+                        query.where(where.str());
+
+                        for (size_t i = 0; i < rows; i++) {
+                            query.bind_value(i + 1, records[offset + i]->get(pk));
+                        }
+
+                        count += query.execute();
+                    }
+                });
+
+                for (auto rec : records) {
+                    rec->forget();
+                    rec->persisted_ = false;
+                }
+
+                return count;
             }
 
             sql_value id() const
@@ -475,6 +752,8 @@ namespace rj
             void reset()
             {
                 values_.clear();
+                original_.clear();
+                persisted_ = false;
             }
 
             /*!
@@ -497,6 +776,8 @@ namespace rj
                     return false;
                 }
 
+                forget();
+
                 select_query query(schema());
 
                 query.where(name + " = $1", get(name)).limit("1");
@@ -528,10 +809,141 @@ namespace rj
 
                 query.where(pk + " = $1", get(pk));
 
-                return query.execute();
+                if (!query.execute()) {
+                    return false;
+                }
+
+                forget();
+
+                persisted_ = false;
+
+                return true;
             }
 
            private:
+            /*!
+             * runs statements in a transaction, joining the current one if the connection is in one
+             */
+            static void in_transaction(const std::shared_ptr<rj::db::session> &sess, const std::function<void()> &funk)
+            {
+                if (sess->in_transaction()) {
+                    funk();
+                    return;
+                }
+
+                auto tx = sess->start_transaction();
+
+                // an exception rolls back when the transaction is destroyed
+                funk();
+
+                tx.commit();
+            }
+
+            /*!
+             * inserts records with the same columns, as many per statement as the backend allows
+             * @param ids where to put the generated ids, or null if the records have them
+             */
+            static void insert_rows(const std::shared_ptr<schema_type> &schema, const std::vector<std::string> &columns,
+                                    const std::vector<record *> &records, int flags, std::vector<std::pair<record *, long long>> *ids)
+            {
+                auto session = schema->get_session();
+
+                // without every generated id, the new records need a statement each
+                size_t limit = 1;
+
+                if (ids == nullptr || session->reports_insert_ids()) {
+                    limit = std::max<size_t>(1, session->max_parameters() / std::max<size_t>(1, columns.size()));
+                }
+
+                for (size_t offset = 0; offset < records.size(); offset += limit) {
+                    size_t rows = std::min(limit, records.size() - offset);
+
+                    insert_query query(schema, columns);
+
+                    // a batch throws on failure instead of counting changes, as an upsert can change nothing
+                    query.flags(flags | modify_query::Buffered);
+
+                    for (size_t i = 0; i < rows; i++) {
+                        records[offset + i]->bind_columns_to_query(query, columns);
+                        query.execute();
+                    }
+
+                    // a full batch was already sent by the last execute
+                    query.flush();
+
+                    if (ids == nullptr) {
+                        continue;
+                    }
+
+                    if (rows == 1) {
+                        ids->emplace_back(records[offset], query.last_insert_id());
+                        continue;
+                    }
+
+                    auto generated = query.last_insert_ids();
+
+                    if (generated.size() != rows) {
+                        throw database_exception("unable to read the generated ids of the inserted records");
+                    }
+
+                    for (size_t i = 0; i < rows; i++) {
+                        ids->emplace_back(records[offset + i], generated[i]);
+                    }
+                }
+            }
+
+            /*!
+             * updates columns of the row for the saved id
+             * @return the number of rows changed
+             */
+            int update_row(const std::vector<std::string> &columns) const
+            {
+                auto pk = schema()->primary_key();
+
+                update_query query(schema(), columns);
+
+                bind_columns_to_query(query, columns);
+
+                // find the row by its saved id, in case the id itself changed
+                auto id = original_.find(pk);
+
+                query.where(pk + " = @" + pk);
+                query.bind("@" + pk, id != original_.end() ? id->second : get(pk));
+
+                return query.execute();
+            }
+
+            /*!
+             * removes this record from the identity map of the session, by its saved and current id
+             */
+            void forget() const
+            {
+                auto identities = schema()->get_session()->get_identity_map();
+
+                if (identities == nullptr) {
+                    return;
+                }
+
+                auto pk = schema()->primary_key();
+                auto id = original_.find(pk);
+
+                if (id != original_.end()) {
+                    identities->erase(schema()->table_name(), id->second);
+                }
+
+                identities->erase(schema()->table_name(), get(pk));
+            }
+
+            /*!
+             * remembers the current values as the saved ones
+             */
+            void mark_saved()
+            {
+                forget();
+                original_ = values_;
+                persisted_ = true;
+            }
+
             std::vector<std::string> available_columns(bool exists) const
             {
                 auto columns = schema()->column_names();
@@ -560,6 +972,34 @@ namespace rj
                 return index;
             }
         };
+
+        /*!
+         * saves many records in one transaction
+         * @see record::save_all
+         * @param records a range of record pointers
+         * @return the number of records written
+         */
+        template <typename Range>
+        inline size_t save_all(const Range &records)
+        {
+            typedef typename std::decay<decltype(**std::begin(records))>::type record_type;
+
+            return record_type::save_all(std::begin(records), std::end(records));
+        }
+
+        /*!
+         * deletes many records in one transaction
+         * @see record::delete_all
+         * @param records a range of record pointers
+         * @return the number of rows deleted
+         */
+        template <typename Range>
+        inline size_t delete_all(const Range &records)
+        {
+            typedef typename std::decay<decltype(**std::begin(records))>::type record_type;
+
+            return record_type::delete_all(std::begin(records), std::end(records));
+        }
     }
 }
 
@@ -10,6 +10,41 @@ namespace rj
 {
     namespace db
     {
+        shared_ptr<column_names> resultset_impl::names() const
+        {
+            if (names_ != nullptr) {
+                return names_;
+            }
+
+            size_t count = column_count();
+
+            // nothing to share until the columns are known
+            if (count == 0) {
+                return nullptr;
+            }
+
+            auto names = make_shared<column_names>();
+
+            for (size_t i = 0; i < count; i++) {
+                names->add(column_name(i), i);
+            }
+
+            names_ = names;
+
+            return names_;
+        }
+
+        int resultset_impl::column_index(const std::string &name) const
+        {
+            auto names = this->names();
+
+            if (names == nullptr) {
+                return -1;
+            }
+
+            return names->index_of(name);
+        }
+
         resultset::resultset(const shared_ptr<resultset_impl> &impl) : impl_(impl)
         {
             if (impl_ == nullptr) {
@@ -38,6 +73,22 @@ namespace rj
             return impl_->current_row();
         }
 
+        row_view resultset::view() const
+        {
+            return row_view(impl_.get());
+        }
+
+        column_handle resultset::resolve(const std::string &name) const
+        {
+            int index = impl_->column_index(name);
+
+            if (index < 0) {
+                throw no_such_column_exception(name);
+            }
+
+            return column_handle(name, index);
+        }
+
         bool resultset::is_valid() const
         {
             return impl_ != nullptr && impl_->is_valid();
@@ -61,11 +112,23 @@ namespace rj
 
         size_t resultset::size() const
         {
+            auto count = impl_->row_count();
+
+            if (count >= 0) {
+                return count;
+            }
+
             return distance(begin(), end());
         }
 
         bool resultset::empty() const
         {
+            auto count = impl_->row_count();
+
+            if (count >= 0) {
+                return count == 0;
+            }
+
             return begin() == end();
         }
 
@@ -6,8 +6,10 @@
 #define RJ_DB_RESULTSET_H
 
 #include <memory>
+#include "column_names.h"
 #include "exception.h"
 #include "row.h"
+#include "row_view.h"
 
 namespace rj
 {
@@ -23,6 +25,9 @@ namespace rj
            public:
             typedef rj::db::row row_type;
 
+           private:
+            mutable std::shared_ptr<rj::db::column_names> names_;
+
            protected:
             resultset_impl() = default;
 
@@ -56,6 +61,45 @@ namespace rj
              * resets this resultset back to the first row
              */
             virtual void reset() = 0;
+
+            /*!
+             * a hint for the number of rows, that does not read or execute anything again
+             * @return the number of rows, or a negative value if they have to be read to be counted
+             */
+            virtual long long row_count() = 0;
+
+            /*!
+             * gets the number of columns in the results
+             * @return the number of columns
+             */
+            virtual size_t column_count() const = 0;
+
+            /*!
+             * gets the name of a column in the results
+             * @param  position the index of the column
+             * @return          the name of the column
+             */
+            virtual std::string column_name(size_t position) const = 0;
+
+            /*!
+             * reads a column of the current row straight from the backend results
+             * @param  position the index of the column
+             * @return          the value of the column
+             */
+            virtual sql_value column_value(size_t position) const = 0;
+
+            /*!
+             * gets the column name lookups, built once and shared by every row of the results
+             * @return the column names, or nullptr if the columns are not known yet
+             */
+            std::shared_ptr<rj::db::column_names> names() const;
+
+            /*!
+             * finds the index of a column by name
+             * @param  name the name of the column
+             * @return      the index of the column, or -1 if not found
+             */
+            int column_index(const std::string &name) const;
         };
 
         /*!
@@ -267,12 +311,28 @@ namespace rj
              */
             row_type operator*();
 
+            /*!
+             * gets a view of the current row, which does not allocate
+             * the view is only valid until the next move of this result set
+             * @return the current row view
+             */
+            row_view view() const;
+
+            /*!
+             * resolves a column name once, for reading it from each row without another lookup
+             * @param  name the name of the column
+             * @return      the column handle
+             * @throws no_such_column_exception if there is no such column
+             */
+            column_handle resolve(const std::string &name) const;
+
             /*!
              * resets this result set back to the first row
              */
             void reset();
 
             /*!
+             * counts the rows without reading them when the implementation knows how many there are
              * @return the number of rows in the result set
              */
             size_t size() const;
@@ -89,6 +89,11 @@ namespace rj
             return column(name);
         }
 
+        row::column_type row::operator[](const column_handle &handle) const
+        {
+            return column(handle);
+        }
+
         string row::column_name(size_t nPosition) const
         {
             assert(impl_ != nullptr);
@@ -107,6 +112,11 @@ namespace rj
             return impl_->column(name);
         }
 
+        row::column_type row::column(const column_handle &handle) const
+        {
+            return column(handle.position());
+        }
+
         size_t row::size() const
         {
             return impl_ == nullptr ? 0 : impl_->size();
@@ -8,6 +8,7 @@
 #include <iterator>
 #include <memory>
 #include "column.h"
+#include "column_names.h"
 
 namespace rj
 {
@@ -321,6 +322,13 @@ namespace rj
              */
             column_type operator[](const std::string &name) const;
 
+            /*!
+             * gets a column by a resolved handle
+             * @param  handle the column handle
+             * @return        the column object
+             */
+            column_type operator[](const column_handle &handle) const;
+
             /*!
              * gets the column name
              * @param  nPosition the index of the column
@@ -342,6 +350,13 @@ namespace rj
              */
             column_type column(const std::string &name) const;
 
+            /*!
+             * gets a column by a resolved handle
+             * @param  handle the column handle
+             * @return        the column object
+             */
+            column_type column(const column_handle &handle) const;
+
             /*!
              * gets the number of columns in the row
              * @return the number of columns
@@ -0,0 +1,157 @@
+#include "row_view.h"
+#include "resultset.h"
+
+namespace rj
+{
+    namespace db
+    {
+        column_view::column_view(resultset_impl *rs, size_t position) : rs_(rs), position_(position)
+        {
+        }
+
+        bool column_view::is_valid() const
+        {
+            return rs_ != nullptr && rs_->is_valid();
+        }
+
+        sql_value column_view::to_value() const
+        {
+            if (rs_ == nullptr) {
+                return sql_value();
+            }
+
+            return rs_->column_value(position_);
+        }
+
+        sql_blob column_view::to_blob() const
+        {
+            return to_value();
+        }
+
+        sql_time column_view::to_time() const
+        {
+            return to_value();
+        }
+
+        std::string column_view::name() const
+        {
+            if (rs_ == nullptr) {
+                return std::string();
+            }
+
+            return rs_->column_name(position_);
+        }
+
+        size_t column_view::position() const
+        {
+            return position_;
+        }
+
+        column_view::operator int() const
+        {
+            return to_value();
+        }
+
+        column_view::operator unsigned() const
+        {
+            return to_value();
+        }
+
+        column_view::operator long long() const
+        {
+            return to_value();
+        }
+
+        column_view::operator unsigned long long() const
+        {
+            return to_value();
+        }
+
+        column_view::operator double() const
+        {
+            return to_value();
+        }
+
+        column_view::operator float() const
+        {
+            return to_value();
+        }
+
+        column_view::operator std::string() const
+        {
+            return to_value();
+        }
+
+        column_view::operator std::wstring() const
+        {
+            return to_value();
+        }
+
+        row_view::row_view(resultset_impl *rs) : rs_(rs)
+        {
+        }
+
+        column_view row_view::operator[](size_t position) const
+        {
+            return column(position);
+        }
+
+        column_view row_view::column(size_t position) const
+        {
+            if (position >= size()) {
+                throw no_such_column_exception();
+            }
+
+            return column_view(rs_, position);
+        }
+
+        column_view row_view::operator[](const std::string &name) const
+        {
+            return column(name);
+        }
+
+        column_view row_view::operator[](const column_handle &handle) const
+        {
+            return column(handle);
+        }
+
+        column_view row_view::column(const std::string &name) const
+        {
+            int index = rs_ == nullptr ? -1 : rs_->column_index(name);
+
+            if (index < 0) {
+                throw no_such_column_exception(name);
+            }
+
+            return column_view(rs_, index);
+        }
+
+        column_view row_view::column(const column_handle &handle) const
+        {
+            return column(handle.position());
+        }
+
+        std::string row_view::column_name(size_t position) const
+        {
+            if (position >= size()) {
+                throw no_such_column_exception();
+            }
+
+            return rs_->column_name(position);
+        }
+
+        size_t row_view::size() const
+        {
+            if (rs_ == nullptr) {
+                return 0;
+            }
+
+            return rs_->column_count();
+        }
+
+        bool row_view::is_valid() const
+        {
+            return rs_ != nullptr && rs_->is_valid();
+        }
+    }
+}
@@ -0,0 +1,161 @@
+/*!
+ * @file row_view.h
+ * A non-owning view of the current row in a result set
+ */
+#ifndef RJ_DB_ROW_VIEW_H
+#define RJ_DB_ROW_VIEW_H
+
+#include <string>
+#include "column_names.h"
+#include "sql_value.h"
+
+namespace rj
+{
+    namespace db
+    {
+        class resultset_impl;
+
+        /*!
+         * a column in a row view, read directly from the backend results
+         * only valid until the results move to another row
+         */
+        class column_view
+        {
+           private:
+            resultset_impl *rs_;
+            size_t position_;
+
+           public:
+            /*!
+             * @param rs the results the column is read from
+             * @param position the index of the column
+             */
+            column_view(resultset_impl *rs, size_t position);
+
+            /*!
+             * tests if this view has results to read from
+             * @return true if the column can be read
+             */
+            bool is_valid() const;
+
+            /*!
+             * converts this column to a value
+             * @return the value of this column
+             */
+            sql_value to_value() const;
+
+            /*!
+             * converts this column to a blob value
+             */
+            sql_blob to_blob() const;
+
+            /*!
+             * converts this column to a sql time value
+             */
+            sql_time to_time() const;
+
+            /*!
+             * @return the name of this column
+             */
+            std::string name() const;
+
+            /*!
+             * @return the index of this column in the row
+             */
+            size_t position() const;
+
+            /*!
+             * primitive operators
+             */
+            operator std::string() const;
+            operator unsigned() const;
+            operator double() const;
+            operator std::wstring() const;
+            operator int() const;
+            operator long long() const;
+            operator unsigned long long() const;
+            operator float() const;
+        };
+
+        /*!
+         * the current row of a result set, read directly from the backend results without allocating
+         * only valid until the results move to another row
+         */
+        class row_view
+        {
+           private:
+            resultset_impl *rs_;
+
+           public:
+            /*!
+             * @param rs the results to view
+             */
+            row_view(resultset_impl *rs);
+
+            /*!
+             * gets a column at a position
+             * @param  position   the index of the column
+             * @return            the column view
+             */
+            column_view operator[](size_t position) const;
+
+            /*!
+             * gets a column by name
+             * @param  name the name of the column
+             * @return      the column view
+             */
+            column_view operator[](const std::string &name) const;
+
+            /*!
+             * gets a column by a resolved handle
+             * @param  handle the column handle
+             * @return        the column view
+             */
+            column_view operator[](const column_handle &handle) const;
+
+            /*!
+             * get a column by index
+             * @param  position the index of the column
+             * @return          the column view
+             * @throws no_such_column_exception if the position is out of range
+             */
+            column_view column(size_t position) const;
+
+            /*!
+             * gets a column by name
+             * @param  name the name of the column
+             * @return      the column view
+             * @throws no_such_column_exception if there is no such column
+             */
+            column_view column(const std::string &name) const;
+
+            /*!
+             * gets a column by a resolved handle
+             * @param  handle the column handle
+             * @return        the column view
+             */
+            column_view column(const column_handle &handle) const;
+
+            /*!
+             * gets the column name
+             * @param  position the index of the column
+             * @return          the column name
+             */
+            std::string column_name(size_t position) const;
+
+            /*!
+             * gets the number of columns in the row
+             * @return the number of columns
+             */
+            size_t size() const;
+
+            /*!
+             * tests if this view has results to read from
+             * @return true if valid
+             */
+            bool is_valid() const;
+        };
+    }
+}
+
+#endif
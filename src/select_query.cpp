@@ -4,6 +4,7 @@
 
 #include "select_query.h"
 #include "schema.h"
+#include "session.h"
 #include "statement.h"
 
 using namespace std;
@@ -12,25 +13,29 @@ namespace rj
 {
     namespace db
     {
-        select_query::select_query(const std::shared_ptr<rj::db::session> &session) : query(session)
+        select_query::select_query(const std::shared_ptr<rj::db::session> &session) : query(session), flags_(0)
         {
         }
-        select_query::select_query(const std::shared_ptr<rj::db::session> &session, const vector<string> &columns) : query(session), columns_(columns)
+        select_query::select_query(const std::shared_ptr<rj::db::session> &session, const vector<string> &columns)
+            : query(session), columns_(columns), flags_(0)
         {
         }
         select_query::select_query(const std::shared_ptr<rj::db::session> &session, const vector<string> &columns, const string &tableName)
-            : query(session), columns_(columns), tableName_(tableName)
+            : query(session), columns_(columns), tableName_(tableName), flags_(0)
         {
         }
 
         select_query::select_query(const select_query &other)
             : query(other),
               where_(other.where_),
+              join_(other.join_),
               limit_(other.limit_),
               orderBy_(other.orderBy_),
               groupBy_(other.groupBy_),
               columns_(other.columns_),
-              tableName_(other.tableName_)
+              tableName_(other.tableName_),
+              union_(other.union_),
+              flags_(other.flags_)
         {
         }
 
@@ -42,11 +47,14 @@ namespace rj
         select_query::select_query(select_query &&other)
             : query(std::move(other)),
               where_(std::move(other.where_)),
+              join_(std::move(other.join_)),
               limit_(std::move(other.limit_)),
               orderBy_(std::move(other.orderBy_)),
               groupBy_(std::move(other.groupBy_)),
               columns_(std::move(other.columns_)),
-              tableName_(std::move(other.tableName_))
+              tableName_(std::move(other.tableName_)),
+              union_(std::move(other.union_)),
+              flags_(other.flags_)
         {
         }
 
@@ -57,11 +65,14 @@ namespace rj
         {
             query::operator=(other);
             where_ = other.where_;
+            join_ = other.join_;
             limit_ = other.limit_;
             orderBy_ = other.orderBy_;
             groupBy_ = other.groupBy_;
             columns_ = other.columns_;
             tableName_ = other.tableName_;
+            union_ = other.union_;
+            flags_ = other.flags_;
 
             return *this;
         }
@@ -70,15 +81,29 @@ namespace rj
         {
             query::operator=(std::move(other));
             where_ = std::move(other.where_);
+            join_ = std::move(other.join_);
             limit_ = std::move(other.limit_);
             orderBy_ = std::move(other.orderBy_);
             groupBy_ = std::move(other.groupBy_);
             columns_ = std::move(other.columns_);
             tableName_ = std::move(other.tableName_);
+            union_ = std::move(other.union_);
+            flags_ = other.flags_;
 
             return *this;
         }
 
+        int select_query::flags() const
+        {
+            return flags_;
+        }
+
+        select_query &select_query::flags(int value)
+        {
+            flags_ = value;
+            return *this;
+        }
+
         select_query &select_query::from(const string &value)
         {
             tableName_ = value;
@@ -241,18 +266,54 @@ namespace rj
         {
             prepare(to_string());
 
+            if (flags_ & Stream) {
+                return stmt_->stream_results();
+            }
+
             return stmt_->results();
         }
 
         void select_query::execute(const std::function<void(const resultset &rs)> &funk)
         {
-            prepare(to_string());
-
-            auto rs = stmt_->results();
+            auto rs = execute();
 
             funk(rs);
         }
 
+        std::future<resultset> select_query::execute_async()
+        {
+            // a copy is executed, so this query can change or go away before the future is ready
+            select_query copy(*this);
+
+            // with its own statement, as this one may be executed again
+            copy.stmt_ = nullptr;
+
+            // only one query can be sent at a time
+            session_->wait_for_results();
+
+            // streamed rows are read as they arrive, so only whole results are sent ahead
+            if (!(flags_ & Stream)) {
+                copy.prepare(copy.to_string());
+
+                if (copy.stmt_->send_query()) {
+                    auto stmt = copy.stmt_;
+                    auto results = make_shared<promise<resultset>>();
+
+                    session_->on_results_ready([stmt, results]() {
+                        try {
+                            results->set_value(stmt->results());
+                        } catch (...) {
+                            results->set_exception(current_exception());
+                        }
+                    });
+
+                    return results->get_future();
+                }
+            }
+
+            return std::async(std::launch::async, [copy]() mutable { return copy.execute(); });
+        }
+
         void select_query::reset()
         {
             query::reset();
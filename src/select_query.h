@@ -5,6 +5,7 @@
 #ifndef RJ_DB_SELECT_QUERY_H
 #define RJ_DB_SELECT_QUERY_H
 
+#include <future>
 #include "join_clause.h"
 #include "query.h"
 #include "resultset.h"
@@ -26,6 +27,15 @@ namespace rj
          */
         class select_query : public query
         {
+           public:
+            /*!
+             * flags that change how a query executes
+             */
+            typedef enum {
+                /*! fetch rows from the server as they are read, instead of all at once */
+                Stream = (1 << 0)
+            } flag;
+
            private:
             where_clause where_;
             std::vector<join_clause> join_;
@@ -35,6 +45,7 @@ namespace rj
             std::vector<std::string> columns_;
             std::string tableName_;
             std::shared_ptr<union_operator> union_;
+            int flags_;
 
             select_query &column(const std::string &value)
             {
@@ -75,6 +86,18 @@ namespace rj
             select_query &operator=(const select_query &other);
             select_query &operator=(select_query &&other);
 
+            /*!
+             * @return the flags for this query
+             */
+            int flags() const;
+
+            /*!
+             * sets the flags for this query
+             * @param value the flags
+             * @return a reference to this instance
+             */
+            select_query &flags(int value);
+
             /*!
              * sets which table to select from
              * @param  tableName the table name
@@ -236,6 +259,15 @@ namespace rj
              */
             void execute(const std::function<void(const resultset &)> &funk);
 
+            /*!
+             * executes a copy of this query without blocking the caller
+             * backends that can send queries complete the future from session::consume_input or session::wait_for_results,
+             * others execute the copy on a worker thread
+             * the session must not be used for anything else until the future is ready
+             * @return the future results
+             */
+            std::future<resultset> execute_async();
+
             /*!
              * executes this query
              * @return a count of the number of rows
@@ -6,6 +6,7 @@
 #endif
 
 #include <algorithm>
+#include "blob_stream.h"
 #include "exception.h"
 #include "mysql/session.h"
 #include "postgres/session.h"
@@ -32,30 +33,110 @@ namespace rj
             return connectionInfo_;
         }
 
+        void session_impl::set_statement_cache_size(size_t value)
+        {
+        }
+
+        size_t session_impl::statement_cache_size() const
+        {
+            return 0;
+        }
+
+        unsigned long long session_impl::statement_cache_hits() const
+        {
+            return 0;
+        }
+
+        unsigned long long session_impl::statement_cache_misses() const
+        {
+            return 0;
+        }
+
+        void session_impl::clear_statement_cache()
+        {
+        }
+
+        bool session_impl::start_open()
+        {
+            return false;
+        }
+
+        session_impl::open_state session_impl::poll_open()
+        {
+            open();
+            return OpenReady;
+        }
+
+        int session_impl::socket() const
+        {
+            return -1;
+        }
+
+        bool session_impl::send_query(const std::string &sql)
+        {
+            return false;
+        }
+
+        bool session_impl::consume_input()
+        {
+            return true;
+        }
+
+        std::shared_ptr<resultset_impl> session_impl::get_results()
+        {
+            throw database_exception("no query was sent");
+        }
+
+        std::shared_ptr<blob_reader> session_impl::open_blob_reader(const std::shared_ptr<schema> &schema, const string &column,
+                                                                    const sql_value &id)
+        {
+            throw database_exception("blob streaming is not supported");
+        }
+
+        std::shared_ptr<blob_writer> session_impl::open_blob_writer(const std::shared_ptr<schema> &schema, const string &column,
+                                                                    const sql_value &id, size_t size)
+        {
+            throw database_exception("blob streaming is not supported");
+        }
+
         session::session(const std::shared_ptr<session_impl> &impl) : impl_(impl)
         {
         }
 
-        session::session(const session &other) : impl_(other.impl_), schema_factory_(other.schema_factory_)
+        session::session(const session &other) : impl_(other.impl_), identities_(other.identities_), schema_factory_(other.schema_factory_)
         {
         }
 
-        session::session(session &&other) : impl_(std::move(other.impl_)), schema_factory_(std::move(other.schema_factory_))
+        session::session(session &&other)
+            : impl_(std::move(other.impl_)),
+              identities_(std::move(other.identities_)),
+              pending_(std::move(other.pending_)),
+              schema_factory_(std::move(other.schema_factory_))
         {
             other.impl_ = nullptr;
+            other.pending_ = nullptr;
         }
 
         session &session::operator=(const session &other)
         {
+            // a sent query belongs to the connection being replaced
+            wait_for_results();
+
             impl_ = other.impl_;
+            identities_ = other.identities_;
             schema_factory_ = other.schema_factory_;
             return *this;
         }
         session &session::operator=(session &&other)
         {
+            wait_for_results();
+
             impl_ = std::move(other.impl_);
+            identities_ = std::move(other.identities_);
+            pending_ = std::move(other.pending_);
             schema_factory_ = std::move(other.schema_factory_);
             other.impl_ = nullptr;
+            other.pending_ = nullptr;
             return *this;
         }
         session::~session()
@@ -112,11 +193,81 @@ namespace rj
 
         session::resultset_type session::query(const std::string &sql) const
         {
+            wait_for_results();
+
             return resultset_type(impl_->query(sql));
         }
 
+        std::future<session::resultset_type> session::query_async(const std::string &sql) const
+        {
+            auto impl = impl_;
+
+            // only one query can be sent at a time
+            wait_for_results();
+
+            if (impl->send_query(sql)) {
+                auto results = std::make_shared<std::promise<resultset_type>>();
+
+                on_results_ready([impl, results]() {
+                    try {
+                        results->set_value(resultset_type(impl->get_results()));
+                    } catch (...) {
+                        results->set_exception(std::current_exception());
+                    }
+                });
+
+                return results->get_future();
+            }
+
+            return std::async(std::launch::async, [impl, sql]() { return resultset_type(impl->query(sql)); });
+        }
+
+        int session::socket() const
+        {
+            return impl_->socket();
+        }
+
+        bool session::consume_input()
+        {
+            bool ready = false;
+
+            try {
+                ready = impl_->consume_input();
+            } catch (const database_exception &) {
+                // the connection failed, so let the sent query fail with it
+                wait_for_results();
+                throw;
+            }
+
+            if (ready) {
+                wait_for_results();
+            }
+
+            return ready;
+        }
+
+        void session::on_results_ready(const std::function<void()> &funk) const
+        {
+            pending_ = funk;
+        }
+
+        void session::wait_for_results() const
+        {
+            if (!pending_) {
+                return;
+            }
+
+            auto funk = std::move(pending_);
+
+            pending_ = nullptr;
+
+            funk();
+        }
+
         bool session::execute(const std::string &sql)
         {
+            wait_for_results();
+
             return impl_->execute(sql);
         }
 
@@ -140,7 +291,7 @@ namespace rj
             return impl_->query_schema(connection_info().path, tablename, columns);
         }
 
-        string session_impl::insert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns) const
+        string session_impl::insert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns, size_t rows) const
         {
             ostringstream buf;
 
@@ -150,18 +301,136 @@ namespace rj
 
             buf << helper::join_csv(columns);
 
-            buf << ") VALUES(";
+            buf << ") VALUES";
 
-            buf << helper::join_params(columns, false);
+            buf << helper::join_values(columns, rows);
 
-            buf << ");";
+            buf << ";";
 
             return buf.str();
         }
 
-        string session::insert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns) const
+        string session_impl::upsert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns, size_t rows) const
+        {
+            ostringstream buf;
+
+            auto keys = schema->primary_keys();
+
+            buf << "INSERT INTO " << schema->table_name();
+
+            buf << "(";
+
+            buf << helper::join_csv(columns);
+
+            buf << ") VALUES";
+
+            buf << helper::join_values(columns, rows);
+
+            if (!keys.empty()) {
+                auto assignments = helper::join_assignments(columns, keys, "excluded.");
+
+                buf << " ON CONFLICT(" << helper::join_csv(keys) << ") DO ";
+
+                if (assignments.empty()) {
+                    buf << "NOTHING";
+                } else {
+                    buf << "UPDATE SET " << assignments;
+                }
+            }
+
+            buf << ";";
+
+            return buf.str();
+        }
+
+        size_t session_impl::max_parameters() const
+        {
+            // the historic sqlite limit is the lowest common denominator
+            return 999;
+        }
+
+        bool session_impl::reports_insert_ids() const
+        {
+            return false;
+        }
+
+        bool session_impl::in_transaction() const
+        {
+            return false;
+        }
+
+        string session::insert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns, size_t rows) const
+        {
+            return impl_->insert_sql(schema, columns, rows);
+        }
+
+        string session::upsert_sql(const std::shared_ptr<schema> &schema, const vector<string> &columns, size_t rows) const
+        {
+            return impl_->upsert_sql(schema, columns, rows);
+        }
+
+        size_t session::max_parameters() const
+        {
+            return impl_->max_parameters();
+        }
+
+        bool session::reports_insert_ids() const
+        {
+            return impl_->reports_insert_ids();
+        }
+
+        bool session::in_transaction() const
+        {
+            return impl_->in_transaction();
+        }
+
+        namespace helper
+        {
+            /*!
+             * gets a schema with a primary key and the column, so neither name is put in sql unchecked
+             */
+            static std::shared_ptr<schema> blob_schema(const std::shared_ptr<session> &sess, const string &tableName, const string &column)
+            {
+                auto schema = sess->get_schema(tableName);
+
+                if (schema == nullptr || !schema->is_valid()) {
+                    throw database_exception("no schema for table " + tableName);
+                }
+
+                if (schema->primary_key().empty()) {
+                    throw database_exception("blob streaming requires a primary key on " + tableName);
+                }
+
+                auto columns = schema->columns();
+
+                auto found = std::find_if(columns.begin(), columns.end(), [&column](const column_definition &def) { return def.name == column; });
+
+                if (found == columns.end()) {
+                    throw database_exception("no column " + column + " in " + tableName);
+                }
+
+                return schema;
+            }
+        }
+
+        std::shared_ptr<blob_reader> session::open_blob_reader(const string &tableName, const string &column, const sql_value &id)
+        {
+            return impl_->open_blob_reader(helper::blob_schema(shared_from_this(), tableName, column), column, id);
+        }
+
+        std::shared_ptr<blob_writer> session::open_blob_writer(const string &tableName, const string &column, const sql_value &id, size_t size)
+        {
+            return impl_->open_blob_writer(helper::blob_schema(shared_from_this(), tableName, column), column, id, size);
+        }
+
+        void session::set_identity_map(const std::shared_ptr<identity_map> &value)
+        {
+            identities_ = value;
+        }
+
+        std::shared_ptr<identity_map> session::get_identity_map() const
         {
-            return impl_->insert_sql(schema, columns);
+            return identities_;
         }
 
         shared_ptr<session_impl> session::impl() const
@@ -6,6 +6,8 @@
 #ifndef RJ_DB_SESSION_H
 #define RJ_DB_SESSION_H
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <vector>
 #include "schema_factory.h"
@@ -17,7 +19,10 @@ namespace rj
     namespace db
     {
         struct column_definition;
+        class blob_reader;
+        class blob_writer;
         class schema;
+        class identity_map;
         class transaction;
         class transaction_impl;
         class statement;
@@ -31,6 +36,18 @@ namespace rj
             typedef transaction_impl transaction_type;
             typedef resultset_impl resultset_type;
 
+            /*!
+             * the progress of a connection opened without blocking
+             */
+            typedef enum {
+                /*! waiting for the socket to be readable */
+                OpenReading,
+                /*! waiting for the socket to be writable */
+                OpenWriting,
+                /*! the connection is open */
+                OpenReady
+            } open_state;
+
             /*!
              * default constructor expects a uri
              */
@@ -111,9 +128,134 @@ namespace rj
              * generates database specific insert sql
              * @param  schema  the schema to insert to
              * @param  columns the columns to insert
+             * @param  rows    the number of value tuples to insert
              * @return         the sql string
              */
-            virtual std::string insert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns) const;
+            virtual std::string insert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns, size_t rows = 1) const;
+
+            /*!
+             * generates database specific sql to insert, or update the row when the primary key already exists
+             * the default implementation uses ON CONFLICT ... DO UPDATE
+             * @param  schema  the schema to insert to
+             * @param  columns the columns to insert, including the primary key
+             * @param  rows    the number of value tuples to insert
+             * @return         the sql string
+             */
+            virtual std::string upsert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns, size_t rows = 1) const;
+
+            /*!
+             * gets the maximum number of parameters a single statement can bind
+             * @return the parameter limit
+             */
+            virtual size_t max_parameters() const;
+
+            /*!
+             * tests if a multi row insert reports every generated id, see statement::last_insert_ids
+             * the default implementation returns false
+             * @return true if the ids are reported
+             */
+            virtual bool reports_insert_ids() const;
+
+            /*!
+             * tests if the connection is inside a transaction, however it was started
+             * the default implementation returns false
+             * @return true if a transaction is open
+             */
+            virtual bool in_transaction() const;
+
+            /*!
+             * sets the number of prepared statements kept per session, reused by sql
+             * the default implementation does not cache statements
+             * @param value the capacity, zero disables the cache
+             */
+            virtual void set_statement_cache_size(size_t value);
+
+            /*!
+             * @return the number of prepared statements kept
+             */
+            virtual size_t statement_cache_size() const;
+
+            /*!
+             * @return the number of times a cached statement was reused
+             */
+            virtual unsigned long long statement_cache_hits() const;
+
+            /*!
+             * @return the number of times a statement had to be prepared
+             */
+            virtual unsigned long long statement_cache_misses() const;
+
+            /*!
+             * forgets all cached prepared statements
+             */
+            virtual void clear_statement_cache();
+
+            /*!
+             * starts opening a connection without blocking, to be continued by poll_open
+             * the default implementation can not and returns false, so open should be called instead
+             * @return true if the connection was started
+             * @throws database_exception if the connection could not be started
+             */
+            virtual bool start_open();
+
+            /*!
+             * continues opening a connection once its socket is ready for the last returned state
+             * @return the state of the connection
+             * @throws database_exception if the connection failed
+             */
+            virtual open_state poll_open();
+
+            /*!
+             * gets the socket of the connection, for waiting on results in an event loop
+             * @return the socket descriptor, or -1 if the backend has none
+             */
+            virtual int socket() const;
+
+            /*!
+             * starts a query without waiting for its results
+             * the default implementation can not send queries and returns false
+             * @param  sql the sql string to execute
+             * @return     true if the query was sent, false if it can only be executed synchronously
+             */
+            virtual bool send_query(const std::string &sql);
+
+            /*!
+             * reads any input waiting on the socket without blocking
+             * @return true if the results of a sent query are ready
+             */
+            virtual bool consume_input();
+
+            /*!
+             * gets the results of a sent query, waiting for them if needed
+             * @return the results of the query
+             * @throws database_exception if no query was sent or it failed
+             */
+            virtual std::shared_ptr<resultset_type> get_results();
+
+            /*!
+             * opens a blob column of a row for reading in chunks
+             * the default implementation can not stream blobs and throws
+             * @param  schema the schema of the table
+             * @param  column the blob column
+             * @param  id     the primary key value of the row
+             * @return        the reader
+             * @throws database_exception if the row was not found or streaming is not supported
+             */
+            virtual std::shared_ptr<blob_reader> open_blob_reader(const std::shared_ptr<schema> &schema, const std::string &column,
+                                                                  const sql_value &id);
+
+            /*!
+             * opens a blob column of a row for replacing in chunks
+             * the default implementation can not stream blobs and throws
+             * @param  schema the schema of the table
+             * @param  column the blob column
+             * @param  id     the primary key value of the row
+             * @param  size   the size of the new value in bytes
+             * @return        the writer
+             * @throws database_exception if the row was not found or streaming is not supported
+             */
+            virtual std::shared_ptr<blob_writer> open_blob_writer(const std::shared_ptr<schema> &schema, const std::string &column,
+                                                                  const sql_value &id, size_t size);
 
            private:
             uri connectionInfo_;
@@ -175,6 +317,41 @@ namespace rj
              */
             resultset_type query(const std::string &sql) const;
 
+            /*!
+             * executes a sql statement that returns results without blocking the caller
+             * backends that can send queries complete the future from consume_input or wait_for_results, so it can be driven by the socket
+             * other backends execute the query on a worker thread
+             * the session must not be used for anything else until the future is ready
+             * @param  sql   the sql string to execute
+             * @return       the future results of the query
+             */
+            std::future<resultset_type> query_async(const std::string &sql) const;
+
+            /*!
+             * gets the socket of the connection, for waiting on asynchronous results in an event loop
+             * @return the socket descriptor, or -1 if the backend has none
+             */
+            int socket() const;
+
+            /*!
+             * reads any input waiting on the socket without blocking, call when the socket is readable
+             * once the results of a sent query are ready they are read, completing its future
+             * @return true if the results of an asynchronous query are ready
+             */
+            bool consume_input();
+
+            /*!
+             * sets the function that reads the results of a sent query, called once they are ready
+             * @param funk the function, which completes the future of the query
+             */
+            void on_results_ready(const std::function<void()> &funk) const;
+
+            /*!
+             * reads the results of a sent query, waiting for them if needed
+             * results whose future was dropped are read and discarded, so the session can be used again
+             */
+            void wait_for_results() const;
+
             /*!
              * executes a sql statement that does not return results
              * @param  sql the sql string to execute
@@ -234,9 +411,60 @@ namespace rj
              * generates database specific insert sql
              * @param  schema  the schema to insert to
              * @param  columns the columns to insert
+             * @param  rows    the number of value tuples to insert
              * @return         the sql string
              */
-            std::string insert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns) const;
+            std::string insert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns, size_t rows = 1) const;
+
+            /*!
+             * generates database specific sql to insert, or update the row when the primary key already exists
+             * @param  schema  the schema to insert to
+             * @param  columns the columns to insert, including the primary key
+             * @param  rows    the number of value tuples to insert
+             * @return         the sql string
+             */
+            std::string upsert_sql(const std::shared_ptr<schema> &schema, const std::vector<std::string> &columns, size_t rows = 1) const;
+
+            /*!
+             * gets the maximum number of parameters a single statement can bind
+             * @return the parameter limit
+             */
+            size_t max_parameters() const;
+
+            /*!
+             * tests if a multi row insert reports every generated id
+             * @return true if the ids are reported
+             */
+            bool reports_insert_ids() const;
+
+            /*!
+             * tests if the connection is inside a transaction, including one started with sql
+             * @return true if a transaction is open
+             */
+            bool in_transaction() const;
+
+            /*!
+             * opens a blob column of a row for reading in chunks, without loading the whole value
+             * @param  tableName the table of the row
+             * @param  column    the blob column
+             * @param  id        the primary key value of the row
+             * @return           the reader
+             * @throws database_exception if the column or row was not found
+             */
+            std::shared_ptr<blob_reader> open_blob_reader(const std::string &tableName, const std::string &column, const sql_value &id);
+
+            /*!
+             * opens a blob column of a row for replacing in chunks, without holding the whole value
+             * the column only changes when the writer is closed, destroying it without closing discards the value
+             * @param  tableName the table of the row
+             * @param  column    the blob column
+             * @param  id        the primary key value of the row
+             * @param  size      the size of the new value in bytes, sqlite requires it up front
+             * @return           the writer
+             * @throws database_exception if the column or row was not found
+             */
+            std::shared_ptr<blob_writer> open_blob_writer(const std::string &tableName, const std::string &column, const sql_value &id,
+                                                          size_t size);
 
             /*!
              * gets the implementation
@@ -252,8 +480,21 @@ namespace rj
                 return std::dynamic_pointer_cast<T>(impl());
             }
 
+            /*!
+             * sets the map of records loaded by primary key, shared by finders on this session
+             * @param value the map, or nullptr to disable it
+             */
+            void set_identity_map(const std::shared_ptr<identity_map> &value);
+
+            /*!
+             * @return the map of records loaded by primary key, or nullptr if it is disabled
+             */
+            std::shared_ptr<identity_map> get_identity_map() const;
+
            private:
             std::shared_ptr<session_impl> impl_;
+            std::shared_ptr<identity_map> identities_;
+            mutable std::function<void()> pending_;
 
            protected:
             schema_factory schema_factory_;
@@ -0,0 +1,340 @@
+/*!
+ * @copyright ryan jennings (ryan-jennings.net), 2013
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "session_pool.h"
+#include "exception.h"
+#include "log.h"
+#include "session.h"
+#include "sqldb.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        session_pool::options::options()
+            : min_size(1), max_size(10), max_waiters(64), idle_timeout(chrono::minutes(5)), wait_timeout(chrono::seconds(30))
+        {
+        }
+
+        session_pool::lease::lease() : pool_(nullptr), session_(nullptr)
+        {
+        }
+
+        session_pool::lease::lease(const shared_ptr<session_pool> &pool, const shared_ptr<rj::db::session> &session)
+            : pool_(pool), session_(session)
+        {
+        }
+
+        session_pool::lease::lease(lease &&other) : pool_(std::move(other.pool_)), session_(std::move(other.session_))
+        {
+            other.pool_ = nullptr;
+            other.session_ = nullptr;
+        }
+
+        session_pool::lease &session_pool::lease::operator=(lease &&other)
+        {
+            release();
+
+            pool_ = std::move(other.pool_);
+            session_ = std::move(other.session_);
+            other.pool_ = nullptr;
+            other.session_ = nullptr;
+
+            return *this;
+        }
+
+        session_pool::lease::~lease()
+        {
+            release();
+        }
+
+        shared_ptr<rj::db::session> session_pool::lease::get() const
+        {
+            return session_;
+        }
+
+        rj::db::session *session_pool::lease::operator->() const
+        {
+            return session_.get();
+        }
+
+        rj::db::session &session_pool::lease::operator*() const
+        {
+            return *session_;
+        }
+
+        void session_pool::lease::release()
+        {
+            if (pool_ != nullptr && session_ != nullptr) {
+                pool_->release(session_);
+            }
+            pool_ = nullptr;
+            session_ = nullptr;
+        }
+
+        bool session_pool::lease::is_valid() const
+        {
+            return session_ != nullptr;
+        }
+
+        session_pool::lease::operator bool() const
+        {
+            return is_valid();
+        }
+
+        session_pool::session_pool(const uri &info, const options &opts) : connectionInfo_(info), options_(opts), size_(0), waiters_(0)
+        {
+            if (options_.max_size == 0) {
+                throw database_exception("session pool max size must be greater than zero");
+            }
+
+            if (options_.min_size > options_.max_size) {
+                options_.min_size = options_.max_size;
+            }
+        }
+
+        shared_ptr<session_pool> session_pool::create(const uri &info, const options &opts)
+        {
+            // the constructor is private, so make_shared can not be used
+            return shared_ptr<session_pool>(new session_pool(info, opts));
+        }
+
+        session_pool::~session_pool()
+        {
+            // leases hold a reference to the pool, so only idle sessions remain
+        }
+
+        shared_ptr<rj::db::session> session_pool::create_session()
+        {
+            return sqldb::open_session(connectionInfo_);
+        }
+
+        session_pool::lease session_pool::acquire()
+        {
+            auto deadline = clock_type::now() + options_.wait_timeout;
+
+            // declared before the lock, so discarded sessions are destroyed after it is released
+            vector<shared_ptr<rj::db::session>> discarded;
+
+            unique_lock<mutex> lock(mutex_);
+
+            while (true) {
+                // health check idle sessions on the way out
+                while (!idle_.empty()) {
+                    auto session = std::move(idle_.front().session);
+
+                    idle_.pop_front();
+
+                    if (session->is_open()) {
+                        return lease(shared_from_this(), session);
+                    }
+
+                    log::debug("discarding closed session from pool");
+
+                    discarded.push_back(std::move(session));
+
+                    --size_;
+                }
+
+                if (size_ < options_.max_size) {
+                    // reserve the slot and connect without holding the lock
+                    ++size_;
+
+                    lock.unlock();
+
+                    try {
+                        auto session = create_session();
+
+                        return lease(shared_from_this(), session);
+                    } catch (...) {
+                        lock.lock();
+                        --size_;
+                        available_.notify_one();
+                        throw;
+                    }
+                }
+
+                if (waiters_ >= options_.max_waiters) {
+                    throw database_exception("session pool wait queue is full");
+                }
+
+                ++waiters_;
+
+                bool timeout = available_.wait_until(lock, deadline) == cv_status::timeout;
+
+                --waiters_;
+
+                if (timeout && idle_.empty() && size_ >= options_.max_size) {
+                    throw database_exception("timed out waiting for a session from the pool");
+                }
+            }
+        }
+
+        bool session_pool::reset_session(const shared_ptr<rj::db::session> &session)
+        {
+            // cached records belong to the last lease
+            session->set_identity_map(nullptr);
+
+            if (!session->is_open()) {
+                return false;
+            }
+
+            try {
+                // the results of a query whose future was dropped would block the next one
+                session->wait_for_results();
+
+                // a transaction left open would hold its locks and leak into the next lease
+                if (session->in_transaction() && !session->execute("ROLLBACK")) {
+                    log::warn("unable to roll back a returned session: %s", session->last_error().c_str());
+                    session->close();
+                    return false;
+                }
+            } catch (const std::exception &e) {
+                log::warn("unable to reset a returned session: %s", e.what());
+                session->close();
+                return false;
+            }
+
+            return true;
+        }
+
+        void session_pool::release(const shared_ptr<rj::db::session> &session)
+        {
+            deque<entry> expired;
+
+            // reset without holding the lock, as it may talk to the server
+            bool reusable = reset_session(session);
+
+            {
+                lock_guard<mutex> lock(mutex_);
+
+                if (reusable) {
+                    idle_.push_front(entry{session, clock_type::now()});
+                } else {
+                    --size_;
+                }
+
+                expired = take_expired(clock_type::now());
+            }
+
+            available_.notify_one();
+
+            // expired sessions are closed here, outside of the lock
+        }
+
+        deque<session_pool::entry> session_pool::take_expired(const clock_type::time_point &now)
+        {
+            deque<entry> expired;
+
+            // the least recently used sessions are at the back
+            while (!idle_.empty() && size_ > options_.min_size && now - idle_.back().last_used >= options_.idle_timeout) {
+                expired.push_back(std::move(idle_.back()));
+                idle_.pop_back();
+                --size_;
+            }
+
+            return expired;
+        }
+
+        void session_pool::fill()
+        {
+            size_t needed = 0;
+
+            {
+                lock_guard<mutex> lock(mutex_);
+
+                if (size_ >= options_.min_size) {
+                    return;
+                }
+                needed = options_.min_size - size_;
+                size_ += needed;
+            }
+
+            vector<shared_ptr<rj::db::session>> sessions;
+
+            try {
+                // open the sessions together so the handshakes overlap
+                sessions = sqldb::open_sessions(connectionInfo_, needed, options_.wait_timeout);
+            } catch (...) {
+                lock_guard<mutex> lock(mutex_);
+                size_ -= needed;
+                throw;
+            }
+
+            {
+                lock_guard<mutex> lock(mutex_);
+
+                for (auto &session : sessions) {
+                    idle_.push_back(entry{session, clock_type::now()});
+                }
+
+                // the rest can be opened on demand
+                size_ -= needed - sessions.size();
+            }
+
+            available_.notify_all();
+        }
+
+        size_t session_pool::evict_idle()
+        {
+            deque<entry> expired;
+
+            {
+                lock_guard<mutex> lock(mutex_);
+
+                expired = take_expired(clock_type::now());
+            }
+
+            return expired.size();
+        }
+
+        void session_pool::clear()
+        {
+            deque<entry> closing;
+
+            {
+                lock_guard<mutex> lock(mutex_);
+
+                size_ -= idle_.size();
+
+                closing.swap(idle_);
+            }
+
+            available_.notify_all();
+        }
+
+        size_t session_pool::size() const
+        {
+            lock_guard<mutex> lock(mutex_);
+            return size_;
+        }
+
+        size_t session_pool::idle() const
+        {
+            lock_guard<mutex> lock(mutex_);
+            return idle_.size();
+        }
+
+        size_t session_pool::in_use() const
+        {
+            lock_guard<mutex> lock(mutex_);
+            return size_ - idle_.size();
+        }
+
+        uri session_pool::connection_info() const
+        {
+            return connectionInfo_;
+        }
+
+        session_pool::options session_pool::get_options() const
+        {
+            return options_;
+        }
+    }
+}
@@ -0,0 +1,186 @@
+/*!
+ * @file session_pool.h
+ * a thread safe pool of database sessions
+ */
+#ifndef RJ_DB_SESSION_POOL_H
+#define RJ_DB_SESSION_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "uri.h"
+
+namespace rj
+{
+    namespace db
+    {
+        class session;
+
+        /*!
+         * keeps a set of open sessions for a uri that can be leased and returned
+         * a returned session has any open transaction rolled back and its identity map removed
+         */
+        class session_pool : public std::enable_shared_from_this<session_pool>
+        {
+           public:
+            typedef std::chrono::steady_clock clock_type;
+
+            /*!
+             * the sizing and timeout options for a pool
+             */
+            struct options {
+                /*! the number of sessions to keep open, even when idle */
+                size_t min_size;
+                /*! the maximum number of sessions to open */
+                size_t max_size;
+                /*! the maximum number of threads waiting on a lease */
+                size_t max_waiters;
+                /*! how long an idle session above the minimum size is kept */
+                std::chrono::milliseconds idle_timeout;
+                /*! how long to wait for a session before giving up */
+                std::chrono::milliseconds wait_timeout;
+
+                options();
+            };
+
+            /*!
+             * a leased session that is returned to the pool when destroyed
+             */
+            class lease
+            {
+                friend class session_pool;
+
+               private:
+                std::shared_ptr<session_pool> pool_;
+                std::shared_ptr<rj::db::session> session_;
+                lease(const std::shared_ptr<session_pool> &pool, const std::shared_ptr<rj::db::session> &session);
+
+               public:
+                lease();
+
+                /* non-copyable boilerplate */
+                lease(const lease &other) = delete;
+                lease(lease &&other);
+                lease &operator=(const lease &other) = delete;
+                lease &operator=(lease &&other);
+                ~lease();
+
+                /*!
+                 * @return the leased session or nullptr if released
+                 */
+                std::shared_ptr<rj::db::session> get() const;
+
+                rj::db::session *operator->() const;
+
+                rj::db::session &operator*() const;
+
+                /*!
+                 * returns the session to the pool early
+                 */
+                void release();
+
+                /*!
+                 * tests if a session is held
+                 * @return true if the lease holds a session
+                 */
+                bool is_valid() const;
+
+                explicit operator bool() const;
+            };
+
+           private:
+            struct entry {
+                std::shared_ptr<rj::db::session> session;
+                clock_type::time_point last_used;
+            };
+
+            uri connectionInfo_;
+            options options_;
+            std::deque<entry> idle_;
+            size_t size_;
+            size_t waiters_;
+            mutable std::mutex mutex_;
+            std::condition_variable available_;
+
+            std::shared_ptr<rj::db::session> create_session();
+            bool reset_session(const std::shared_ptr<rj::db::session> &session);
+            void release(const std::shared_ptr<rj::db::session> &session);
+            std::deque<entry> take_expired(const clock_type::time_point &now);
+
+            /*!
+             * @param info the connection info for sessions in this pool
+             * @param opts the sizing options
+             */
+            session_pool(const uri &info, const options &opts);
+
+           public:
+            /*!
+             * creates a pool, which is always shared as its leases hold a reference to it
+             * @param info the connection info for sessions in this pool
+             * @param opts the sizing options
+             * @return the pool
+             * @throws database_exception if the options are invalid
+             */
+            static std::shared_ptr<session_pool> create(const uri &info, const options &opts = options());
+
+            /* non-copyable boilerplate */
+            session_pool(const session_pool &other) = delete;
+            session_pool(session_pool &&other) = delete;
+            session_pool &operator=(const session_pool &other) = delete;
+            session_pool &operator=(session_pool &&other) = delete;
+            virtual ~session_pool();
+
+            /*!
+             * leases an open session, waiting up to the wait timeout if the pool is exhausted
+             * @return the leased session
+             * @throws database_exception if no session became available or the wait queue is full
+             */
+            lease acquire();
+
+            /*!
+             * opens sessions until the minimum size is reached
+             */
+            void fill();
+
+            /*!
+             * closes idle sessions that have passed the idle timeout, keeping the minimum size
+             * @return the number of sessions closed
+             */
+            size_t evict_idle();
+
+            /*!
+             * closes all idle sessions
+             */
+            void clear();
+
+            /*!
+             * @return the number of sessions owned by the pool, leased or idle
+             */
+            size_t size() const;
+
+            /*!
+             * @return the number of idle sessions
+             */
+            size_t idle() const;
+
+            /*!
+             * @return the number of leased sessions
+             */
+            size_t in_use() const;
+
+            /*!
+             * @return the connection info for this pool
+             */
+            uri connection_info() const;
+
+            /*!
+             * @return the options for this pool
+             */
+            options get_options() const;
+        };
+    }
+}
+
+#endif
@@ -2,7 +2,13 @@
 #include "config.h"
 #endif
 
+#include <errno.h>
+#include <poll.h>
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
 #include "exception.h"
+#include "log.h"
 #include "mysql/session.h"
 #include "postgres/session.h"
 #include "sqldb.h"
@@ -24,6 +30,64 @@ namespace rj
 
         RJ_IMPLEMENT_EXCEPTION(no_primary_key_exception, database_exception);
 
+        namespace helper
+        {
+            /*!
+             * the sessions opened by worker threads, shared so the threads can outlive a timeout
+             */
+            struct open_workers {
+                std::mutex mutex;
+                std::condition_variable done;
+                std::vector<std::shared_ptr<session>> pending;
+                std::vector<std::shared_ptr<session>> opened;
+                std::string error;
+                size_t next;
+                size_t finished;
+
+                open_workers() : next(0), finished(0)
+                {
+                }
+
+                void run()
+                {
+                    while (true) {
+                        std::shared_ptr<session> value;
+
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+
+                            if (next >= pending.size()) {
+                                return;
+                            }
+
+                            value = pending[next++];
+                        }
+
+                        std::string failure;
+
+                        try {
+                            value->open();
+                        } catch (const std::exception &e) {
+                            failure = e.what();
+                        }
+
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+
+                            if (failure.empty()) {
+                                opened.push_back(value);
+                            } else {
+                                error = failure;
+                            }
+                            finished++;
+                        }
+
+                        done.notify_all();
+                    }
+                }
+            };
+        }
+
         std::shared_ptr<session> sqldb::create_session(const std::string &uristr)
         {
             db::uri uri(uristr);
@@ -61,6 +125,122 @@ namespace rj
             return value;
         }
 
+        const size_t sqldb::MAX_OPEN_THREADS;
+
+        std::vector<std::shared_ptr<session>> sqldb::open_sessions(const std::string &uristr, size_t count, const std::chrono::milliseconds &timeout)
+        {
+            db::uri uri(uristr);
+            return open_sessions(uri, count, timeout);
+        }
+
+        std::vector<std::shared_ptr<session>> sqldb::open_sessions(const uri &uri, size_t count, const std::chrono::milliseconds &timeout)
+        {
+            typedef std::chrono::steady_clock clock_type;
+
+            auto deadline = clock_type::now() + timeout;
+
+            std::vector<std::shared_ptr<session>> opened;
+            std::vector<std::shared_ptr<session>> polling;
+            std::vector<session_impl::open_state> states;
+            std::string error;
+
+            auto workers = std::make_shared<helper::open_workers>();
+
+            for (size_t i = 0; i < count; i++) {
+                auto value = create_session(uri);
+
+                try {
+                    if (value->impl()->start_open()) {
+                        polling.push_back(value);
+                        // a started connection waits to be writable first
+                        states.push_back(session_impl::OpenWriting);
+                    } else {
+                        workers->pending.push_back(value);
+                    }
+                } catch (const database_exception &e) {
+                    error = e.what();
+                }
+            }
+
+            // backends that block while opening get a bounded number of threads
+            for (size_t i = 0; i < std::min(workers->pending.size(), MAX_OPEN_THREADS); i++) {
+                std::thread([workers]() { workers->run(); }).detach();
+            }
+
+            // drive all the other handshakes from one poll set
+            while (!polling.empty()) {
+                auto now = clock_type::now();
+
+                if (now >= deadline) {
+                    break;
+                }
+
+                std::vector<struct pollfd> fds(polling.size());
+
+                for (size_t i = 0; i < polling.size(); i++) {
+                    fds[i].fd = polling[i]->socket();
+                    fds[i].events = states[i] == session_impl::OpenReading ? POLLIN : POLLOUT;
+                    fds[i].revents = 0;
+                }
+
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+
+                if (poll(fds.data(), fds.size(), static_cast<int>(wait) + 1) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    error = "unable to poll opening sessions";
+                    break;
+                }
+
+                for (size_t i = polling.size(); i-- > 0;) {
+                    if (fds[i].revents == 0) {
+                        continue;
+                    }
+
+                    try {
+                        states[i] = polling[i]->impl()->poll_open();
+
+                        if (states[i] != session_impl::OpenReady) {
+                            continue;
+                        }
+
+                        opened.push_back(polling[i]);
+                    } catch (const database_exception &e) {
+                        error = e.what();
+                    }
+
+                    polling.erase(polling.begin() + i);
+                    states.erase(states.begin() + i);
+                }
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(workers->mutex);
+
+                workers->done.wait_until(lock, deadline, [&workers]() { return workers->finished >= workers->pending.size(); });
+
+                // sessions still opening are left to their threads and discarded
+                opened.insert(opened.end(), workers->opened.begin(), workers->opened.end());
+
+                workers->opened.clear();
+
+                if (!workers->error.empty()) {
+                    error = workers->error;
+                }
+            }
+
+            if (opened.size() < count) {
+                log::warn("opened %zu of %zu sessions: %s", opened.size(), count, error.empty() ? "timed out" : error.c_str());
+            }
+
+            if (opened.empty() && count > 0) {
+                throw database_exception(error.empty() ? "timed out opening sessions" : error);
+            }
+
+            return opened;
+        }
+
         void sqldb::register_session(const std::string &protocol, const std::shared_ptr<session_factory> &factory)
         {
             if (protocol.empty()) {
@@ -74,6 +254,54 @@ namespace rj
             instance()->factories_[protocol] = factory;
         }
 
+        std::shared_ptr<session_pool> sqldb::open_pool(const std::string &uristr, const session_pool::options &opts)
+        {
+            db::uri uri(uristr);
+            return open_pool(uri, opts);
+        }
+
+        std::shared_ptr<session_pool> sqldb::open_pool(const uri &uri, const session_pool::options &opts)
+        {
+            std::shared_ptr<session_pool> pool;
+
+            {
+                std::lock_guard<std::mutex> lock(instance()->pools_mutex_);
+
+                auto &value = instance()->pools_[uri.value];
+
+                if (value == nullptr) {
+                    value = session_pool::create(uri, opts);
+                }
+
+                pool = value;
+            }
+
+            pool->fill();
+
+            return pool;
+        }
+
+        void sqldb::close_pool(const uri &uri)
+        {
+            std::shared_ptr<session_pool> pool;
+
+            {
+                std::lock_guard<std::mutex> lock(instance()->pools_mutex_);
+
+                auto it = instance()->pools_.find(uri.value);
+
+                if (it == instance()->pools_.end()) {
+                    return;
+                }
+
+                pool = it->second;
+
+                instance()->pools_.erase(it);
+            }
+
+            pool->clear();
+        }
+
         sqldb *sqldb::instance()
         {
             static sqldb instance_;
@@ -1,10 +1,14 @@
 #ifndef RJ_DB_SQLDB_H
 #define RJ_DB_SQLDB_H
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 #include "session.h"
 #include "session_factory.h"
+#include "session_pool.h"
 #include "uri.h"
 
 namespace rj
@@ -74,6 +78,29 @@ namespace rj
              */
             static std::shared_ptr<rj::db::session> open_session(const uri &value);
 
+            /*! the number of threads used to open sessions for backends that can not open without blocking */
+            constexpr static const size_t MAX_OPEN_THREADS = 8;
+
+            /*!
+             * creates and opens a number of sessions at once, overlapping their connection handshakes
+             * @param value the uri for the sessions
+             * @param count the number of sessions to open
+             * @param timeout how long to wait for the sessions to open
+             * @return the sessions that opened before the timeout
+             */
+            static std::vector<std::shared_ptr<rj::db::session>> open_sessions(const uri &value, size_t count,
+                                                                               const std::chrono::milliseconds &timeout = std::chrono::seconds(30));
+
+            /*!
+             * parses a uri, then creates and opens a number of sessions at once
+             * @param value the uri string to parse
+             * @param count the number of sessions to open
+             * @param timeout how long to wait for the sessions to open
+             * @return the sessions that opened before the timeout
+             */
+            static std::vector<std::shared_ptr<rj::db::session>> open_sessions(const std::string &value, size_t count,
+                                                                               const std::chrono::milliseconds &timeout = std::chrono::seconds(30));
+
             /*!
              * registers a handler for a session protocol
              * ex. "sqlite", my_sqlite_factory
@@ -82,6 +109,29 @@ namespace rj
              */
             static void register_session(const std::string &protocol, const std::shared_ptr<session_factory> &factory);
 
+            /*!
+             * gets the session pool for a uri, creating and filling it if needed
+             * @param value the uri for the pool
+             * @param opts the pool options, only used when the pool is created
+             * @return the shared session pool for the uri
+             */
+            static std::shared_ptr<session_pool> open_pool(const uri &value, const session_pool::options &opts = session_pool::options());
+
+            /*!
+             * parses a uri and gets its session pool
+             * @param value the uri string to parse
+             * @param opts the pool options, only used when the pool is created
+             * @return the shared session pool for the uri
+             */
+            static std::shared_ptr<session_pool> open_pool(const std::string &value,
+                                                           const session_pool::options &opts = session_pool::options());
+
+            /*!
+             * removes the session pool for a uri, idle sessions are closed when the last lease is returned
+             * @param value the uri for the pool
+             */
+            static void close_pool(const uri &value);
+
            private:
             static sqldb *instance();
             sqldb();
@@ -91,6 +141,8 @@ namespace rj
             sqldb &operator=(sqldb &&other) = delete;
             virtual ~sqldb();
             std::unordered_map<std::string, std::shared_ptr<session_factory>> factories_;
+            std::unordered_map<std::string, std::shared_ptr<session_pool>> pools_;
+            std::mutex pools_mutex_;
         };
     }
 }
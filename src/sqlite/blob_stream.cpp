@@ -0,0 +1,118 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBSQLITE3
+
+#include "blob_stream.h"
+#include "../exception.h"
+#include "../log.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        namespace sqlite
+        {
+            namespace helper
+            {
+                bool end_blob_savepoint(sqlite3 *db, bool keep)
+                {
+                    if (!keep && sqlite3_exec(db, "ROLLBACK TO rj_blob", nullptr, nullptr, nullptr) != SQLITE_OK) {
+                        return false;
+                    }
+
+                    return sqlite3_exec(db, "RELEASE rj_blob", nullptr, nullptr, nullptr) == SQLITE_OK;
+                }
+            }
+
+            blob_reader::blob_reader(const shared_ptr<sqlite3> &db, sqlite3_blob *blob) : db_(db), blob_(blob)
+            {
+            }
+
+            blob_reader::~blob_reader()
+            {
+                if (blob_ != nullptr) {
+                    sqlite3_blob_close(blob_);
+                }
+            }
+
+            size_t blob_reader::size() const
+            {
+                return sqlite3_blob_bytes(blob_);
+            }
+
+            void blob_reader::read_at(void *buffer, size_t length, size_t offset)
+            {
+                if (sqlite3_blob_read(blob_, buffer, static_cast<int>(length), static_cast<int>(offset)) != SQLITE_OK) {
+                    throw database_exception(sqlite3_errmsg(db_.get()));
+                }
+            }
+
+            blob_writer::blob_writer(const shared_ptr<sqlite3> &db, sqlite3_blob *blob) : db_(db), blob_(blob)
+            {
+            }
+
+            blob_writer::~blob_writer()
+            {
+                if (blob_ == nullptr) {
+                    return;
+                }
+
+                log::warn("blob writer was not closed, discarding the value");
+
+                sqlite3_blob_close(blob_);
+
+                helper::end_blob_savepoint(db_.get(), false);
+            }
+
+            size_t blob_writer::size() const
+            {
+                return blob_ == nullptr ? 0 : sqlite3_blob_bytes(blob_);
+            }
+
+            void blob_writer::write_next(const void *buffer, size_t length)
+            {
+                if (blob_ == nullptr) {
+                    throw database_exception("blob writer is closed");
+                }
+
+                if (position_ + length > size()) {
+                    throw database_exception("blob write is past the size it was opened with");
+                }
+
+                if (sqlite3_blob_write(blob_, buffer, static_cast<int>(length), static_cast<int>(position_)) != SQLITE_OK) {
+                    throw database_exception(sqlite3_errmsg(db_.get()));
+                }
+            }
+
+            void blob_writer::close()
+            {
+                if (blob_ == nullptr) {
+                    return;
+                }
+
+                auto blob = blob_;
+
+                // the handle is released either way, close reports the error of a failed write
+                blob_ = nullptr;
+
+                if (sqlite3_blob_close(blob) != SQLITE_OK) {
+                    string error = sqlite3_errmsg(db_.get());
+                    helper::end_blob_savepoint(db_.get(), false);
+                    throw database_exception(error);
+                }
+
+                if (!helper::end_blob_savepoint(db_.get(), true)) {
+                    string error = sqlite3_errmsg(db_.get());
+                    helper::end_blob_savepoint(db_.get(), false);
+                    throw database_exception(error);
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,102 @@
+/*!
+ * @file blob_stream.h
+ * incremental blob io for sqlite
+ */
+#ifndef RJ_DB_SQLITE_BLOB_STREAM_H
+#define RJ_DB_SQLITE_BLOB_STREAM_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBSQLITE3
+
+#include <sqlite3.h>
+#include <memory>
+#include "../blob_stream.h"
+
+namespace rj
+{
+    namespace db
+    {
+        namespace sqlite
+        {
+            /*!
+             * reads a blob with sqlite3_blob_read
+             */
+            class blob_reader : public rj::db::blob_reader
+            {
+               private:
+                std::shared_ptr<sqlite3> db_;
+                sqlite3_blob *blob_;
+
+               protected:
+                void read_at(void *buffer, size_t length, size_t offset);
+
+               public:
+                /*!
+                 * @param db the connection the blob was opened on
+                 * @param blob the open blob handle, closed with the reader
+                 */
+                blob_reader(const std::shared_ptr<sqlite3> &db, sqlite3_blob *blob);
+
+                virtual ~blob_reader();
+
+                size_t size() const;
+            };
+
+            namespace helper
+            {
+                /*!
+                 * ends the savepoint a blob writer is opened in
+                 * @param db the connection
+                 * @param keep true to keep the changes, false to roll them back
+                 * @return true if the savepoint was ended
+                 */
+                bool end_blob_savepoint(sqlite3 *db, bool keep);
+            }
+
+            /*!
+             * writes a blob with sqlite3_blob_write
+             * the column is first set to a zeroblob of the final size, as a blob handle can not change the size
+             * the writer runs in a savepoint, so the column only changes when it is closed
+             */
+            class blob_writer : public rj::db::blob_writer
+            {
+               private:
+                std::shared_ptr<sqlite3> db_;
+                sqlite3_blob *blob_;
+
+               protected:
+                void write_next(const void *buffer, size_t length);
+
+               public:
+                /*!
+                 * @param db the connection the blob was opened on
+                 * @param blob the open blob handle, closed with the writer
+                 */
+                blob_writer(const std::shared_ptr<sqlite3> &db, sqlite3_blob *blob);
+
+                /*!
+                 * discards the value if the writer was not closed
+                 */
+                virtual ~blob_writer();
+
+                /*!
+                 * @return the size of the blob in bytes
+                 */
+                size_t size() const;
+
+                /*!
+                 * closes the blob and keeps the value, anything not written is left as zeros
+                 * @throws database_exception if the value could not be saved, in which case nothing is changed
+                 */
+                void close();
+            };
+        }
+    }
+}
+
+#endif
+
+#endif
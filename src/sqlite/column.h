@@ -19,6 +19,11 @@ namespace rj
     {
         namespace sqlite
         {
+            namespace data_mapper
+            {
+                sql_value to_value(const std::shared_ptr<sqlite3_stmt> &stmt, int column);
+            }
+
             /*!
              * a sqlite specific implementation of a column
              */
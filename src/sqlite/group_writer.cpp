@@ -0,0 +1,248 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBSQLITE3
+
+#include <algorithm>
+#include "../exception.h"
+#include "../log.h"
+#include "../session.h"
+#include "../statement.h"
+#include "group_writer.h"
+#include "session.h"
+
+using namespace std;
+
+namespace rj
+{
+    namespace db
+    {
+        namespace sqlite
+        {
+            namespace helper
+            {
+                /*!
+                 * holds the sql and values of a queued write
+                 */
+                class queued_query : public modify_query
+                {
+                   private:
+                    string sql_;
+
+                   public:
+                    queued_query(const std::shared_ptr<rj::db::session> &session, const string &sql) : modify_query(session), sql_(sql)
+                    {
+                    }
+
+                    string to_string() const
+                    {
+                        return sql_;
+                    }
+                };
+            }
+
+            struct group_writer::request {
+                helper::queued_query query;
+                promise<write_result> result;
+
+                request(const std::shared_ptr<rj::db::session> &session, const string &sql) : query(session, sql)
+                {
+                }
+            };
+
+            constexpr const size_t group_writer::DEFAULT_MAX_BATCH;
+
+            group_writer::group_writer(const std::shared_ptr<rj::db::session> &session, size_t maxBatch)
+                : session_(session), maxBatch_(std::max<size_t>(1, maxBatch)), stopping_(false)
+            {
+                if (session_ == nullptr || session_->impl<sqlite::session>() == nullptr) {
+                    throw database_exception("group writer requires a sqlite session");
+                }
+
+                if (!session_->is_open()) {
+                    throw database_exception("database is not open");
+                }
+
+                worker_ = thread(&group_writer::run, this);
+            }
+
+            group_writer::~group_writer()
+            {
+                try {
+                    stop();
+                } catch (const std::exception &e) {
+                    log::error("unable to stop group writer: %s", e.what());
+                }
+            }
+
+            future<write_result> group_writer::enqueue(const shared_ptr<request> &value)
+            {
+                auto result = value->result.get_future();
+
+                {
+                    lock_guard<mutex> lock(mutex_);
+
+                    if (stopping_) {
+                        throw database_exception("group writer is stopped");
+                    }
+
+                    queue_.push_back(value);
+                }
+
+                ready_.notify_one();
+
+                return result;
+            }
+
+            future<write_result> group_writer::submit(const modify_query &query)
+            {
+                auto value = make_shared<request>(session_, query.to_string());
+
+                query.bind_params(value->query);
+
+                return enqueue(value);
+            }
+
+            future<write_result> group_writer::submit(const string &sql, const vector<sql_value> &values)
+            {
+                auto value = make_shared<request>(session_, sql);
+
+                for (size_t i = 0; i < values.size(); i++) {
+                    value->query.bind_value(i + 1, values[i]);
+                }
+
+                return enqueue(value);
+            }
+
+            size_t group_writer::pending()
+            {
+                lock_guard<mutex> lock(mutex_);
+
+                return queue_.size();
+            }
+
+            void group_writer::stop()
+            {
+                {
+                    lock_guard<mutex> lock(mutex_);
+
+                    stopping_ = true;
+                }
+
+                ready_.notify_one();
+
+                if (worker_.joinable()) {
+                    worker_.join();
+                }
+            }
+
+            void group_writer::run()
+            {
+                for (;;) {
+                    vector<shared_ptr<request>> batch;
+
+                    {
+                        unique_lock<mutex> lock(mutex_);
+
+                        ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+
+                        if (queue_.empty()) {
+                            return;
+                        }
+
+                        // everything queued while the last batch was syncing goes in this one
+                        while (!queue_.empty() && batch.size() < maxBatch_) {
+                            batch.push_back(queue_.front());
+                            queue_.pop_front();
+                        }
+                    }
+
+                    write(batch);
+                }
+            }
+
+            void group_writer::savepoint(const string &sql)
+            {
+                if (!session_->execute(sql)) {
+                    throw database_exception(session_->last_error());
+                }
+            }
+
+            void group_writer::write(const vector<shared_ptr<request>> &batch)
+            {
+                vector<write_result> results(batch.size());
+                vector<exception_ptr> errors(batch.size());
+
+                bool begun = false;
+
+                try {
+                    if (!session_->execute("BEGIN IMMEDIATE")) {
+                        throw database_exception(session_->last_error());
+                    }
+
+                    begun = true;
+
+                    for (size_t i = 0; i < batch.size(); i++) {
+                        // each write can fail on its own without losing the others
+                        savepoint("SAVEPOINT group_write");
+
+                        try {
+                            auto stmt = session_->create_statement();
+
+                            stmt->prepare(batch[i]->query.to_string());
+
+                            batch[i]->query.bind_params(*stmt);
+
+                            if (!stmt->result()) {
+                                throw database_exception(stmt->last_error());
+                            }
+
+                            results[i].changes = stmt->last_number_of_changes();
+                            results[i].last_insert_id = stmt->last_insert_id();
+
+                            stmt->reset();
+                        } catch (...) {
+                            errors[i] = current_exception();
+
+                            // without the savepoint the failed write could be committed with the others, so the batch fails
+                            savepoint("ROLLBACK TO group_write");
+                        }
+
+                        savepoint("RELEASE group_write");
+                    }
+
+                    begun = false;
+
+                    if (!session_->execute("COMMIT")) {
+                        auto error = session_->last_error();
+                        session_->execute("ROLLBACK");
+                        throw database_exception(error);
+                    }
+                } catch (...) {
+                    auto error = current_exception();
+
+                    if (begun && !session_->execute("ROLLBACK")) {
+                        log::error("unable to roll back a failed group write: %s", session_->last_error().c_str());
+                    }
+
+                    for (auto &value : batch) {
+                        value->result.set_exception(error);
+                    }
+                    return;
+                }
+
+                // only report results once they are durable
+                for (size_t i = 0; i < batch.size(); i++) {
+                    if (errors[i]) {
+                        batch[i]->result.set_exception(errors[i]);
+                    } else {
+                        batch[i]->result.set_value(results[i]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,119 @@
+/*!
+ * @file group_writer.h
+ * commits many small sqlite writes together from a dedicated thread
+ */
+#ifndef RJ_DB_SQLITE_GROUP_WRITER_H
+#define RJ_DB_SQLITE_GROUP_WRITER_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_LIBSQLITE3
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../modify_query.h"
+
+namespace rj
+{
+    namespace db
+    {
+        namespace sqlite
+        {
+            /*!
+             * the outcome of one write
+             */
+            struct write_result {
+                /*! the number of rows changed */
+                int changes;
+                /*! the last inserted row id of the connection */
+                long long last_insert_id;
+            };
+
+            /*!
+             * a thread that owns the write connection and drains queued writes in batches
+             * each batch runs in one BEGIN IMMEDIATE / COMMIT, so many writes share one sync to disk
+             * a failed write is rolled back to its own savepoint without failing the rest of the batch
+             */
+            class group_writer
+            {
+               public:
+                /*! the default maximum number of writes in one transaction */
+                constexpr static const size_t DEFAULT_MAX_BATCH = 256;
+
+               private:
+                struct request;
+
+                std::shared_ptr<rj::db::session> session_;
+                size_t maxBatch_;
+                std::deque<std::shared_ptr<request>> queue_;
+                std::mutex mutex_;
+                std::condition_variable ready_;
+                bool stopping_;
+                std::thread worker_;
+
+                void run();
+                void write(const std::vector<std::shared_ptr<request>> &batch);
+
+                /*!
+                 * executes a savepoint statement of a batch
+                 * @param sql the savepoint sql
+                 * @throws database_exception if it failed, which fails the whole batch
+                 */
+                void savepoint(const std::string &sql);
+                std::future<write_result> enqueue(const std::shared_ptr<request> &value);
+
+               public:
+                /*!
+                 * @param session an open sqlite session, which must not be used elsewhere while the writer runs
+                 * @param maxBatch the maximum number of writes in one transaction
+                 * @throws database_exception if the session is not an open sqlite session
+                 */
+                group_writer(const std::shared_ptr<rj::db::session> &session, size_t maxBatch = DEFAULT_MAX_BATCH);
+
+                /* non-copyable boilerplate */
+                group_writer(const group_writer &other) = delete;
+                group_writer(group_writer &&other) = delete;
+                group_writer &operator=(const group_writer &other) = delete;
+                group_writer &operator=(group_writer &&other) = delete;
+                virtual ~group_writer();
+
+                /*!
+                 * queues an insert, update or delete with its bound values
+                 * @param query the query to write, it can be reused once this returns
+                 * @return the future result, or a database_exception if the write failed
+                 */
+                std::future<write_result> submit(const modify_query &query);
+
+                /*!
+                 * queues a sql statement
+                 * @param sql the sql to execute
+                 * @param values the indexed values to bind
+                 * @return the future result, or a database_exception if the write failed
+                 */
+                std::future<write_result> submit(const std::string &sql, const std::vector<sql_value> &values = {});
+
+                /*!
+                 * @return the number of writes waiting for the thread
+                 */
+                size_t pending();
+
+                /*!
+                 * writes everything queued and stops the thread, further submits throw
+                 */
+                void stop();
+            };
+        }
+    }
+}
+
+#endif
+
+#endif
@@ -1,5 +1,6 @@
 #include "resultset.h"
 #include "../log.h"
+#include "column.h"
 #include "row.h"
 #include "session.h"
 
@@ -14,7 +15,7 @@ namespace rj
         namespace sqlite
         {
             resultset::resultset(const std::shared_ptr<sqlite::session> &sess, const shared_ptr<sqlite3_stmt> &stmt)
-                : stmt_(stmt), sess_(sess), status_(-1)
+                : stmt_(stmt), sess_(sess), status_(-1), position_(0), rowCount_(-1)
             {
                 if (sess_ == nullptr) {
                     throw database_exception("No database provided to sqlite3 resultset");
@@ -25,7 +26,12 @@ namespace rj
                 }
             }
 
-            resultset::resultset(resultset &&other) : stmt_(std::move(other.stmt_)), sess_(std::move(other.sess_)), status_(other.status_)
+            resultset::resultset(resultset &&other)
+                : stmt_(std::move(other.stmt_)),
+                  sess_(std::move(other.sess_)),
+                  status_(other.status_),
+                  position_(other.position_),
+                  rowCount_(other.rowCount_)
             {
                 other.sess_ = nullptr;
                 other.stmt_ = nullptr;
@@ -33,6 +39,10 @@ namespace rj
 
             resultset::~resultset()
             {
+                // unfinished results keep a read transaction open until the statement is reset
+                if (status_ == SQLITE_ROW && stmt_ != nullptr) {
+                    sqlite3_reset(stmt_.get());
+                }
             }
 
             resultset &resultset::operator=(resultset &&other)
@@ -40,6 +50,8 @@ namespace rj
                 stmt_ = std::move(other.stmt_);
                 sess_ = std::move(other.sess_);
                 status_ = other.status_;
+                position_ = other.position_;
+                rowCount_ = other.rowCount_;
                 other.sess_ = nullptr;
                 other.stmt_ = nullptr;
 
@@ -61,9 +73,20 @@ namespace rj
                     return false;
                 }
 
-                status_ = sqlite3_step(stmt_.get());
+                // a busy lock is only retried before any rows are read
+                status_ = sess_->step(stmt_.get(), position_ == 0);
+
+                if (status_ == SQLITE_ROW) {
+                    position_++;
+                    return true;
+                }
 
-                return status_ == SQLITE_ROW;
+                // sqlite only knows the number of rows once they have all been stepped through
+                if (status_ == SQLITE_DONE) {
+                    rowCount_ = position_;
+                }
+
+                return false;
             }
 
             void resultset::reset()
@@ -74,14 +97,49 @@ namespace rj
                 }
 
                 if (sqlite3_reset(stmt_.get()) != SQLITE_OK) {
-                    throw database_exception(sess_->last_error());
+                    throw database_exception(sess_->last_error(sqlite3_db_handle(stmt_.get())));
                 }
                 status_ = -1;
+                position_ = 0;
+                // the statement runs again, so the rows may have changed
+                rowCount_ = -1;
+            }
+
+            long long resultset::row_count()
+            {
+                return rowCount_;
+            }
+
+            size_t resultset::column_count() const
+            {
+                if (!is_valid()) {
+                    return 0;
+                }
+
+                return sqlite3_column_count(stmt_.get());
+            }
+
+            string resultset::column_name(size_t position) const
+            {
+                if (position >= column_count()) {
+                    throw no_such_column_exception();
+                }
+
+                return sqlite3_column_name(stmt_.get(), position);
+            }
+
+            sql_value resultset::column_value(size_t position) const
+            {
+                if (position >= column_count()) {
+                    throw no_such_column_exception();
+                }
+
+                return data_mapper::to_value(stmt_, position);
             }
 
             resultset::row_type resultset::current_row()
             {
-                return row_type(make_shared<row>(sess_, stmt_));
+                return row_type(make_shared<row>(sess_, stmt_, names()));
             }
         }
     }
@@ -34,6 +34,8 @@ namespace rj
                 std::shared_ptr<sqlite3_stmt> stmt_;
                 std::shared_ptr<sqlite::session> sess_;
                 int status_;
+                long long position_;
+                long long rowCount_;
 
                public:
                 /*!
@@ -54,6 +56,10 @@ namespace rj
                 row_type current_row();
                 void reset();
                 bool next();
+                long long row_count();
+                size_t column_count() const;
+                std::string column_name(size_t position) const;
+                sql_value column_value(size_t position) const;
             };
         }
     }
@@ -12,7 +12,8 @@ namespace rj
     {
         namespace sqlite
         {
-            row::row(const std::shared_ptr<sqlite::session> &sess, const shared_ptr<sqlite3_stmt> &stmt) : row_impl(), stmt_(stmt), sess_(sess)
+            row::row(const std::shared_ptr<sqlite::session> &sess, const shared_ptr<sqlite3_stmt> &stmt, const shared_ptr<column_names> &names)
+                : row_impl(), stmt_(stmt), sess_(sess), names_(names)
             {
                 if (sess_ == NULL) {
                     throw database_exception("no database provided to sqlite3 row");
@@ -25,7 +26,12 @@ namespace rj
                 size_ = sqlite3_column_count(stmt_.get());
             }
 
-            row::row(row &&other) : row_impl(std::move(other)), stmt_(std::move(other.stmt_)), sess_(std::move(other.sess_)), size_(other.size_)
+            row::row(row &&other)
+                : row_impl(std::move(other)),
+                  stmt_(std::move(other.stmt_)),
+                  sess_(std::move(other.sess_)),
+                  size_(other.size_),
+                  names_(std::move(other.names_))
             {
                 other.stmt_ = nullptr;
                 other.sess_ = nullptr;
@@ -41,6 +47,7 @@ namespace rj
                 stmt_ = std::move(other.stmt_);
                 sess_ = std::move(other.sess_);
                 size_ = other.size_;
+                names_ = std::move(other.names_);
                 other.stmt_ = nullptr;
                 other.sess_ = nullptr;
 
@@ -62,6 +69,16 @@ namespace rj
                     throw no_such_column_exception();
                 }
 
+                if (names_ != nullptr) {
+                    int index = names_->index_of(name);
+
+                    if (index < 0) {
+                        throw no_such_column_exception(name);
+                    }
+
+                    return column(index);
+                }
+
                 for (size_t i = 0; i < size_; i++) {
                     const char *col_name = sqlite3_column_name(stmt_.get(), i);
 
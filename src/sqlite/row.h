@@ -31,13 +31,16 @@ namespace rj
                 std::shared_ptr<sqlite3_stmt> stmt_;
                 std::shared_ptr<sqlite::session> sess_;
                 size_t size_;
+                std::shared_ptr<rj::db::column_names> names_;
 
                public:
                 /*!
                  * @param db    the database in use
                  * @param stmt  the query statement in use
+                 * @param names  the column name lookups shared by the results, or nullptr to scan the names
                  */
-                row(const std::shared_ptr<sqlite::session> &sess, const std::shared_ptr<sqlite3_stmt> &stmt);
+                row(const std::shared_ptr<sqlite::session> &sess, const std::shared_ptr<sqlite3_stmt> &stmt,
+                    const std::shared_ptr<rj::db::column_names> &names = nullptr);
 
                 /* non-copyable boilerplate */
                 virtual ~row();
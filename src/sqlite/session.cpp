@@ -4,8 +4,14 @@
 
 #ifdef HAVE_LIBSQLITE3
 
+#include <algorithm>
+#include <cctype>
+#include <random>
 #include <sstream>
+#include <thread>
+#include "../log.h"
 #include "../schema.h"
+#include "blob_stream.h"
 #include "resultset.h"
 #include "session.h"
 #include "statement.h"
@@ -29,20 +35,104 @@ namespace rj
                         }
                     }
                 };
+
+                void stmt_reset::operator()(sqlite3_stmt *p) const
+                {
+                    if (p != nullptr) {
+                        // ends a read transaction left open by unfinished results
+                        sqlite3_reset(p);
+                        sqlite3_clear_bindings(p);
+                    }
+                }
+
+                /*!
+                 * tests if sql starts with a keyword that can only read
+                 */
+                static bool starts_with_select(const string &sql)
+                {
+                    size_t pos = 0;
+
+                    while (pos < sql.size() && (isspace(sql[pos]) || sql[pos] == '(')) {
+                        pos++;
+                    }
+
+                    string keyword;
+
+                    while (pos < sql.size() && isalpha(sql[pos])) {
+                        keyword += toupper(sql[pos++]);
+                    }
+
+                    return keyword == "SELECT" || keyword == "WITH" || keyword == "VALUES";
+                }
+
+                static transaction::type parse_transaction_type(const string &value)
+                {
+                    if (value.empty()) {
+                        return transaction::none;
+                    }
+                    if (value == "deferred") {
+                        return transaction::deferred;
+                    }
+                    if (value == "immediate") {
+                        return transaction::immediate;
+                    }
+                    if (value == "exclusive") {
+                        return transaction::exclusive;
+                    }
+                    throw database_exception("unknown transaction type " + value);
+                }
             }
 
+            constexpr const char *const session::READERS_PARAM;
+            constexpr const char *const session::BUSY_TIMEOUT_PARAM;
+            constexpr const char *const session::TRANSACTION_PARAM;
+
             std::shared_ptr<rj::db::session_impl> factory::create(const uri &uri)
             {
                 return std::make_shared<session>(uri);
             }
 
-            session::session(const uri &info) : session_impl(info), db_(nullptr)
+            session::session(const uri &info)
+                : session_impl(info),
+                  db_(nullptr),
+                  nextReader_(0),
+                  busy_({std::chrono::milliseconds(1), std::chrono::milliseconds(100), std::chrono::milliseconds(5000)}),
+                  transactionType_(helper::parse_transaction_type(info.param(TRANSACTION_PARAM))),
+                  lockWaits_(0),
+                  lockFailures_(0)
             {
+                auto timeout = info.param(BUSY_TIMEOUT_PARAM);
+
+                if (!timeout.empty()) {
+                    try {
+                        busy_.timeout = std::chrono::milliseconds(std::stoi(timeout));
+                    } catch (const std::exception &e) {
+                        throw database_exception("unable to parse busy timeout " + timeout);
+                    }
+                }
             }
 
-            session::session(session &&other) : session_impl(std::move(other)), db_(std::move(other.db_))
+            session::session(session &&other)
+                : session_impl(std::move(other)),
+                  db_(std::move(other.db_)),
+                  statements_(std::move(other.statements_)),
+                  readers_(std::move(other.readers_)),
+                  nextReader_(other.nextReader_),
+                  busy_(other.busy_),
+                  transactionType_(other.transactionType_),
+                  lockWaits_(other.lockWaits_.load()),
+                  lockFailures_(other.lockFailures_.load())
             {
                 other.db_ = nullptr;
+                other.statements_.clear();
+                other.readers_.clear();
+
+                // the busy handlers point at the session
+                init_connection(db_.get());
+
+                for (auto &r : readers_) {
+                    init_connection(r->db.get());
+                }
             }
 
             session &session::operator=(session &&other)
@@ -50,7 +140,22 @@ namespace rj
                 session_impl::operator=(std::move(other));
 
                 db_ = std::move(other.db_);
+                statements_ = std::move(other.statements_);
+                readers_ = std::move(other.readers_);
+                nextReader_ = other.nextReader_;
+                busy_ = other.busy_;
+                transactionType_ = other.transactionType_;
+                lockWaits_ = other.lockWaits_.load();
+                lockFailures_ = other.lockFailures_.load();
                 other.db_ = nullptr;
+                other.statements_.clear();
+                other.readers_.clear();
+
+                init_connection(db_.get());
+
+                for (auto &r : readers_) {
+                    init_connection(r->db.get());
+                }
 
                 return *this;
             }
@@ -109,6 +214,238 @@ namespace rj
                 }
 
                 db_ = shared_ptr<sqlite3>(conn, helper::close_db());
+
+                init_connection(conn);
+
+                open_readers();
+            }
+
+            void session::init_connection(sqlite3 *conn)
+            {
+                if (conn != nullptr) {
+                    sqlite3_busy_handler(conn, &session::busy_handler, this);
+                }
+            }
+
+            int session::busy_handler(void *arg, int count)
+            {
+                // a thread waits on one lock at a time, and sqlite counts from zero for each
+                static thread_local std::chrono::steady_clock::time_point started;
+
+                if (count == 0) {
+                    started = std::chrono::steady_clock::now();
+                }
+
+                return static_cast<session *>(arg)->backoff(count, started) ? 1 : 0;
+            }
+
+            bool session::backoff(int attempt, const std::chrono::steady_clock::time_point &started)
+            {
+                static thread_local std::minstd_rand jitter(std::random_device{}());
+
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+
+                if (elapsed >= busy_.timeout) {
+                    return false;
+                }
+
+                std::chrono::milliseconds delay(busy_.initial_delay.count() << std::min(attempt, 20));
+
+                delay = std::max(std::chrono::milliseconds(1), std::min(delay, busy_.max_delay));
+
+                // somewhere in the upper half of the delay
+                delay -= std::chrono::milliseconds(jitter() % (delay.count() / 2 + 1));
+
+                delay = std::min<std::chrono::milliseconds>(delay, busy_.timeout - elapsed);
+
+                lockWaits_++;
+
+                std::this_thread::sleep_for(delay);
+
+                return true;
+            }
+
+            int session::step(sqlite3_stmt *stmt, bool retry)
+            {
+                auto started = std::chrono::steady_clock::now();
+
+                int res;
+
+                for (int attempt = 0;; attempt++) {
+                    res = sqlite3_step(stmt);
+
+                    // a locked table does not call the busy handler
+                    if (res != SQLITE_LOCKED || !retry) {
+                        break;
+                    }
+
+                    // inside a transaction, the lock may be waiting on this connection
+                    if (!sqlite3_get_autocommit(sqlite3_db_handle(stmt)) || !backoff(attempt, started)) {
+                        break;
+                    }
+                }
+
+                if (res == SQLITE_BUSY || res == SQLITE_LOCKED) {
+                    lockFailures_++;
+                }
+
+                return res;
+            }
+
+            void session::set_busy_strategy(const busy_strategy &value)
+            {
+                busy_ = value;
+            }
+
+            busy_strategy session::get_busy_strategy() const
+            {
+                return busy_;
+            }
+
+            void session::set_transaction_type(transaction::type value)
+            {
+                transactionType_ = value;
+            }
+
+            transaction::type session::transaction_type() const
+            {
+                return transactionType_;
+            }
+
+            unsigned long long session::lock_waits() const
+            {
+                return lockWaits_;
+            }
+
+            unsigned long long session::lock_failures() const
+            {
+                return lockFailures_;
+            }
+
+            void session::open_readers()
+            {
+                auto info = connection_info();
+
+                int count = 0;
+
+                try {
+                    count = std::stoi(info.param(READERS_PARAM, "0"));
+                } catch (const std::exception &e) {
+                    throw database_exception("unable to parse readers " + info.param(READERS_PARAM));
+                }
+
+                if (count <= 0) {
+                    return;
+                }
+
+                if (info.path.empty() || info.path == ":memory:") {
+                    log::warn("an in memory sqlite database can not have readers");
+                    return;
+                }
+
+                // readers only run next to the writer with write ahead logging
+                if (!execute("PRAGMA journal_mode=WAL")) {
+                    throw database_exception(last_error());
+                }
+
+                for (int i = 0; i < count; i++) {
+                    sqlite3 *conn = nullptr;
+
+                    // a session may be read from many threads, so the readers serialize their own calls
+                    if (sqlite3_open_v2(info.path.c_str(), &conn, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI | SQLITE_OPEN_FULLMUTEX, nullptr) != SQLITE_OK) {
+                        string error = last_error(conn);
+                        sqlite3_close(conn);
+                        close();
+                        throw database_exception(error);
+                    }
+
+                    auto r = make_shared<reader>();
+
+                    r->db = shared_ptr<sqlite3>(conn, helper::close_db());
+
+                    init_connection(conn);
+                    r->statements.capacity(statements_.capacity());
+
+                    readers_.push_back(r);
+                }
+            }
+
+            size_t session::reader_count() const
+            {
+                return readers_.size();
+            }
+
+            bool session::is_read(const string &sql) const
+            {
+                // inside a transaction the writer has to see its own changes
+                return !readers_.empty() && db_ != nullptr && sqlite3_get_autocommit(db_.get()) && helper::starts_with_select(sql);
+            }
+
+            shared_ptr<sqlite3_stmt> session::prepare_read(const string &sql)
+            {
+                if (!is_read(sql)) {
+                    return nullptr;
+                }
+
+                lock_guard<mutex> lock(readerMutex_);
+
+                auto r = readers_[nextReader_++ % readers_.size()];
+
+                // a returned statement was already reset
+                auto cached = r->statements.get(sql);
+
+                if (cached != nullptr) {
+                    return cached;
+                }
+
+                sqlite3_stmt *temp;
+
+                // ex. a temp or attached table, or a schema the reader has not seen yet, can still run on the writer
+                if (sqlite3_prepare_v2(r->db.get(), sql.c_str(), -1, &temp, nullptr) != SQLITE_OK) {
+                    log::debug("unable to prepare on a reader, using the writer: %s", last_error(r->db.get()).c_str());
+                    sqlite3_finalize(temp);
+                    return nullptr;
+                }
+
+                // a statement that writes after all, ex. a common table expression, belongs on the writer
+                if (!sqlite3_stmt_readonly(temp)) {
+                    sqlite3_finalize(temp);
+                    return nullptr;
+                }
+
+                return r->statements.put(sql, shared_ptr<sqlite3_stmt>(temp, helper::stmt_delete()));
+            }
+
+            shared_ptr<sqlite3_stmt> session::prepare(const string &sql)
+            {
+                if (db_ == nullptr) {
+                    throw database_exception("database not open");
+                }
+
+                auto stmt = prepare_read(sql);
+
+                if (stmt != nullptr) {
+                    return stmt;
+                }
+
+                return prepare_write(sql);
+            }
+
+            shared_ptr<sqlite3_stmt> session::prepare_write(const string &sql)
+            {
+                auto cached = statements_.get(sql);
+
+                if (cached != nullptr) {
+                    return cached;
+                }
+
+                sqlite3_stmt *temp;
+
+                if (sqlite3_prepare_v2(db_.get(), sql.c_str(), -1, &temp, nullptr) != SQLITE_OK) {
+                    throw database_exception(last_error());
+                }
+
+                return statements_.put(sql, shared_ptr<sqlite3_stmt>(temp, helper::stmt_delete()));
             }
 
             bool session::is_open() const
@@ -118,19 +455,29 @@ namespace rj
 
             void session::close()
             {
+                // statements must be finalized before the connection can close
+                statements_.clear();
+
+                readers_.clear();
+
                 // the shared_ptr destructor should close
                 db_ = nullptr;
             }
 
             string session::last_error() const
             {
-                if (db_ == nullptr) {
+                return last_error(db_.get());
+            }
+
+            string session::last_error(sqlite3 *conn) const
+            {
+                if (conn == nullptr) {
                     return string();
                 }
                 ostringstream buf;
 
-                buf << sqlite3_errcode(db_.get());
-                buf << ": " << sqlite3_errmsg(db_.get());
+                buf << sqlite3_errcode(conn);
+                buf << ": " << sqlite3_errmsg(conn);
 
                 return buf.str();
             }
@@ -151,6 +498,12 @@ namespace rj
                 return sqlite3_changes(db_.get());
             }
 
+            bool session::in_transaction() const
+            {
+                // transactions only run on the writer
+                return db_ != nullptr && !sqlite3_get_autocommit(db_.get());
+            }
+
             std::shared_ptr<resultset_impl> session::query(const string &sql)
             {
                 sqlite3_stmt *stmt;
@@ -159,6 +512,12 @@ namespace rj
                     throw database_exception("session::execute database not open");
                 }
 
+                auto read = prepare_read(sql);
+
+                if (read != nullptr) {
+                    return make_shared<resultset>(shared_from_this(), read);
+                }
+
                 if (sqlite3_prepare_v2(db_.get(), sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
                     throw database_exception(last_error());
                 }
@@ -178,7 +537,7 @@ namespace rj
                     return false;
                 }
 
-                int res = sqlite3_step(stmt);
+                int res = step(stmt);
 
                 sqlite3_finalize(stmt);
 
@@ -192,13 +551,162 @@ namespace rj
 
             std::shared_ptr<transaction_impl> session::create_transaction() const
             {
-                return make_shared<sqlite::transaction>(db_);
+                return make_shared<sqlite::transaction>(db_, transactionType_);
             }
 
             std::shared_ptr<transaction_impl> session::create_transaction(transaction::type type) const
             {
                 return make_shared<sqlite::transaction>(db_, type);
             }
+
+            size_t session::max_parameters() const
+            {
+                if (db_ == nullptr) {
+                    return session_impl::max_parameters();
+                }
+
+                // 999 before sqlite 3.32, 32766 after, unless compiled otherwise
+                return sqlite3_limit(db_.get(), SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+            }
+
+            void session::set_statement_cache_size(size_t value)
+            {
+                statements_.capacity(value);
+
+                lock_guard<mutex> lock(readerMutex_);
+
+                for (auto &r : readers_) {
+                    r->statements.capacity(value);
+                }
+            }
+
+            size_t session::statement_cache_size() const
+            {
+                return statements_.capacity();
+            }
+
+            unsigned long long session::statement_cache_hits() const
+            {
+                lock_guard<mutex> lock(readerMutex_);
+
+                auto hits = statements_.hits();
+
+                for (auto &r : readers_) {
+                    hits += r->statements.hits();
+                }
+
+                return hits;
+            }
+
+            unsigned long long session::statement_cache_misses() const
+            {
+                lock_guard<mutex> lock(readerMutex_);
+
+                auto misses = statements_.misses();
+
+                for (auto &r : readers_) {
+                    misses += r->statements.misses();
+                }
+
+                return misses;
+            }
+
+            void session::clear_statement_cache()
+            {
+                statements_.clear();
+
+                lock_guard<mutex> lock(readerMutex_);
+
+                for (auto &r : readers_) {
+                    r->statements.clear();
+                }
+            }
+
+            long long session::find_rowid(const std::shared_ptr<schema> &schema, const sql_value &id)
+            {
+                auto stmt = create_statement();
+
+                stmt->prepare("SELECT rowid FROM " + schema->table_name() + " WHERE " + schema->primary_key() + " = $1");
+
+                stmt->bind_value(1, id);
+
+                auto rs = stmt->results();
+
+                if (!rs.next()) {
+                    throw database_exception("no row in " + schema->table_name() + " for " + id.to_string());
+                }
+
+                return rs.current_row().column(0).to_value().to_llong();
+            }
+
+            std::shared_ptr<rj::db::blob_reader> session::open_blob_reader(const std::shared_ptr<schema> &schema, const string &column,
+                                                                           const sql_value &id)
+            {
+                if (!is_open()) {
+                    throw database_exception("database is not open");
+                }
+
+                auto rowid = find_rowid(schema, id);
+
+                sqlite3_blob *blob = nullptr;
+
+                if (sqlite3_blob_open(db_.get(), "main", schema->table_name().c_str(), column.c_str(), rowid, 0, &blob) != SQLITE_OK) {
+                    auto error = last_error();
+                    sqlite3_blob_close(blob);
+                    throw database_exception(error);
+                }
+
+                return make_shared<sqlite::blob_reader>(db_, blob);
+            }
+
+            std::shared_ptr<rj::db::blob_writer> session::open_blob_writer(const std::shared_ptr<schema> &schema, const string &column,
+                                                                           const sql_value &id, size_t size)
+            {
+                if (!is_open()) {
+                    throw database_exception("database is not open");
+                }
+
+                // the zeroblob is only kept if the writer is closed
+                if (sqlite3_exec(db_.get(), "SAVEPOINT rj_blob", nullptr, nullptr, nullptr) != SQLITE_OK) {
+                    throw database_exception(last_error());
+                }
+
+                sqlite3_blob *blob = nullptr;
+
+                try {
+                    auto stmt = create_statement();
+
+                    // a blob handle can only overwrite, so make room for the whole value first
+                    stmt->prepare("UPDATE " + schema->table_name() + " SET " + column + " = zeroblob($1) WHERE " + schema->primary_key() +
+                                  " = $2");
+
+                    stmt->bind(1, static_cast<long long>(size));
+
+                    stmt->bind_value(2, id);
+
+                    if (!stmt->result()) {
+                        throw database_exception(stmt->last_error());
+                    }
+
+                    if (stmt->last_number_of_changes() == 0) {
+                        throw database_exception("no row in " + schema->table_name() + " for " + id.to_string());
+                    }
+
+                    stmt->reset();
+
+                    auto rowid = find_rowid(schema, id);
+
+                    if (sqlite3_blob_open(db_.get(), "main", schema->table_name().c_str(), column.c_str(), rowid, 1, &blob) != SQLITE_OK) {
+                        throw database_exception(last_error());
+                    }
+                } catch (...) {
+                    sqlite3_blob_close(blob);
+                    helper::end_blob_savepoint(db_.get(), false);
+                    throw;
+                }
+
+                return make_shared<sqlite::blob_writer>(db_, blob);
+            }
         }
     }
 }
@@ -11,8 +11,14 @@
 #ifdef HAVE_LIBSQLITE3
 
 #include <sqlite3.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "../session.h"
 #include "../session_factory.h"
+#include "../statement_cache.h"
 #include "transaction.h"
 
 namespace rj
@@ -27,16 +33,115 @@ namespace rj
                 std::shared_ptr<rj::db::session_impl> create(const uri &uri);
             };
 
+            namespace helper
+            {
+                /*!
+                 * helper to reset a cached statement when it is returned
+                 */
+                struct stmt_reset {
+                    void operator()(sqlite3_stmt *p) const;
+                };
+            }
+
+            /*!
+             * how a connection waits for a lock held by another connection or process
+             * the waits double from the initial delay up to the max delay, with random jitter so waiters don't retry in step
+             */
+            struct busy_strategy {
+                /*! the first wait */
+                std::chrono::milliseconds initial_delay;
+                /*! the longest single wait */
+                std::chrono::milliseconds max_delay;
+                /*! the total time to wait before failing, zero fails immediately */
+                std::chrono::milliseconds timeout;
+            };
+
             /*!
              * a sqlite specific implementation of a database
+             * with a readers parameter in the uri, ex. file://test.db?readers=4, the database uses write ahead logging
+             * and the session opens that many read only connections next to its writer
+             * selects outside of a transaction run on the readers, everything else runs on the writer
+             * the uri can also set a busy_timeout in milliseconds and a transaction type of deferred, immediate or exclusive
              */
             class session : public rj::db::session_impl, public std::enable_shared_from_this<session>
             {
                 friend class factory;
                 friend class statement;
 
+               public:
+                /*! the uri parameter for the number of read only connections */
+                constexpr static const char *const READERS_PARAM = "readers";
+
+                /*! the uri parameter for the busy strategy timeout in milliseconds */
+                constexpr static const char *const BUSY_TIMEOUT_PARAM = "busy_timeout";
+
+                /*! the uri parameter for the type of transactions started */
+                constexpr static const char *const TRANSACTION_PARAM = "transaction";
+
                protected:
+                /*!
+                 * a read only connection and its statements
+                 */
+                struct reader {
+                    std::shared_ptr<sqlite3> db;
+                    statement_cache<sqlite3_stmt, helper::stmt_reset> statements;
+                };
+
                 std::shared_ptr<sqlite3> db_;
+                statement_cache<sqlite3_stmt, helper::stmt_reset> statements_;
+                std::vector<std::shared_ptr<reader>> readers_;
+                size_t nextReader_;
+                mutable std::mutex readerMutex_;
+                busy_strategy busy_;
+                transaction::type transactionType_;
+                std::atomic<unsigned long long> lockWaits_;
+                std::atomic<unsigned long long> lockFailures_;
+
+                /*!
+                 * called by sqlite when a connection is busy
+                 */
+                static int busy_handler(void *arg, int count);
+
+                /*!
+                 * waits before another attempt at a lock
+                 * @param attempt the number of attempts so far
+                 * @param started when the first attempt was made
+                 * @return false if the busy strategy has run out of time
+                 */
+                bool backoff(int attempt, const std::chrono::steady_clock::time_point &started);
+
+                /*!
+                 * configures a newly opened connection
+                 */
+                void init_connection(sqlite3 *conn);
+
+                /*!
+                 * opens the read only connections requested by the uri
+                 */
+                void open_readers();
+
+                /*!
+                 * tests if sql can run on a reader
+                 */
+                bool is_read(const std::string &sql) const;
+
+                /*!
+                 * prepares sql on a reader
+                 * @return the statement, or nullptr if it has to run on the writer, including when the reader can not prepare it
+                 */
+                std::shared_ptr<sqlite3_stmt> prepare_read(const std::string &sql);
+
+                /*!
+                 * prepares sql on the writer
+                 * @return the statement
+                 */
+                std::shared_ptr<sqlite3_stmt> prepare_write(const std::string &sql);
+
+                /*!
+                 * gets the rowid of a row for blob io
+                 * @throws database_exception if the row was not found
+                 */
+                long long find_rowid(const std::shared_ptr<schema> &schema, const sql_value &id);
 
                public:
                 /*!
@@ -61,9 +166,83 @@ namespace rj
                 std::shared_ptr<resultset_impl> query(const std::string &sql);
                 bool execute(const std::string &sql);
                 std::string last_error() const;
+                bool in_transaction() const;
+
+                /*!
+                 * gets the last error of one of the session's connections
+                 * @param conn the connection
+                 * @return the last error or an empty string
+                 */
+                std::string last_error(sqlite3 *conn) const;
+
+                /*!
+                 * prepares a statement on the connection for the sql, reusing a cached one if it is idle
+                 * @param sql the sql to prepare
+                 * @return the statement
+                 * @throws database_exception if the sql could not be prepared
+                 */
+                std::shared_ptr<sqlite3_stmt> prepare(const std::string &sql);
+
+                /*!
+                 * @return the number of read only connections
+                 */
+                size_t reader_count() const;
+
+                /*!
+                 * steps a statement, retrying a locked table with the busy strategy
+                 * a busy database is already waited on by the busy handler of the connection
+                 * @param stmt the statement
+                 * @param retry false if the statement has returned rows, so it can not start over
+                 * @return the sqlite result code
+                 */
+                int step(sqlite3_stmt *stmt, bool retry = true);
+
+                /*!
+                 * sets how connections wait for locks, applies to connections opened afterwards as well
+                 * @param value the strategy
+                 */
+                void set_busy_strategy(const busy_strategy &value);
+
+                /*!
+                 * @return how connections wait for locks
+                 */
+                busy_strategy get_busy_strategy() const;
+
+                /*!
+                 * sets the type of transactions started by this session
+                 * immediate transactions take the write lock up front, so they can wait for it instead of failing to upgrade later
+                 * @param value the transaction type
+                 */
+                void set_transaction_type(transaction::type value);
+
+                /*!
+                 * @return the type of transactions started by this session
+                 */
+                transaction::type transaction_type() const;
+
+                /*!
+                 * @return the number of times a connection waited for a lock
+                 */
+                unsigned long long lock_waits() const;
+
+                /*!
+                 * @return the number of times a statement failed because of a lock
+                 */
+                unsigned long long lock_failures() const;
+
                 std::shared_ptr<statement_type> create_statement();
                 std::shared_ptr<transaction_impl> create_transaction() const;
                 std::shared_ptr<transaction_impl> create_transaction(transaction::type type) const;
+                size_t max_parameters() const;
+                void set_statement_cache_size(size_t value);
+                size_t statement_cache_size() const;
+                unsigned long long statement_cache_hits() const;
+                unsigned long long statement_cache_misses() const;
+                void clear_statement_cache();
+                std::shared_ptr<rj::db::blob_reader> open_blob_reader(const std::shared_ptr<schema> &schema, const std::string &column,
+                                                                      const sql_value &id);
+                std::shared_ptr<rj::db::blob_writer> open_blob_writer(const std::shared_ptr<schema> &schema, const std::string &column,
+                                                                      const sql_value &id, size_t size);
 
                 /*! @copydoc
                  *  overriden for sqlite3 specific pragma parsing
@@ -30,7 +30,8 @@ namespace rj
                 }
             }
 
-            statement::statement(statement &&other) : sess_(std::move(other.sess_)), stmt_(std::move(other.stmt_))
+            statement::statement(statement &&other)
+                : sess_(std::move(other.sess_)), stmt_(std::move(other.stmt_)), values_(std::move(other.values_))
             {
                 other.stmt_ = nullptr;
                 other.sess_ = NULL;
@@ -40,6 +41,7 @@ namespace rj
             {
                 sess_ = std::move(other.sess_);
                 stmt_ = std::move(other.stmt_);
+                values_ = std::move(other.values_);
 
                 other.stmt_ = nullptr;
                 other.sess_ = NULL;
@@ -62,13 +64,53 @@ namespace rj
                     return;
                 }
 
-                sqlite3_stmt *temp;
+                // the session picks a reader or the writer
+                stmt_ = sess_->prepare(sql);
 
-                if (sqlite3_prepare_v2(sess_->db_.get(), sql.c_str(), -1, &temp, NULL) != SQLITE_OK) {
-                    throw database_exception(sess_->last_error());
+                values_.clear();
+            }
+
+            void statement::remember(size_t index, const sql_value &value)
+            {
+                // only statements that can move need their values
+                if (sess_->readers_.empty()) {
+                    return;
                 }
 
-                stmt_ = shared_ptr<sqlite3_stmt>(temp, helper::stmt_delete());
+                if (values_.size() < index) {
+                    values_.resize(index);
+                }
+
+                values_[index - 1] = value;
+            }
+
+            void statement::route()
+            {
+                if (sess_->readers_.empty() || sess_->db_ == nullptr) {
+                    return;
+                }
+
+                string sql = sqlite3_sql(stmt_.get());
+
+                shared_ptr<sqlite3_stmt> moved;
+
+                if (sqlite3_db_handle(stmt_.get()) == sess_->db_.get()) {
+                    // stays on the writer if it can not run on a reader now
+                    moved = sess_->prepare_read(sql);
+                } else if (!sess_->is_read(sql)) {
+                    // inside a transaction a select has to see the changes of the writer
+                    moved = sess_->prepare_write(sql);
+                }
+
+                if (moved == nullptr) {
+                    return;
+                }
+
+                stmt_ = moved;
+
+                for (size_t i = 0; i < values_.size(); i++) {
+                    bind_value(i + 1, values_[i]);
+                }
             }
 
             bool statement::is_valid() const
@@ -83,6 +125,10 @@ namespace rj
 
             string statement::last_error()
             {
+                // the statement may be on a read only connection
+                if (is_valid()) {
+                    return sess_->last_error(sqlite3_db_handle(stmt_.get()));
+                }
                 return sess_->last_error();
             }
 
@@ -92,8 +138,9 @@ namespace rj
                     throw binding_error("statment invalid");
                 }
                 if (sqlite3_bind_int(stmt_.get(), index, value) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, value);
                 return *this;
             }
             statement &statement::bind(size_t index, unsigned value)
@@ -102,8 +149,9 @@ namespace rj
                     throw binding_error("statment invalid");
                 }
                 if (sqlite3_bind_int64(stmt_.get(), index, value) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, value);
                 return *this;
             }
             statement &statement::bind(size_t index, long long value)
@@ -112,8 +160,9 @@ namespace rj
                     throw binding_error("statment invalid");
                 }
                 if (sqlite3_bind_int64(stmt_.get(), index, value) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, value);
                 return *this;
             }
             statement &statement::bind(size_t index, unsigned long long value)
@@ -126,8 +175,9 @@ namespace rj
                     throw binding_error("statment invalid");
                 }
                 if (sqlite3_bind_double(stmt_.get(), index, value) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, value);
                 return *this;
             }
             statement &statement::bind(size_t index, double value)
@@ -136,8 +186,9 @@ namespace rj
                     throw binding_error("statment invalid");
                 }
                 if (sqlite3_bind_double(stmt_.get(), index, value) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, value);
                 return *this;
             }
             statement &statement::bind(size_t index, const std::string &value, int len)
@@ -146,8 +197,9 @@ namespace rj
                     throw binding_error("statment invalid");
                 }
                 if (sqlite3_bind_text(stmt_.get(), index, value.c_str(), len, SQLITE_TRANSIENT) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, len < 0 ? value : value.substr(0, len));
                 return *this;
             }
             statement &statement::bind(size_t index, const std::wstring &value, int len)
@@ -156,8 +208,9 @@ namespace rj
                     throw binding_error("statment invalid");
                 }
                 if (sqlite3_bind_text16(stmt_.get(), index, value.c_str(), len, SQLITE_TRANSIENT) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, len < 0 ? value : value.substr(0, len / sizeof(wchar_t)));
                 return *this;
             }
             statement &statement::bind(size_t index, const sql_blob &value)
@@ -167,8 +220,9 @@ namespace rj
                 }
                 if (sqlite3_bind_blob(stmt_.get(), index, value.value(), value.size(), value.is_transient() ? SQLITE_TRANSIENT : SQLITE_STATIC) !=
                     SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, value);
                 return *this;
             }
 
@@ -178,8 +232,9 @@ namespace rj
                     throw binding_error("statment invalid");
                 }
                 if (sqlite3_bind_null(stmt_.get(), index) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, sql_value());
                 return *this;
             }
             statement &statement::bind(size_t index, const sql_time &value)
@@ -191,8 +246,9 @@ namespace rj
                 auto tstr = value.to_string();
 
                 if (sqlite3_bind_text(stmt_.get(), index, tstr.c_str(), tstr.size(), SQLITE_TRANSIENT) != SQLITE_OK) {
-                    throw binding_error(sess_->last_error());
+                    throw binding_error(last_error());
                 }
+                remember(index, value);
                 return *this;
             }
 
@@ -218,21 +274,35 @@ namespace rj
                     throw database_exception("sqlite statement results invalid database");
                 }
 
+                if (is_valid()) {
+                    route();
+                }
+
                 return resultset_type(make_shared<resultset>(sess_, stmt_));
             }
 
+            statement::resultset_type statement::stream_results()
+            {
+                // sqlite already steps through rows as they are read
+                return results();
+            }
+
             bool statement::result()
             {
                 if (!is_valid()) {
                     log::warn("sqlite statement result invalid");
                     return false;
                 }
-                return sqlite3_step(stmt_.get()) == SQLITE_DONE;
+
+                route();
+
+                return sess_->step(stmt_.get()) == SQLITE_DONE;
             }
 
             void statement::finish()
             {
                 stmt_ = nullptr;
+                values_.clear();
             }
 
             void statement::reset()
@@ -253,6 +323,12 @@ namespace rj
                 }
                 return sess_->last_insert_id();
             }
+
+            vector<long long> statement::last_insert_ids()
+            {
+                // sqlite only reports the last rowid of a multi row insert
+                return vector<long long>();
+            }
         }
     }
 }
@@ -12,6 +12,8 @@
 #ifdef HAVE_LIBSQLITE3
 
 #include <sqlite3.h>
+#include <vector>
+#include "../sql_value.h"
 #include "../statement.h"
 
 namespace rj
@@ -24,12 +26,24 @@ namespace rj
 
             /*!
              * a sqlite specific implementation of a statement
+             * with readers, the statement moves between a reader and the writer as a transaction starts or ends
              */
             class statement : public rj::db::statement
             {
                private:
                 std::shared_ptr<sqlite::session> sess_;
                 std::shared_ptr<sqlite3_stmt> stmt_;
+                std::vector<sql_value> values_;
+
+                /*!
+                 * keeps a bound value to bind again if the statement moves to another connection
+                 */
+                void remember(size_t index, const sql_value &value);
+
+                /*!
+                 * moves the statement to the connection it should execute on now
+                 */
+                void route();
 
                public:
                 /*!
@@ -48,12 +62,14 @@ namespace rj
                 void prepare(const std::string &sql);
                 bool is_valid() const;
                 resultset_type results();
+                resultset_type stream_results();
                 bool result();
                 void finish();
                 void reset();
                 int last_number_of_changes();
                 std::string last_error();
                 long long last_insert_id();
+                std::vector<long long> last_insert_ids();
 
                 /* bindable overrides */
                 statement &bind(size_t index, int value);
@@ -5,6 +5,7 @@
 #ifndef RJ_DB_STATEMENT_H
 #define RJ_DB_STATEMENT_H
 
+#include <vector>
 #include "bindable.h"
 #include "resultset.h"
 
@@ -50,6 +51,22 @@ namespace rj
              */
             virtual resultset_type results() = 0;
 
+            /*!
+             * starts executing this statement without waiting, the next call to results or result reads what was sent
+             * @return true if the statement was sent, false if the backend can only execute it synchronously
+             */
+            virtual bool send_query()
+            {
+                return false;
+            }
+
+            /*!
+             * executes this statement, fetching rows from the server as they are read
+             * the results can only be read once, and the session is busy until they are exhausted
+             * @return a set of the results
+             */
+            virtual resultset_type stream_results() = 0;
+
             /*!
              * executes this statement
              * @return true if successful
@@ -73,6 +90,12 @@ namespace rj
              * @return the last insert id or zero
              */
             virtual long long last_insert_id() = 0;
+
+            /*!
+             * gets every id generated by the last execution, for backends that report them
+             * @return the generated ids in row order, zero for a row without one, or an empty list
+             */
+            virtual std::vector<long long> last_insert_ids() = 0;
         };
     }
 }
@@ -0,0 +1,221 @@
+/*!
+ * @file statement_cache.h
+ * a least recently used cache of prepared statement handles
+ */
+#ifndef RJ_DB_STATEMENT_CACHE_H
+#define RJ_DB_STATEMENT_CACHE_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace rj
+{
+    namespace db
+    {
+        /*!
+         * caches database specific statement handles by their sql
+         * a checked out handle is returned, and reset with the Reset functor, when the last copy of it is released
+         * a handle is only checked out again once it has been returned
+         */
+        template <typename T, typename Reset>
+        class statement_cache
+        {
+           public:
+            typedef std::shared_ptr<T> value_type;
+
+            /*! the default number of statements to keep */
+            constexpr static const size_t DEFAULT_CAPACITY = 32;
+
+           private:
+            typedef std::list<std::string> order_type;
+
+            typedef std::shared_ptr<std::atomic<bool>> busy_type;
+
+            /*!
+             * the deleter of a checked out handle, which keeps the handle alive even if it was evicted
+             */
+            struct release {
+                value_type value;
+                busy_type busy;
+
+                void operator()(T *p) const
+                {
+                    // reset before it can be checked out again, so it holds no locks or results while idle
+                    Reset()(p);
+                    busy->store(false);
+                }
+            };
+
+            struct entry {
+                value_type value;
+                busy_type busy;
+                typename order_type::iterator order;
+            };
+
+            size_t capacity_;
+            unsigned long long hits_;
+            unsigned long long misses_;
+            order_type order_;
+            std::unordered_map<std::string, entry> values_;
+
+            void evict()
+            {
+                if (order_.empty()) {
+                    return;
+                }
+                values_.erase(order_.back());
+                order_.pop_back();
+            }
+
+            value_type checkout(entry &e)
+            {
+                e.busy->store(true);
+
+                return value_type(e.value.get(), release{e.value, e.busy});
+            }
+
+           public:
+            /*!
+             * @param capacity the number of statements to keep, zero disables caching
+             */
+            statement_cache(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity), hits_(0), misses_(0)
+            {
+            }
+
+            /*!
+             * checks out an idle statement for the sql
+             * @param sql the sql of the statement
+             * @return the reset statement handle or nullptr if none is idle
+             */
+            value_type get(const std::string &sql)
+            {
+                if (capacity_ == 0) {
+                    return nullptr;
+                }
+
+                auto it = values_.find(sql);
+
+                // a statement still held by a query or result set is busy
+                if (it == values_.end() || it->second.busy->load()) {
+                    ++misses_;
+                    return nullptr;
+                }
+
+                ++hits_;
+
+                order_.splice(order_.begin(), order_, it->second.order);
+
+                return checkout(it->second);
+            }
+
+            /*!
+             * adds a newly prepared statement, evicting the least recently used
+             * @param sql the sql of the statement
+             * @param value the statement handle
+             * @return the checked out handle to use in place of value
+             */
+            value_type put(const std::string &sql, const value_type &value)
+            {
+                if (capacity_ == 0 || value == nullptr) {
+                    return value;
+                }
+
+                auto it = values_.find(sql);
+
+                if (it != values_.end()) {
+                    // replace a busy statement, its holders keep it alive
+                    it->second.value = value;
+                    it->second.busy = std::make_shared<std::atomic<bool>>(false);
+                    order_.splice(order_.begin(), order_, it->second.order);
+                    return checkout(it->second);
+                }
+
+                while (values_.size() >= capacity_) {
+                    evict();
+                }
+
+                order_.push_front(sql);
+
+                auto &e = values_[sql];
+
+                e = entry{value, std::make_shared<std::atomic<bool>>(false), order_.begin()};
+
+                return checkout(e);
+            }
+
+            /*!
+             * gets the handle a checked out handle refers to
+             * @param value a handle from get or put
+             * @return the handle as it was put in the cache
+             */
+            static value_type owner(const value_type &value)
+            {
+                auto r = std::get_deleter<release>(value);
+
+                return r != nullptr ? r->value : value;
+            }
+
+            /*!
+             * removes all statements
+             */
+            void clear()
+            {
+                values_.clear();
+                order_.clear();
+            }
+
+            /*!
+             * @return the number of statements to keep
+             */
+            size_t capacity() const
+            {
+                return capacity_;
+            }
+
+            /*!
+             * sets the number of statements to keep
+             * @param value the capacity, zero disables caching
+             */
+            void capacity(size_t value)
+            {
+                capacity_ = value;
+
+                while (values_.size() > capacity_) {
+                    evict();
+                }
+            }
+
+            /*!
+             * @return the number of cached statements
+             */
+            size_t size() const
+            {
+                return values_.size();
+            }
+
+            /*!
+             * @return the number of times an idle statement was reused
+             */
+            unsigned long long hits() const
+            {
+                return hits_;
+            }
+
+            /*!
+             * @return the number of times a statement had to be prepared
+             */
+            unsigned long long misses() const
+            {
+                return misses_;
+            }
+        };
+
+        template <typename T, typename Reset>
+        constexpr const size_t statement_cache<T, Reset>::DEFAULT_CAPACITY;
+    }
+}
+
+#endif
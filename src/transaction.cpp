@@ -1,5 +1,6 @@
 #include "transaction.h"
 #include "exception.h"
+#include "identity_map.h"
 #include "log.h"
 #include "session.h"
 #include "sqldb.h"
@@ -73,6 +74,13 @@ namespace rj
             if (!session_->execute("ROLLBACK;")) {
                 throw transaction_exception("unable to rollback transaction: " + session_->last_error());
             }
+
+            // loaded records may hold values that were rolled back
+            auto identities = session_->get_identity_map();
+
+            if (identities != nullptr) {
+                identities->clear();
+            }
         }
 
         void transaction::save(const std::string &name)
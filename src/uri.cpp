@@ -22,6 +22,22 @@ namespace rj
         {
             return value;
         }
+        string uri_type::param(const string &name, const string &defaultValue) const
+        {
+            istringstream buf(query);
+            string pair;
+
+            while (getline(buf, pair, '&')) {
+                auto eq = pair.find('=');
+
+                if (pair.substr(0, eq) == name) {
+                    return eq == string::npos ? string() : pair.substr(eq + 1);
+                }
+            }
+
+            return defaultValue;
+        }
+
         void uri_type::parse(const string &url_s)
         {
             value = url_s;
@@ -26,6 +26,14 @@ namespace rj
 
             operator std::string() const;
 
+            /*!
+             * gets a parameter from the query string, ex. readers in file://test.db?readers=4
+             * @param name the parameter name
+             * @param defaultValue the value if the parameter is missing
+             * @return the parameter value
+             */
+            std::string param(const std::string &name, const std::string &defaultValue = std::string()) const;
+
             std::string protocol, user, password, host, port, path, query, value;
         };
     }
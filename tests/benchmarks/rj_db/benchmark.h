@@ -7,6 +7,10 @@ void benchmark_insert(rj::db::insert_query &insert, const std::shared_ptr<rj::db
 
 void benchmark_select(const std::string &tableName);
 
+void benchmark_select_view(const std::string &tableName);
+
+void benchmark_select_rows(const std::string &tableName);
+
 void benchmark_setup(const rj::db::uri &uri_s);
 
 void benchmark_populate(benchpress::context *context);
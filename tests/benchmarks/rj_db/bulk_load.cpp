@@ -0,0 +1,66 @@
+#ifndef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <benchpress/benchpress.hpp>
+#include "benchmark.h"
+#include "log.h"
+#include "postgres/bulk_loader.h"
+#include "postgres/session.h"
+#include "testicle.h"
+
+#if defined(HAVE_LIBPQ)
+
+using namespace rj::db;
+
+void benchmark_bulk_load(benchpress::context *context, postgres::bulk_loader::format format)
+{
+    auto uri_s = get_env_uri("POSTGRES_URI", "postgres://localhost/test");
+
+    benchmark_setup(uri_s);
+
+    postgres::bulk_loader loader(current_session->impl<postgres::session>(), user::TABLE_NAME, {"first_name", "last_name", "dval"}, format);
+
+    context->reset_timer();
+
+    for (size_t i = 0; i < context->num_iterations(); i++) {
+        loader.values(random_name(), random_name(), random_num<double>(-123012, 1231232));
+    }
+
+    if (loader.finish() != static_cast<long long>(context->num_iterations())) {
+        rj::db::log::error("bulk load did not load all rows");
+    }
+
+    context->stop_timer();
+
+    teardown_current_session();
+}
+
+BENCHMARK("postgres batch insert", [](benchpress::context *context) {
+    auto uri_s = get_env_uri("POSTGRES_URI", "postgres://localhost/test");
+
+    benchmark_setup(uri_s);
+
+    rj::db::insert_query query(current_session);
+
+    query.flags(insert_query::Buffered);
+
+    query.into(user::TABLE_NAME).columns("first_name", "last_name", "dval");
+
+    context->reset_timer();
+
+    for (size_t i = 0; i < context->num_iterations(); i++) {
+        benchmark_insert(query, current_session);
+    }
+
+    query.flush();
+
+    context->stop_timer();
+
+    teardown_current_session();
+});
+
+BENCHMARK("postgres text copy", [](benchpress::context *context) { benchmark_bulk_load(context, postgres::bulk_loader::text); });
+
+BENCHMARK("postgres binary copy", [](benchpress::context *context) { benchmark_bulk_load(context, postgres::bulk_loader::binary); });
+
+#endif
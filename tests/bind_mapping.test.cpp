@@ -0,0 +1,93 @@
+#include <bandit/bandit.h>
+#include "bind_mapping.h"
+
+using namespace bandit;
+
+using namespace std;
+
+using namespace rj::db;
+
+#ifdef ENHANCED_PARAMETER_MAPPING
+
+vector<string> find_parameter_names(const string &sql, bool backslashEscapes = false)
+{
+    vector<string> names;
+
+    for (auto &param : helper::find_parameters(sql, backslashEscapes)) {
+        names.push_back(sql.substr(param.offset, param.length));
+    }
+
+    return names;
+}
+
+go_bandit([]() {
+
+    describe("bind mapping", []() {
+
+        it("can find parameters", []() {
+            auto params = helper::find_parameters("a = $1 and c = @name or d = :other");
+
+            Assert::That(params.size(), Equals(3));
+
+            Assert::That(params[0].type, Equals('$'));
+
+            Assert::That(params[0].number, Equals(1));
+
+            Assert::That(params[1].type, Equals('@'));
+
+            Assert::That(params[2].type, Equals(':'));
+
+            params = helper::find_parameters("a = ? and b = @name");
+
+            Assert::That(params.size(), Equals(2));
+
+            Assert::That(params[0].type, Equals('?'));
+        });
+
+        it("does not mix ? and $n parameters", []() {
+            AssertThrows(binding_error, helper::find_parameters("a = $1 and b = ?"));
+
+            AssertThrows(binding_error, helper::find_parameters("a = ? and b = $2"));
+        });
+
+        it("skips quotes and comments", []() {
+            auto names = find_parameter_names("select '?', \"$1\", 'it''s ?' from t where x = ? -- $1 \n and y = ? /* @x */");
+
+            Assert::That(names.size(), Equals(2));
+
+            Assert::That(names[0], Equals("?"));
+
+            Assert::That(names[1], Equals("?"));
+
+            names = find_parameter_names("select $$ ? $$, $tag$ @a $tag$ from t where q = $10");
+
+            Assert::That(names.size(), Equals(1));
+
+            Assert::That(names[0], Equals("$10"));
+
+            names = find_parameter_names("select 'a\\' ?' from t where a = ?", true);
+
+            Assert::That(names.size(), Equals(1));
+
+            Assert::That(names[0], Equals("?"));
+
+            // escape strings use backslashes even without the flag
+            names = find_parameter_names("select E'a\\' $1', e'\\\\' from t where a = $2");
+
+            Assert::That(names.size(), Equals(1));
+
+            Assert::That(names[0], Equals("$2"));
+        });
+
+        it("skips casts and variables", []() {
+            auto names = find_parameter_names("select a::text, @@version, b$1 from t where c = :c");
+
+            Assert::That(names.size(), Equals(1));
+
+            Assert::That(names[0], Equals(":c"));
+        });
+    });
+
+});
+
+#endif
@@ -0,0 +1,102 @@
+#include <bandit/bandit.h>
+#include <sstream>
+#include <string>
+#include "blob_stream.h"
+#include "db.test.h"
+
+using namespace bandit;
+
+using namespace std;
+
+using namespace rj::db;
+
+go_bandit([]() {
+
+    describe("blob stream", []() {
+        before_each([]() {
+            setup_current_session();
+
+            user u;
+            u.set_id(1);
+            u.set("first_name", "Blob");
+            u.set("last_name", "Stream");
+            u.save();
+        });
+
+        after_each([]() { teardown_current_session(); });
+
+        it("can write and read a blob in chunks", []() {
+            string value;
+
+            for (int i = 0; i < 10000; i++) {
+                value += static_cast<char>(i % 256);
+            }
+
+            auto writer = current_session->open_blob_writer("users", "data", 1, value.size());
+
+            istringstream in(value);
+
+            Assert::That(writer->write(in, 1024), Equals(value.size()));
+
+            writer->close();
+
+            auto reader = current_session->open_blob_reader("users", "data", 1);
+
+            Assert::That(reader->size(), Equals(value.size()));
+
+            char buffer[100];
+
+            Assert::That(reader->read(buffer, sizeof(buffer)), Equals(sizeof(buffer)));
+
+            Assert::That(string(buffer, sizeof(buffer)), Equals(value.substr(0, sizeof(buffer))));
+
+            reader->seek(value.size() - 50);
+
+            // reads stop at the end
+            Assert::That(reader->read(buffer, sizeof(buffer)), Equals(50));
+
+            Assert::That(string(buffer, 50), Equals(value.substr(value.size() - 50)));
+
+            Assert::That(reader->read(buffer, sizeof(buffer)), Equals(0));
+
+            reader->seek(0);
+
+            ostringstream out;
+
+            Assert::That(reader->read(out, 999), Equals(value.size()));
+
+            Assert::That(out.str(), Equals(value));
+        });
+
+        it("keeps the old value if a writer is not closed", []() {
+            string value(1000, 'a');
+
+            auto writer = current_session->open_blob_writer("users", "data", 1, value.size());
+
+            writer->write(value.data(), value.size());
+
+            writer->close();
+
+            writer = current_session->open_blob_writer("users", "data", 1, value.size());
+
+            writer->write(string(500, 'b').data(), 500);
+
+            writer = nullptr;
+
+            auto reader = current_session->open_blob_reader("users", "data", 1);
+
+            ostringstream out;
+
+            reader->read(out);
+
+            Assert::That(out.str(), Equals(value));
+        });
+
+        it("requires an existing row and column", []() {
+            AssertThrows(database_exception, current_session->open_blob_reader("users", "data", 1234));
+
+            AssertThrows(database_exception, current_session->open_blob_reader("users", "not_a_column", 1));
+        });
+    });
+
+});
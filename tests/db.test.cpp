@@ -156,5 +156,14 @@ go_bandit([]() {
                 throw e;
             }
         });
+
+        it("can parse uri parameters", []() {
+            uri info("file://test.db?readers=2&cache=shared");
+
+            AssertThat(info.path, Equals("test.db"));
+            AssertThat(info.param("readers"), Equals("2"));
+            AssertThat(info.param("cache"), Equals("shared"));
+            AssertThat(info.param("missing", "none"), Equals("none"));
+        });
     });
 });
@@ -0,0 +1,105 @@
+#include <bandit/bandit.h>
+#include "db.test.h"
+#include "identity_map.h"
+
+using namespace bandit;
+
+using namespace std;
+
+using namespace rj::db;
+
+go_bandit([]() {
+
+    describe("an identity map", []() {
+        before_each([]() { setup_current_session(); });
+
+        after_each([]() { teardown_current_session(); });
+
+        it("reuses records loaded by id", []() {
+            user u1;
+
+            u1.set("first_name", "Identity");
+            u1.set("last_name", "Mapped");
+
+            Assert::That(u1.save(), IsTrue());
+
+            identity_scope scope(current_session);
+
+            auto found = user().find_by_id(u1.id());
+
+            Assert::That(found != nullptr, IsTrue());
+
+            Assert::That(current_session->get_identity_map()->size(), Equals(1));
+
+            // removed behind the map's back, so only the map can answer
+            delete_query remove(current_session, "users");
+
+            Assert::That(remove.execute(), Equals(1));
+
+            auto again = user().find_by_id(u1.id());
+
+            Assert::That(again == found, IsTrue());
+
+            Assert::That(user().find_one("id", u1.id()) == found, IsTrue());
+        });
+
+        it("shares instances with other finders", []() {
+            user u1;
+
+            u1.set("first_name", "Identity");
+            u1.set("last_name", "Shared");
+
+            Assert::That(u1.save(), IsTrue());
+
+            identity_scope scope(current_session);
+
+            auto found = user().find_by_id(u1.id());
+
+            auto all = user().find_all();
+
+            Assert::That(all.size(), Equals(1));
+
+            Assert::That(all[0] == found, IsTrue());
+        });
+
+        it("forgets records when they change", []() {
+            user u1;
+
+            u1.set("first_name", "Identity");
+            u1.set("last_name", "Changed");
+
+            Assert::That(u1.save(), IsTrue());
+
+            identity_scope scope(current_session);
+
+            auto found = user().find_by_id(u1.id());
+
+            found->set("last_name", "Saved");
+
+            Assert::That(found->save(), IsTrue());
+
+            Assert::That(current_session->get_identity_map()->size(), Equals(0));
+
+            auto again = user().find_by_id(u1.id());
+
+            Assert::That(again != found, IsTrue());
+
+            Assert::That(again->get("last_name"), Equals("Saved"));
+
+            Assert::That(again->de1ete(), IsTrue());
+
+            Assert::That(user().find_by_id(u1.id()) == nullptr, IsTrue());
+        });
+
+        it("is removed at the end of its scope", []() {
+            {
+                identity_scope scope(current_session);
+
+                Assert::That(current_session->get_identity_map() != nullptr, IsTrue());
+            }
+
+            Assert::That(current_session->get_identity_map() == nullptr, IsTrue());
+        });
+    });
+
+});
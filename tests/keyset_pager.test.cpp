@@ -0,0 +1,99 @@
+#include <bandit/bandit.h>
+#include "db.test.h"
+#include "keyset_pager.h"
+
+using namespace bandit;
+
+using namespace std;
+
+using namespace rj::db;
+
+go_bandit([]() {
+
+    describe("keyset pager", []() {
+        before_each([]() {
+            setup_current_session();
+
+            for (int i = 1; i <= 10; i++) {
+                user u;
+                u.set_id(i);
+                u.set("first_name", i % 2 ? "Odd" : "Even");
+                u.set("last_name", "Pager");
+                u.save();
+            }
+        });
+
+        after_each([]() { teardown_current_session(); });
+
+        it("reads every row once in order", []() {
+            select_query query(current_session);
+
+            query.from("users");
+
+            keyset_pager pager(query, {"id"}, 3);
+
+            vector<int> ids;
+
+            size_t pages = 0, count = 0;
+
+            while ((count = pager.next([&ids](const row &r) { ids.push_back(r.column("id").to_value().to_int()); })) > 0) {
+                pages++;
+            }
+
+            Assert::That(pages, Equals(4));
+
+            Assert::That(pager.is_done(), IsTrue());
+
+            Assert::That(ids.size(), Equals(10));
+
+            for (size_t i = 0; i < ids.size(); i++) {
+                Assert::That(ids[i], Equals(static_cast<int>(i + 1)));
+            }
+        });
+
+        it("keeps the where clause of the query", []() {
+            select_query query(current_session);
+
+            query.from("users").where("first_name = $1", "Odd");
+
+            keyset_pager pager(query, {"id"}, 2, true);
+
+            vector<int> ids;
+
+            Assert::That(pager.for_each([&ids](const row &r) { ids.push_back(r.column("id").to_value().to_int()); }), Equals(5));
+
+            Assert::That(ids.front(), Equals(9));
+
+            Assert::That(ids.back(), Equals(1));
+        });
+
+        it("can resume from a key", []() {
+            select_query query(current_session);
+
+            query.from("users");
+
+            keyset_pager pager(query, {"id"}, 4);
+
+            pager.next(nullptr);
+
+            auto key = pager.last_key();
+
+            Assert::That(key.size(), Equals(1));
+
+            keyset_pager other(query, {"id"}, 4);
+
+            other.seek(key);
+
+            int first = 0;
+
+            other.next([&first](const row &r) {
+                if (first == 0) {
+                    first = r.column("id").to_value().to_int();
+                }
+            });
+
+            Assert::That(first, Equals(5));
+        });
+    });
+
+});
@@ -112,6 +112,108 @@ go_bandit([]() {
             Assert::That(count, Equals(5));
         });
 
+        it("inserts each batch execute without buffering", []() {
+            insert_query query(current_session, "users", {"id", "first_name", "last_name"});
+
+            query.flags(insert_query::Batch);
+
+            for (int i = 0; i < 3; i++) {
+                query.values(i + 5, "batchFirst", "batchLast");
+
+                Assert::That(query.execute(), Equals(1));
+            }
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").count(), Equals(5));
+        });
+
+        it("can buffer a batch of values", []() {
+            insert_query query(current_session, "users", {"id", "first_name", "last_name"});
+
+            query.flags(insert_query::Buffered);
+
+            for (int i = 0; i < 3; i++) {
+                query.values(i + 5, "batchFirst", "batchLast");
+
+                Assert::That(query.execute(), Equals(1));
+            }
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").count(), Equals(2));
+
+            Assert::That(query.flush(), Equals(3));
+
+            Assert::That(query.flush(), Equals(0));
+
+            Assert::That(select.count(), Equals(5));
+
+#if TEST_POSTGRES
+            Assert::That(query.last_insert_ids().size(), Equals(3));
+#endif
+        });
+
+        it("prepares a single insert again after a flush", []() {
+            insert_query query(current_session, "users", {"id", "first_name", "last_name"});
+
+            query.flags(insert_query::Buffered);
+
+            for (int i = 0; i < 2; i++) {
+                query.values(i + 5, "batchFirst", "batchLast");
+                query.execute();
+            }
+
+            Assert::That(query.flush(), Equals(2));
+
+            query.flags(0);
+
+            query.values(7, "singleFirst", "singleLast");
+
+            // not the two row statement of the flush
+            Assert::That(query.execute(), Equals(1));
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").where("first_name = $1", "singleFirst").count(), Equals(1));
+        });
+
+        it("discards a batch that was never flushed", []() {
+            {
+                insert_query query(current_session, "users", {"id", "first_name", "last_name"});
+
+                query.flags(insert_query::Buffered);
+
+                query.values(5, "batchFirst", "batchLast");
+
+                query.execute();
+            }
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").count(), Equals(2));
+        });
+
+        it("splits a batch by the parameter limit", []() {
+            insert_query query(current_session, "users", {"id", "first_name", "last_name"});
+
+            query.flags(insert_query::Buffered);
+
+            int rows = current_session->max_parameters() / 3 + 1;
+
+            for (int i = 0; i < rows; i++) {
+                query.values(i + 10, "batchFirst", "batchLast");
+                query.execute();
+            }
+
+            // the first full statement was sent when the limit was reached
+            Assert::That(query.flush(), Equals(1));
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").count(), Equals(rows + 2));
+        });
+
     });
 
 });
@@ -51,6 +51,18 @@ go_bandit([]() {
 
         after_each([]() { teardown_current_session(); });
 
+#ifdef ENHANCED_PARAMETER_MAPPING
+        it("can rewrite parameters", []() {
+            mysql::binding b;
+
+            auto sql = b.prepare("select * from users where first_name = @name and last_name = $1 or '?' = $2");
+
+            Assert::That(sql, Equals("select * from users where first_name = ? and last_name = ? or '?' = ?"));
+
+            Assert::That(b.is_named(), IsTrue());
+        });
+#endif
+
         it("has a size contructor", []() {
             mysql::binding b(3);
 
@@ -8,7 +8,9 @@
 
 #include <bandit/bandit.h>
 #include "../db.test.h"
+#include "mysql/binding.h"
 #include "mysql/resultset.h"
+#include "mysql/session.h"
 
 using namespace bandit;
 
@@ -110,6 +112,123 @@ go_bandit([]() {
 
         });
 
+        describe("can stream rows", []() {
+
+            it("as statement results", []() {
+                select_query query(current_session, {}, "users");
+
+                query.flags(select_query::Stream);
+
+                auto rs = query.execute();
+
+                Assert::That(rs.empty(), IsFalse());
+
+                int count = 0;
+
+                for (auto &row : rs) {
+                    Assert::That(row.is_valid(), IsTrue());
+                    count++;
+                }
+
+                Assert::That(count, Equals(2));
+
+                AssertThrows(database_exception, rs.begin());
+            });
+
+            it("as results", []() {
+                auto sess = current_session->impl<mysql::session>();
+
+                auto rs = sess->stream("select * from users");
+
+                Assert::That(rs->next(), IsTrue());
+
+                rs->reset();
+
+                int count = 0;
+
+                while (rs->next()) {
+                    count++;
+                }
+
+                Assert::That(count, Equals(2));
+
+                AssertThrows(database_exception, rs->reset());
+            });
+        });
+
+        describe("can read values longer than the default buffer", []() {
+            before_each([]() {
+                string value(mysql::binding::DEFAULT_RESULT_BUFFER_SIZE * 5, 'x');
+
+                user user1;
+
+                user1.set_id(1);
+
+                user1.set("first_name", "Bryan");
+                user1.set("last_name", "Jenkins");
+                user1.set("data", sql_blob(value.data(), value.size()));
+
+                user1.save();
+            });
+
+            auto check = [](select_query &query) {
+                string value(mysql::binding::DEFAULT_RESULT_BUFFER_SIZE * 5, 'x');
+
+                // executing again reuses the buffers of the statement
+                for (int i = 0; i < 2; i++) {
+                    auto rs = query.execute();
+
+                    int count = 0;
+
+                    for (auto &row : rs) {
+                        if (row["id"].to_value().to_int() == 1) {
+                            Assert::That(row["data"].to_value().to_binary().size(), Equals(value.size()));
+                        } else {
+                            Assert::That(row["last_name"].to_value().to_string(), Equals("Smith"));
+                        }
+                        count++;
+                    }
+
+                    Assert::That(count, Equals(2));
+                }
+            };
+
+            it("as stored statement results", [check]() {
+                select_query query(current_session, {}, "users");
+
+                query.order_by("id");
+
+                check(query);
+            });
+
+            it("as streamed statement results", [check]() {
+                select_query query(current_session, {}, "users");
+
+                query.order_by("id").flags(select_query::Stream);
+
+                check(query);
+            });
+
+            it("keeps the values of an earlier execution", []() {
+                string value(mysql::binding::DEFAULT_RESULT_BUFFER_SIZE * 5, 'x');
+
+                select_query query(current_session, {}, "users");
+
+                query.order_by("id");
+
+                auto first = query.execute();
+
+                auto row = *first.begin();
+
+                // a second result set gets its own buffers
+                auto second = query.execute();
+
+                Assert::That(second.begin()->column("id").to_value().to_int(), Equals(1));
+
+                Assert::That(row["data"].to_value().to_binary().size(), Equals(value.size()));
+            });
+        });
+
         it("can handle a bad query", []() {
             AssertThat(current_session->execute("select * from asdfasdfasdf"), Equals(false));
 
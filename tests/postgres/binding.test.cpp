@@ -9,6 +9,8 @@
 #include <bandit/bandit.h>
 #include "../db.test.h"
 #include "postgres/binding.h"
+#include "postgres/session.h"
+#include "postgres/statement.h"
 
 using namespace bandit;
 
@@ -44,6 +46,138 @@ go_bandit([]() {
 
         after_each([]() { teardown_current_session(); });
 
+#ifdef ENHANCED_PARAMETER_MAPPING
+        it("can rewrite parameters", []() {
+            postgres::binding b;
+
+            auto sql = b.prepare("select * from users where first_name = $1 and last_name = @name or id = $1 and '?' = :name::text");
+
+            Assert::That(sql, Equals("select * from users where first_name = $1 and last_name = $2 or id = $1 and '?' = $3::text"));
+
+            sql = b.prepare("select * from users where first_name = ? and last_name = @name or id = ?");
+
+            Assert::That(sql, Equals("select * from users where first_name = $1 and last_name = $3 or id = $2"));
+
+            sql = b.prepare("select * from users where first_name = @name or last_name = @name");
+
+            Assert::That(sql, Equals("select * from users where first_name = $1 or last_name = $1"));
+
+            Assert::That(b.is_named(), IsTrue());
+        });
+#endif
+
+        it("binds values in the binary format", []() {
+            postgres::binding b;
+
+            unsigned char bytes[] = {4, 0, 0, 0, 2};
+
+            sql_time now;
+
+            b.bind(1, 1234);
+            b.bind(2, -5678LL);
+            b.bind(3, 3.1456);
+            b.bind(4, sql_blob(bytes, sizeof(bytes)));
+            b.bind(5, now);
+
+            Assert::That(b.to_value(0), Equals(1234));
+            Assert::That(b.to_value(1), Equals(-5678LL));
+            Assert::That(b.to_value(2), Equals(3.1456));
+            Assert::That(b.to_value(3).to_binary().size(), Equals(sizeof(bytes)));
+            Assert::That(b.to_value(4).to_time().to_llong(), Equals(now.to_llong()));
+
+            postgres::binding copy(b);
+
+            Assert::That(copy.to_value(3).to_binary().size(), Equals(sizeof(bytes)));
+        });
+
+        it("reads results in the binary format", []() {
+            unsigned char bytes[] = {4, 0, 0, 0, 2};
+
+            sql_time now;
+
+            postgres::statement stmt(dynamic_pointer_cast<postgres::session>(current_session->impl()));
+
+            stmt.prepare("update users set data = $1, tval = $2 where id = $3");
+
+            stmt.bind(1, sql_blob(bytes, sizeof(bytes)));
+            stmt.bind(2, now);
+            stmt.bind(3, 3);
+
+            Assert::That(stmt.result(), IsTrue());
+
+            select_query query(current_session);
+
+            query.from("users").where("id = $1", 3);
+
+            auto rs = query.execute();
+
+            Assert::That(rs.is_valid(), IsTrue());
+
+            auto row = rs.begin();
+
+            Assert::That(row->column("id").to_value(), Equals(3));
+            Assert::That(row->column("dval").to_value(), Equals(3.1456));
+            Assert::That(row->column("data").to_value().to_binary().size(), Equals(sizeof(bytes)));
+            Assert::That(row->column("tval").to_value().to_time().to_llong(), Equals(now.to_llong()));
+        });
+
+        it("reads the same values in the text and binary formats", []() {
+            string sql =
+                "select true as flag, 5000000000::bigint as big, 12::smallint as small, '2001-02-03 04:05:06.789'::timestamp as stamp, "
+                "'1999-12-31'::date as day, '04:05:06'::time as clock, '2001-02-03 04:05:06+02'::timestamptz as zoned, "
+                "'Infinity'::numeric as inf, 1.5::float8 as real";
+
+            // a session query is read as text
+            auto text = current_session->query(sql);
+
+            postgres::statement stmt(dynamic_pointer_cast<postgres::session>(current_session->impl()));
+
+            stmt.prepare(sql);
+
+            // a prepared statement with only decoded columns is read as binary
+            auto bin = stmt.results();
+
+            Assert::That(text.next(), IsTrue());
+            Assert::That(bin.next(), IsTrue());
+
+            auto trow = text.current_row();
+            auto brow = bin.current_row();
+
+            Assert::That(trow.size(), Equals(brow.size()));
+
+            for (size_t i = 0; i < trow.size(); i++) {
+                auto tval = trow.column(i).to_value();
+                auto bval = brow.column(i).to_value();
+
+                Assert::That(tval.type(), Equals(bval.type()));
+                Assert::That(tval.to_string(), Equals(bval.to_string()));
+            }
+
+            Assert::That(trow.column("flag").to_value().to_bool(), IsTrue());
+            Assert::That(trow.column("big").to_value().to_llong(), Equals(5000000000LL));
+            Assert::That(trow.column("zoned").to_value().to_time().to_llong(), Equals(981165906LL));
+            Assert::That(trow.column("inf").to_value().to_string(), Equals("Infinity"));
+        });
+
+        it("reads types it can not decode in the text format", []() {
+            postgres::statement stmt(dynamic_pointer_cast<postgres::session>(current_session->impl()));
+
+            stmt.prepare("select $1::integer as num, '1 day'::interval as span, ARRAY[1, 2] as list, '10.0.0.1'::inet as addr");
+
+            stmt.bind(1, 3);
+
+            auto rs = stmt.results();
+
+            Assert::That(rs.next(), IsTrue());
+
+            auto row = rs.current_row();
+
+            Assert::That(row.column("num").to_value(), Equals(3));
+            Assert::That(row.column("span").to_value().to_string(), Equals("1 day"));
+            Assert::That(row.column("list").to_value().to_string(), Equals("{1,2}"));
+            Assert::That(row.column("addr").to_value().to_string(), Equals("10.0.0.1"));
+        });
+
         it("has a size contructor", []() {
             postgres::binding b(3);
 
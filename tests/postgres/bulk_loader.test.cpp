@@ -0,0 +1,99 @@
+
+#include <bandit/bandit.h>
+#include "../db.test.h"
+#include "postgres/bulk_loader.h"
+#include "postgres/session.h"
+
+#ifdef HAVE_LIBPQ
+
+using namespace bandit;
+
+using namespace std;
+
+using namespace rj::db;
+
+go_bandit([]() {
+
+    describe("postgres bulk loader", []() {
+        before_each([]() { setup_current_session(); });
+
+        after_each([]() { teardown_current_session(); });
+
+        it("can load text rows", []() {
+            auto pg_session = current_session->impl<postgres::session>();
+
+            postgres::bulk_loader loader(pg_session, "users", {"first_name", "last_name", "dval"});
+
+            loader.values("Bob", "Smith", 1.5);
+            loader.values("Tab\tbed", "Back\\slash", sql_null);
+
+            Assert::That(loader.rows(), Equals(2));
+
+            Assert::That(loader.finish(), Equals(2));
+
+            select_query select(current_session);
+
+            auto rs = select.from("users").where("last_name = $1", "Back\\slash").execute();
+
+            Assert::That(rs.begin()->column("first_name").to_value(), Equals("Tab\tbed"));
+        });
+
+        it("can load binary rows", []() {
+            auto pg_session = current_session->impl<postgres::session>();
+
+            postgres::bulk_loader loader(pg_session, "users", {"first_name", "last_name", "dval"}, postgres::bulk_loader::binary);
+
+            for (int i = 0; i < 10; i++) {
+                loader.values("Binary", "Copy", i);
+            }
+
+            Assert::That(loader.finish(), Equals(10));
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").where("first_name = $1", "Binary").count(), Equals(10));
+        });
+
+        it("rejects binary integers out of range for the column", []() {
+            auto pg_session = current_session->impl<postgres::session>();
+
+            postgres::bulk_loader loader(pg_session, "user_settings", {"user_id", "valid"}, postgres::bulk_loader::binary);
+
+            AssertThrows(binding_error, loader.values(1, 40000));
+
+            AssertThrows(binding_error, loader.values(5000000000LL, 1));
+
+            // the rejected rows are skipped
+            loader.values(1, 1);
+
+            Assert::That(loader.finish(), Equals(1));
+        });
+
+        it("discards rows when cancelled", []() {
+            auto pg_session = current_session->impl<postgres::session>();
+
+            {
+                postgres::bulk_loader loader(pg_session, "users", {"first_name", "last_name"});
+
+                loader.values("Never", "Loaded");
+
+                Assert::That(loader.is_active(), IsTrue());
+            }
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").count(), Equals(0));
+        });
+
+        it("requires matching values", []() {
+            auto pg_session = current_session->impl<postgres::session>();
+
+            postgres::bulk_loader loader(pg_session, "users", {"first_name", "last_name"});
+
+            AssertThrows(binding_error, loader.values("Bob"));
+        });
+    });
+
+});
+
+#endif
@@ -0,0 +1,104 @@
+#include <bandit/bandit.h>
+#include "../db.test.h"
+#include "postgres/pipeline.h"
+#include "postgres/session.h"
+
+#ifdef HAVE_LIBPQ
+
+using namespace bandit;
+
+using namespace std;
+
+using namespace rj::db;
+
+go_bandit([]() {
+
+    describe("postgres pipeline", []() {
+        before_each([]() { setup_current_session(); });
+
+        after_each([]() { teardown_current_session(); });
+
+        it("executes queued queries in order", []() {
+            postgres::pipeline pipe(current_session->impl<postgres::session>());
+
+            for (int i = 0; i < 3; i++) {
+                insert_query insert(current_session, "users", {"first_name", "last_name"});
+
+                insert.values("Piped", "User" + std::to_string(i));
+
+                pipe.add(insert);
+            }
+
+            update_query update(current_session, "users");
+
+            update.columns("first_name").values("Updated").where("last_name != $2");
+
+            update.bind(2, "User1");
+
+            pipe.add(update);
+
+            delete_query remove(current_session, "users");
+
+            remove.where("last_name = $1", "User2");
+
+            pipe.add(remove);
+
+            Assert::That(pipe.size(), Equals(5));
+
+            auto changes = pipe.execute();
+
+            Assert::That(pipe.size(), Equals(0));
+
+            Assert::That(changes.size(), Equals(5));
+            Assert::That(changes[0], Equals(1));
+            Assert::That(changes[1], Equals(1));
+            Assert::That(changes[2], Equals(1));
+            Assert::That(changes[3], Equals(2));
+            Assert::That(changes[4], Equals(1));
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").where("first_name = $1", "Updated").count(), Equals(1));
+        });
+
+        it("discards all queries on failure", []() {
+            postgres::pipeline pipe(current_session->impl<postgres::session>());
+
+            pipe.add("insert into users(first_name, last_name) values($1, $2)", {"Piped", "User"});
+
+            pipe.add("insert into no_such_table(first_name) values($1)", {"Piped"});
+
+            AssertThrows(database_exception, pipe.execute());
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").count(), Equals(0));
+
+            // the session is usable afterwards
+            pipe.add("insert into users(first_name, last_name) values($1, $2)", {"Piped", "User"});
+
+            Assert::That(pipe.execute().size(), Equals(1));
+        });
+
+        it("reads past the statements skipped after a failure", []() {
+            postgres::pipeline pipe(current_session->impl<postgres::session>());
+
+            pipe.add("insert into no_such_table(first_name) values($1)", {"Piped"});
+
+            for (int i = 0; i < 3; i++) {
+                pipe.add("insert into users(first_name, last_name) values($1, $2)", {"Piped", "User"});
+            }
+
+            AssertThrows(database_exception, pipe.execute());
+
+            Assert::That(current_session->execute("insert into users(first_name, last_name) values('Plain', 'User')"), IsTrue());
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").count(), Equals(1));
+        });
+    });
+
+});
+
+#endif
@@ -1,6 +1,7 @@
 #include <bandit/bandit.h>
 #include "../db.test.h"
 #include "postgres/resultset.h"
+#include "postgres/session.h"
 
 #ifdef HAVE_LIBPQ
 
@@ -62,6 +63,76 @@ go_bandit([]() {
 
             Assert::That(other.is_valid(), IsTrue());
         });
+
+        it("can stream rows", []() {
+            select_query query(current_session);
+
+            query.from("users").flags(select_query::Stream);
+
+            auto rs = query.execute();
+
+            Assert::That(rs.empty(), IsFalse());
+
+            int count = 0;
+
+            for (auto &row : rs) {
+                Assert::That(row.is_valid(), IsTrue());
+                count++;
+            }
+
+            Assert::That(count, Equals(2));
+
+            // the connection is free again once the rows are read
+            select_query other(current_session);
+
+            Assert::That(other.from("users").count(), Equals(2));
+        });
+
+        it("can stop streaming early", []() {
+            auto pg_session = current_session->impl<postgres::session>();
+
+            {
+                resultset rs(pg_session->stream("select * from users"));
+
+                Assert::That(rs.next(), IsTrue());
+            }
+
+            select_query query(current_session);
+
+            Assert::That(query.from("users").count(), Equals(2));
+        });
+
+        it("can stop streaming early in a transaction", []() {
+            auto pg_session = current_session->impl<postgres::session>();
+
+            auto tx = current_session->start_transaction();
+
+            {
+                resultset rs(pg_session->stream("select * from generate_series(1, 100000)"));
+
+                for (int i = 0; i < 50000; i++) {
+                    Assert::That(rs.next(), IsTrue());
+                }
+            }
+
+            // the transaction was not aborted by cancelling the stream
+            select_query query(current_session);
+
+            Assert::That(query.from("users").count(), Equals(2));
+
+            tx.commit();
+        });
+
+        it("can not rewind a stream", []() {
+            auto pg_session = current_session->impl<postgres::session>();
+
+            resultset rs(pg_session->stream("select * from users"));
+
+            Assert::That(rs.next(), IsTrue());
+            Assert::That(rs.next(), IsTrue());
+
+            AssertThrows(database_exception, rs.reset());
+        });
     });
 });
 
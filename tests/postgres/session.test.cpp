@@ -7,6 +7,7 @@
 #ifdef HAVE_LIBPQ
 
 #include <bandit/bandit.h>
+#include <poll.h>
 #include "../db.test.h"
 #include "postgres/session.h"
 
@@ -28,6 +29,177 @@ go_bandit([]() {
 
             AssertThrows(database_exception, db->open());
         });
+
+        it("caches prepared statements", []() {
+            auto pg = current_session->impl<postgres::session>();
+
+            auto hits = pg->statement_cache_hits();
+            auto misses = pg->statement_cache_misses();
+
+            for (int i = 0; i < 3; i++) {
+                select_query query(current_session);
+
+                query.from("users").where("first_name = $1", "Bryan");
+
+                query.execute();
+            }
+
+            Assert::That(pg->statement_cache_misses(), Equals(misses + 1));
+
+            Assert::That(pg->statement_cache_hits(), Equals(hits + 2));
+        });
+
+        it("invalidates prepared statements on reset", []() {
+            auto pg = current_session->impl<postgres::session>();
+
+            select_query query(current_session);
+
+            query.from("users").where("first_name = $1", "Bryan");
+
+            query.execute();
+
+            auto misses = pg->statement_cache_misses();
+
+            pg->reset();
+
+            select_query other(current_session);
+
+            other.from("users").where("first_name = $1", "Bryan");
+
+            AssertThat(other.execute().is_valid(), IsTrue());
+
+            Assert::That(pg->statement_cache_misses(), Equals(misses + 1));
+        });
+
+        it("does not retry a lost statement inside a transaction", []() {
+            select_query query(current_session);
+
+            query.from("users").where("first_name = $1", "Bryan");
+
+            query.execute();
+
+            {
+                auto tx = current_session->start_transaction();
+
+                Assert::That(current_session->execute("DEALLOCATE ALL"), IsTrue());
+
+                select_query lost(current_session);
+
+                lost.from("users").where("first_name = $1", "Bryan");
+
+                // the failure aborted the transaction, so it is reported instead of retried
+                AssertThrows(database_exception, lost.execute());
+
+                tx.rollback();
+            }
+
+            select_query again(current_session);
+
+            again.from("users").where("first_name = $1", "Bryan");
+
+            AssertThat(again.execute().is_valid(), IsTrue());
+        });
+
+        it("reports the error of a bad statement inside a transaction", []() {
+            auto tx = current_session->start_transaction();
+
+            select_query bad(current_session);
+
+            bad.from("not_a_table");
+
+            string error;
+
+            try {
+                bad.execute();
+            } catch (const database_exception &e) {
+                error = e.what();
+            }
+
+            // not that the transaction was aborted by preparing it
+            Assert::That(error.find("not_a_table") != string::npos, IsTrue());
+
+            tx.rollback();
+        });
+
+        it("can be driven by its socket", []() {
+            Assert::That(current_session->socket() >= 0, IsTrue());
+
+            auto future = current_session->query_async("select pg_sleep(0.1), 1 as value");
+
+            struct pollfd fd;
+
+            fd.fd = current_session->socket();
+            fd.events = POLLIN;
+
+            // wait for the results without blocking in the client library
+            do {
+                fd.revents = 0;
+                poll(&fd, 1, 1000);
+            } while (!current_session->consume_input());
+
+            auto rs = future.get();
+
+            Assert::That(rs.begin()->column("value").to_value(), Equals(1));
+        });
+
+        it("can drive a modify query by its socket", []() {
+            insert_query query(current_session, "users", {"first_name", "last_name"});
+
+            query.values("Async", "Insert");
+
+            auto future = query.execute_async();
+
+            while (!current_session->consume_input()) {
+                struct pollfd fd;
+
+                fd.fd = current_session->socket();
+                fd.events = POLLIN;
+                fd.revents = 0;
+                poll(&fd, 1, 1000);
+            }
+
+            Assert::That(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready, IsTrue());
+
+            Assert::That(future.get(), Equals(1));
+        });
+
+        it("reads the results of a dropped future before the next query", []() {
+            current_session->query_async("select pg_sleep(0.1)");
+
+            auto rs = current_session->query("select 1 as value");
+
+            Assert::That(rs.begin()->column("value").to_value(), Equals(1));
+
+            auto future = current_session->query_async("select 2 as value");
+
+            current_session->wait_for_results();
+
+            Assert::That(future.get().begin()->column("value").to_value(), Equals(2));
+        });
+
+        it("evicts the least recently used statement", []() {
+            auto pg = current_session->impl<postgres::session>();
+
+            pg->set_statement_cache_size(1);
+
+            select_query a(current_session);
+            a.from("users").where("first_name = $1", "Bryan");
+            a.execute();
+
+            select_query b(current_session);
+            b.from("users").where("last_name = $1", "Jenkins");
+            b.execute();
+
+            auto misses = pg->statement_cache_misses();
+
+            select_query c(current_session);
+            c.from("users").where("first_name = $1", "Bryan");
+            c.execute();
+
+            Assert::That(pg->statement_cache_misses(), Equals(misses + 1));
+
+            pg->set_statement_cache_size(postgres::session::DEFAULT_STATEMENT_CACHE_SIZE);
+        });
     });
 
 });
@@ -114,6 +114,248 @@ go_bandit([]() {
             Assert::That(u2.get("last_name"), Equals("Robot"));
         });
 
+        it("can upsert a record with an id", []() {
+            user u1;
+
+            u1.set_id(1234);
+            u1.set("first_name", "Upsert");
+            u1.set("last_name", "Inserted");
+
+            Assert::That(u1.is_persisted(), IsFalse());
+
+            Assert::That(u1.save(), IsTrue());
+
+            Assert::That(u1.is_persisted(), IsTrue());
+
+            user u2;
+
+            u2.set_id(1234);
+            u2.set("first_name", "Upsert");
+            u2.set("last_name", "Updated");
+
+            Assert::That(u2.save(), IsTrue());
+
+            auto found = user().find_all();
+
+            Assert::That(found.size(), Equals(1));
+
+            Assert::That(found[0]->get("last_name"), Equals("Updated"));
+
+            Assert::That(found[0]->is_persisted(), IsTrue());
+        });
+
+        it("can upsert an existing record without changing it", []() {
+            user u1;
+
+            u1.set_id(1235);
+            u1.set("first_name", "Unchanged");
+            u1.set("last_name", "Upsert");
+
+            Assert::That(u1.save(), IsTrue());
+
+            // the same values, so the upsert changes nothing
+            user u2;
+
+            u2.set_id(1235);
+            u2.set("first_name", "Unchanged");
+            u2.set("last_name", "Upsert");
+
+            Assert::That(u2.save(), IsTrue());
+
+            Assert::That(u2.is_persisted(), IsTrue());
+
+            // only the key, which postgres and sqlite upsert with DO NOTHING
+            user u3;
+
+            u3.set_id(1235);
+
+            Assert::That(u3.save(), IsTrue());
+
+            Assert::That(user().find_by_id(1235)->get("last_name"), Equals("Upsert"));
+        });
+
+        it("inserts a persisted record again after a delete", []() {
+            user u1;
+
+            u1.set("first_name", "Deleted");
+            u1.set("last_name", "User");
+
+            Assert::That(u1.save(), IsTrue());
+
+            Assert::That(u1.de1ete(), IsTrue());
+
+            Assert::That(u1.is_persisted(), IsFalse());
+
+            Assert::That(u1.save(), IsTrue());
+
+            Assert::That(u1.refresh(), IsTrue());
+
+            Assert::That(u1.get("last_name"), Equals("User"));
+        });
+
+        it("tracks changed columns", []() {
+            user u1;
+
+            u1.set("first_name", "Dirty");
+            u1.set("last_name", "Record");
+
+            Assert::That(u1.is_dirty(), IsTrue());
+
+            Assert::That(u1.save(), IsTrue());
+
+            Assert::That(u1.is_dirty(), IsFalse());
+
+            // setting the same value is not a change
+            u1.set("first_name", "Dirty");
+
+            Assert::That(u1.is_dirty(), IsFalse());
+
+            Assert::That(u1.save(), IsTrue());
+
+            u1.set("last_name", "Changed");
+
+            auto changed = u1.changed_columns();
+
+            Assert::That(changed.size(), Equals(1));
+
+            Assert::That(changed[0], Equals("last_name"));
+
+            Assert::That(u1.save(), IsTrue());
+
+            Assert::That(u1.is_dirty(), IsFalse());
+
+            auto u2 = user().find_by_id(u1.id());
+
+            Assert::That(u2 != nullptr, IsTrue());
+
+            Assert::That(u2->is_dirty(), IsFalse());
+
+            Assert::That(u2->get("first_name"), Equals("Dirty"));
+
+            Assert::That(u2->get("last_name"), Equals("Changed"));
+        });
+
+        it("can save and delete many records", []() {
+            vector<shared_ptr<user>> users;
+
+            for (int i = 0; i < 5; i++) {
+                auto u = make_shared<user>();
+
+                u->set("first_name", "Batch");
+                u->set("last_name", "User" + std::to_string(i));
+
+                users.push_back(u);
+            }
+
+            Assert::That(save_all(users), Equals(5));
+
+            for (auto &u : users) {
+                Assert::That(u->is_persisted(), IsTrue());
+
+                auto found = user().find_by_id(u->id());
+
+                Assert::That(found != nullptr, IsTrue());
+
+                Assert::That(found->get("last_name"), Equals(u->get("last_name")));
+            }
+
+            users[1]->set("first_name", "Changed");
+
+            // only the changed record is written
+            Assert::That(save_all(users), Equals(1));
+
+            Assert::That(user().find_by("first_name", "Changed").size(), Equals(1));
+
+            Assert::That(delete_all(users), Equals(5));
+
+            Assert::That(users[0]->is_persisted(), IsFalse());
+
+            Assert::That(user().find_all().size(), Equals(0));
+        });
+
+        it("writes back the generated ids of many new records", []() {
+            vector<shared_ptr<user>> users;
+
+            for (int i = 0; i < 3; i++) {
+                auto u = make_shared<user>();
+
+                u->set("first_name", "Generated");
+                u->set("last_name", "User" + std::to_string(i));
+
+                users.push_back(u);
+            }
+
+            Assert::That(save_all(users), Equals(3));
+
+            Assert::That(users[0]->id() != users[1]->id() && users[1]->id() != users[2]->id(), IsTrue());
+
+            for (auto &u : users) {
+                auto found = user().find_by_id(u->id());
+
+                Assert::That(found != nullptr, IsTrue());
+
+                Assert::That(found->get("last_name"), Equals(u->get("last_name")));
+            }
+        });
+
+        it("can save many records by id, even when an upsert changes nothing", []() {
+            user existing;
+
+            existing.set_id(10);
+            existing.set("first_name", "Existing");
+            existing.set("last_name", "User");
+
+            Assert::That(existing.save(), IsTrue());
+
+            // only the key, so the upsert has nothing to update
+            auto same = make_shared<user>();
+
+            same->set_id(10);
+
+            auto added = make_shared<user>();
+
+            added->set_id(11);
+            added->set("first_name", "Added");
+            added->set("last_name", "User");
+
+            vector<shared_ptr<user>> users = {same, added};
+
+            Assert::That(save_all(users), Equals(2));
+
+            Assert::That(user().find_by_id(10)->get("first_name"), Equals("Existing"));
+
+            Assert::That(user().find_by_id(11)->get("first_name"), Equals("Added"));
+        });
+
+        it("inserts updated records again when their rows are gone", []() {
+            vector<shared_ptr<user>> users;
+
+            for (int i = 0; i < 2; i++) {
+                auto u = make_shared<user>();
+
+                u->set("first_name", "Updated");
+                u->set("last_name", "User" + std::to_string(i));
+
+                users.push_back(u);
+            }
+
+            Assert::That(save_all(users), Equals(2));
+
+            delete_query query(current_session);
+
+            query.from("users").where("id = $1", users[0]->id());
+
+            Assert::That(query.execute(), Equals(1));
+
+            for (auto &u : users) {
+                u->set("first_name", "Changed");
+            }
+
+            Assert::That(save_all(users), Equals(2));
+
+            Assert::That(user().find_by("first_name", "Changed").size(), Equals(2));
+        });
+
         it("can have no column", []() {
             user user1;
 
@@ -62,6 +62,58 @@ go_bandit([]() {
 
         });
 
+        it("has a current row view", []() {
+            select_query q(current_session);
+
+            auto rs = q.from("users").execute();
+
+            Assert::That(rs.next(), IsTrue());
+
+            auto view = rs.view();
+
+            auto row = rs.current_row();
+
+            Assert::That(view.is_valid(), IsTrue());
+
+            Assert::That(view.size() == row.size(), IsTrue());
+
+            Assert::That(view.column_name(1), Equals(row.column_name(1)));
+
+            Assert::That(view[1].to_value(), Equals("Bryan"));
+
+            Assert::That(view[1].name(), Equals("first_name"));
+
+            AssertThrows(no_such_column_exception, view[view.size()]);
+
+            Assert::That(rs.next(), IsTrue());
+
+            Assert::That(view[1].to_value(), Equals("Mark"));
+        });
+
+        it("can resolve a column", []() {
+            select_query q(current_session);
+
+            auto rs = q.from("users").execute();
+
+            auto handle = rs.resolve("last_name");
+
+            Assert::That(handle.name(), Equals("last_name"));
+
+            AssertThrows(no_such_column_exception, rs.resolve("asdfasdf"));
+
+            Assert::That(rs.next(), IsTrue());
+
+            Assert::That(rs.current_row()[handle].to_value(), Equals("Jenkins"));
+
+            Assert::That(rs.view()[handle].to_value(), Equals("Jenkins"));
+
+            Assert::That(rs.view()["last_name"].to_value(), Equals("Jenkins"));
+
+            Assert::That(rs.current_row()["last_name"].to_value(), Equals("Jenkins"));
+
+            AssertThrows(no_such_column_exception, rs.current_row()["asdfasdf"]);
+        });
+
         it("can use for each", []() {
             select_query q(current_session);
 
@@ -99,6 +151,26 @@ go_bandit([]() {
 
         });
 
+        it("can be counted", []() {
+            select_query q(current_session);
+
+            auto rs = q.from("users").execute();
+
+            Assert::That(rs.empty(), IsFalse());
+
+            Assert::That(rs.size() == 2, IsTrue());
+
+            Assert::That(rs.size() == 2, IsTrue());
+
+            select_query none(current_session);
+
+            auto empty = none.from("users").where("first_name = $1", "Nobody").execute();
+
+            Assert::That(empty.empty(), IsTrue());
+
+            Assert::That(empty.size() == 0, IsTrue());
+        });
+
         it("can construct iterators", []() {
             select_query q(current_session);
 
@@ -114,6 +114,42 @@ go_bandit([]() {
             });
         });
 
+        it("can execute asynchronously", []() {
+            select_query query(current_session);
+
+            query.from("users");
+
+            auto future = query.execute_async();
+
+            current_session->wait_for_results();
+
+            auto rs = future.get();
+
+            Assert::That(rs.is_valid(), IsTrue());
+
+            auto other = current_session->query_async("select * from users");
+
+            current_session->wait_for_results();
+
+            Assert::That(other.get().size(), Equals(rs.size()));
+        });
+
+        it("executes a copy asynchronously", []() {
+            std::future<resultset> future;
+
+            {
+                select_query query(current_session);
+
+                future = query.from("users").execute_async();
+            }
+
+            current_session->wait_for_results();
+
+            auto rs = future.get();
+
+            Assert::That(rs.size() > 0, IsTrue());
+        });
+
         it("can be used with a where clause", []() {
             auto query = select_query(current_session);
 
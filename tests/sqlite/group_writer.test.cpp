@@ -0,0 +1,114 @@
+#include <bandit/bandit.h>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "../db.test.h"
+#include "sqlite/group_writer.h"
+
+#ifdef HAVE_LIBSQLITE3
+
+using namespace bandit;
+
+using namespace std;
+
+using namespace rj::db;
+
+go_bandit([]() {
+
+    describe("sqlite3 group writer", []() {
+        before_each([]() { setup_current_session(); });
+
+        after_each([]() { teardown_current_session(); });
+
+        it("commits writes from many threads", []() {
+            auto writer_session = sqldb::open_session(current_session->connection_info());
+
+            sqlite::group_writer writer(writer_session);
+
+            vector<future<sqlite::write_result>> results;
+            mutex resultsMutex;
+            vector<thread> threads;
+
+            for (int t = 0; t < 4; t++) {
+                threads.emplace_back([&, t]() {
+                    for (int i = 0; i < 25; i++) {
+                        // sessions are not shared between threads, so the sql is written out here
+                        auto result = writer.submit("insert into users(first_name, last_name) values($1, $2)", {"Group", "Thread" + std::to_string(t)});
+
+                        lock_guard<mutex> lock(resultsMutex);
+
+                        results.push_back(std::move(result));
+                    }
+                });
+            }
+
+            for (auto &t : threads) {
+                t.join();
+            }
+
+            set<long long> ids;
+
+            for (auto &result : results) {
+                auto value = result.get();
+
+                Assert::That(value.changes, Equals(1));
+
+                ids.insert(value.last_insert_id);
+            }
+
+            // every insert reports its own row
+            Assert::That(ids.size(), Equals(100));
+
+            writer.stop();
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").where("first_name = $1", "Group").count(), Equals(100));
+        });
+
+        it("writes queries", []() {
+            auto writer_session = sqldb::open_session(current_session->connection_info());
+
+            sqlite::group_writer writer(writer_session);
+
+            insert_query insert(current_session, "users", {"first_name", "last_name"});
+
+            insert.values("Group", "Query");
+
+            auto result = writer.submit(insert).get();
+
+            Assert::That(result.changes, Equals(1));
+
+            auto found = user().find_by_id(result.last_insert_id);
+
+            Assert::That(found != nullptr, IsTrue());
+
+            Assert::That(found->get("last_name"), Equals("Query"));
+        });
+
+        it("fails only the write that failed", []() {
+            auto writer_session = sqldb::open_session(current_session->connection_info());
+
+            sqlite::group_writer writer(writer_session);
+
+            auto good = writer.submit("insert into users(first_name, last_name) values($1, $2)", {"Group", "Good"});
+
+            auto bad = writer.submit("insert into no_such_table(first_name) values($1)", {"Group"});
+
+            Assert::That(good.get().changes, Equals(1));
+
+            AssertThrows(database_exception, bad.get());
+
+            writer.stop();
+
+            AssertThrows(database_exception, writer.submit("delete from users"));
+
+            select_query select(current_session);
+
+            Assert::That(select.from("users").count(), Equals(1));
+        });
+    });
+
+});
+
+#endif
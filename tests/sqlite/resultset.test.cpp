@@ -95,6 +95,22 @@ go_bandit([]() {
 
         it("can get a row", [&sqlite_session]() { test_resultset_row<sqlite::resultset>(get_sqlite_resultset); });
 
+        it("counts rows once they are read", []() {
+            auto rs = get_sqlite_resultset();
+
+            Assert::That(rs->row_count(), Equals(-1));
+
+            while (rs->next())
+                ;
+
+            Assert::That(rs->row_count(), Equals(2));
+
+            rs->reset();
+
+            // the rows are read again after a reset, so they are counted again
+            Assert::That(rs->row_count(), Equals(-1));
+        });
+
         it("can handle a bad query", []() {
             AssertThat(current_session->execute("select * from asdfasdfasdf"), Equals(false));
 
@@ -0,0 +1,173 @@
+#include <bandit/bandit.h>
+#include <chrono>
+#include "../db.test.h"
+#include "sqlite/session.h"
+
+#ifdef HAVE_LIBSQLITE3
+
+using namespace bandit;
+
+using namespace std;
+
+using namespace rj::db;
+
+go_bandit([]() {
+
+    describe("sqlite3 session", []() {
+        before_each([]() { setup_current_session(); });
+
+        after_each([]() { teardown_current_session(); });
+
+        it("can split readers from the writer", []() {
+            auto split = sqldb::open_session("file://testdb.db?readers=2");
+
+            Assert::That(split->impl<sqlite::session>()->reader_count(), Equals(2));
+
+            insert_query insert(split, "users", {"first_name", "last_name"});
+
+            insert.values("Split", "Writer");
+
+            Assert::That(insert.execute(), Equals(1));
+
+            select_query select(split);
+
+            select.from("users").where("first_name = $1", "Split");
+
+            // the same query object is executed each time, so its statement is reused
+            auto rows = [&select]() {
+                int count = 0;
+
+                for (auto &row : select.execute()) {
+                    Assert::That(row["first_name"].to_value().to_string(), Equals("Split"));
+                    count++;
+                }
+                return count;
+            };
+
+            // committed writes are visible to the readers
+            Assert::That(rows(), Equals(1));
+
+            {
+                auto tx = split->start_transaction();
+
+                insert_query other(split, "users", {"first_name", "last_name"});
+
+                other.values("Split", "Pending");
+
+                Assert::That(other.execute(), Equals(1));
+
+                // selects in a transaction run on the writer, so they see its changes
+                Assert::That(rows(), Equals(2));
+
+                tx.rollback();
+            }
+
+            Assert::That(rows(), Equals(1));
+        });
+
+        it("reads tables only the writer can see on the writer", []() {
+            auto split = sqldb::open_session("file://testdb.db?readers=1");
+
+            Assert::That(split->execute("create temp table scratch(id integer)"), IsTrue());
+
+            Assert::That(split->execute("insert into scratch(id) values(1)"), IsTrue());
+
+            // the reader has no temp table, so the select falls back to the writer
+            auto rs = split->query("select id from scratch");
+
+            Assert::That(rs.next(), IsTrue());
+
+            Assert::That(rs.current_row().column(0).to_value(), Equals(1));
+
+            select_query select(split);
+
+            Assert::That(select.from("scratch").count(), Equals(1));
+        });
+
+        it("resets a reader statement when it is returned", []() {
+            auto split = sqldb::open_session("file://testdb.db?readers=1");
+
+            insert_query insert(split, "users", {"first_name", "last_name"});
+
+            insert.values("Reset", "First");
+
+            Assert::That(insert.execute(), Equals(1));
+
+            insert.values("Reset", "Second");
+
+            Assert::That(insert.execute(), Equals(1));
+
+            {
+                select_query select(split);
+
+                select.from("users").where("first_name = $1", "Reset");
+
+                // only the first row is read
+                Assert::That(select.execute_scalar<int>(), !Equals(0));
+            }
+
+            insert_query more(split, "users", {"first_name", "last_name"});
+
+            more.values("Reset", "Third");
+
+            Assert::That(more.execute(), Equals(1));
+
+            // an unfinished read would hold its snapshot and keep the log from being truncated
+            auto rs = split->query("PRAGMA wal_checkpoint(TRUNCATE)");
+
+            Assert::That(rs.next(), IsTrue());
+
+            Assert::That(rs.current_row().column(0).to_value().to_int(), Equals(0));
+        });
+
+        it("can configure the busy strategy and transaction type", []() {
+            auto configured = sqldb::open_session("file://testdb.db?busy_timeout=200&transaction=immediate");
+
+            auto impl = configured->impl<sqlite::session>();
+
+            Assert::That(impl->get_busy_strategy().timeout.count(), Equals(200));
+
+            Assert::That(impl->transaction_type(), Equals(sqlite::transaction::immediate));
+
+            AssertThrows(database_exception, sqldb::open_session("file://testdb.db?transaction=whenever"));
+        });
+
+        it("waits on a locked database before failing", []() {
+            auto holder = sqldb::open_session("file://testdb.db");
+
+            auto waiter = sqldb::open_session("file://testdb.db?busy_timeout=200");
+
+            auto impl = waiter->impl<sqlite::session>();
+
+            Assert::That(holder->execute("BEGIN IMMEDIATE"), IsTrue());
+
+            insert_query insert(waiter, "users", {"first_name", "last_name"});
+
+            insert.values("Busy", "Waiter");
+
+            auto started = std::chrono::steady_clock::now();
+
+            Assert::That(insert.execute(), Equals(0));
+
+            auto elapsed = std::chrono::steady_clock::now() - started;
+
+            Assert::That(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >= 150, IsTrue());
+
+            Assert::That(impl->lock_waits() > 0, IsTrue());
+
+            Assert::That(impl->lock_failures(), Equals(1ULL));
+
+            Assert::That(holder->execute("ROLLBACK"), IsTrue());
+
+            // the lock is free again
+            Assert::That(insert.execute(), Equals(1));
+        });
+
+        it("has no readers by default", []() {
+            Assert::That(current_session->impl<sqlite::session>()->reader_count(), Equals(0));
+        });
+    });
+
+});
+
+#endif
@@ -128,6 +128,51 @@ go_bandit([]() {
 
             AssertThat(stmt.is_valid(), IsTrue());
         });
+
+        it("reuses cached statements", [&sqlite_session]() {
+            auto hits = sqlite_session->statement_cache_hits();
+
+            {
+                sqlite::statement stmt(sqlite_session);
+
+                stmt.prepare("select * from users where id = ?");
+
+                // a statement in use is not shared
+                sqlite::statement other(sqlite_session);
+
+                other.prepare("select * from users where id = ?");
+
+                AssertThat(sqlite_session->statement_cache_hits(), Equals(hits));
+            }
+
+            sqlite::statement stmt(sqlite_session);
+
+            stmt.prepare("select * from users where id = ?");
+
+            AssertThat(sqlite_session->statement_cache_hits(), Equals(hits + 1));
+
+            stmt.bind(1, 1234);
+
+            AssertThat(stmt.results().is_valid(), IsTrue());
+        });
+
+        it("can disable the statement cache", [&sqlite_session]() {
+            auto size = sqlite_session->statement_cache_size();
+
+            sqlite_session->set_statement_cache_size(0);
+
+            auto hits = sqlite_session->statement_cache_hits();
+
+            for (int i = 0; i < 2; i++) {
+                sqlite::statement stmt(sqlite_session);
+
+                stmt.prepare("select * from users");
+            }
+
+            AssertThat(sqlite_session->statement_cache_hits(), Equals(hits));
+
+            sqlite_session->set_statement_cache_size(size);
+        });
     });
 
 });
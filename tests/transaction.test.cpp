@@ -55,6 +55,28 @@ go_bandit([]() {
             Assert::That(assign.is_active(), IsTrue());
         });
 
+        it("is seen by the session however it was started", []() {
+            Assert::That(current_session->in_transaction(), IsFalse());
+
+            {
+                auto tx = current_session->start_transaction();
+
+                Assert::That(current_session->in_transaction(), IsTrue());
+
+                tx.rollback();
+            }
+
+            Assert::That(current_session->in_transaction(), IsFalse());
+
+            Assert::That(current_session->execute("BEGIN"), IsTrue());
+
+            Assert::That(current_session->in_transaction(), IsTrue());
+
+            Assert::That(current_session->execute("ROLLBACK"), IsTrue());
+
+            Assert::That(current_session->in_transaction(), IsFalse());
+        });
+
         it("is can be moved", []() {
             auto tx = current_session->create_transaction();
 